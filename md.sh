@@ -14,3 +14,9 @@ make -B debug
 
 cd ../jpsynth
 make -B debug
+
+cd ../jpbench
+make -B debug
+
+cd ../wtconvert
+make -B debug
@@ -14,3 +14,9 @@ make -B release
 
 cd ../jpsynth
 make -B release
+
+cd ../jpbench
+make -B release
+
+cd ../wtconvert
+make -B release
@@ -4,7 +4,9 @@
 #include "m_pd.h"
 #include "ADSR.h"
 #include "DSPBusManager.h"
+#include "DSPEngine.h"
 #include "dsp_math.h"
+#include <algorithm>
 #include <cstdlib>
 
 static t_class *adsr_tilde_class;
@@ -22,7 +24,9 @@ struct t_adsr_tilde
     size_t blockSize;
     double inletValue;
 
+    DSPEngine *engine;
     ADSR *adsr;
+    DSPModulationBus *bus; ///< Envelope output, copied to the outlet
 };
 
 // === Trigger methods ===
@@ -81,25 +85,40 @@ void adsr_oneshot(t_adsr_tilde *x, t_floatarg f)
 t_int *adsr_perform(t_int *w)
 {
     t_adsr_tilde *x = (t_adsr_tilde *)(w[1]);
+    t_sample *out = (t_sample *)(w[2]);
+    int n = (int)(w[3]);
 
+    DSPEngine::Scope scope(*x->engine);
     x->adsr->process();
-    
+
+    const host_float *envelope = x->bus->m.data();
+    std::copy(envelope, envelope + n, out);
+
     return (w + 4);
 }
 
+// === DSP setup ===
 void adsr_dsp(t_adsr_tilde *x, t_signal **sp)
 {
-    t_sample *out = sp[0]->s_vec;
-    x->samplerate = sp[0]->s_sr;
-    x->blockSize = sp[0]->s_n;
-    
-    DSP::initializeAudio(x->samplerate, x->blockSize);
-    
-    x->adsr->initialize(dsp_math::unique_string_id("adsr"));
+    // Every object has an engine of its own, other objects keep their state
+    DSPEngine::Scope scope(*x->engine);
+
+    // The envelope renders into its own bus, a restart with unchanged
+    // settings only passes the new outlet vector to the perform routine
+    if (!x->engine->isInitialized() || x->samplerate != sp[0]->s_sr || x->blockSize != static_cast<size_t>(sp[0]->s_n))
+    {
+        x->samplerate = sp[0]->s_sr;
+        x->blockSize = sp[0]->s_n;
 
-    std::string busName = dsp_math::unique_string_id("buffered_lfo_bus");
+        DSP::initializeAudio(x->samplerate, x->blockSize);
 
-    x->adsr->connectModulationToBus(DSPBusManager::registerModulationBus(busName, out));
+        x->adsr->initialize(dsp_math::unique_string_id("adsr"));
+
+        std::string busName = dsp_math::unique_string_id("buffered_lfo_bus");
+
+        x->bus = &DSPBusManager::registerModulationBus(busName);
+        x->adsr->connectModulationToBus(*x->bus);
+    }
 
     dsp_add(adsr_perform, 3, x, sp[0]->s_vec, sp[0]->s_n);
 }
@@ -117,6 +136,7 @@ void *adsr_new(t_floatarg f)
 
     DSP::registerLogger(&log);
 
+    x->engine = new DSPEngine();
     x->adsr = new ADSR();
     x->adsr->setStartAtCurrent(f != 0);
 
@@ -126,6 +146,7 @@ void *adsr_new(t_floatarg f)
 void adsr_tilde_free(t_adsr_tilde *x)
 {
     delete x->adsr;
+    delete x->engine;
 }
 
 // === Setup function ===
@@ -2,6 +2,7 @@
 
 #include "clamp.h"
 #include "Modulator.h"
+#include <algorithm>
 #include <cmath>
 
 // Enumeration for the envelope phase
@@ -32,6 +33,15 @@ public:
     void triggerStart();
     void triggerStop();
 
+    // Starts the attack from zero at once, without the startup ramp
+    void triggerRestart();
+
+    // Current envelope phase
+    ADSRPhase getPhase() const { return phase; }
+
+    // True if the envelope has finished and outputs zero
+    bool isIdle() const { return phase == ADSRPhase::Idle; }
+
 protected:
     // Initializes the ADSR
     virtual void initializeModulator() override;
@@ -40,8 +50,9 @@ private:
     // Next sample block generation
     static void processBlock(DSPObject *dsp);
 
-    // Phase function (startup, attack, decay, sustain, release)
-    using PhaseFunc = void (ADSR::*)();
+    // Phase function (startup, attack, decay, sustain, release), renders samples of
+    // the current phase up to its end and returns their number
+    using PhaseFunc = size_t (ADSR::*)(host_float *out, size_t count);
     PhaseFunc phaseFunc;
 
     // Envelope values
@@ -57,12 +68,18 @@ private:
 
     void enterPhase(ADSRPhase newPhase);
 
-    void phaseIdle();
-    void phaseStartup();
-    void phaseAttack();
-    void phaseDecay();
-    void phaseSustain();
-    void phaseRelease();
+    size_t phaseIdle(host_float *out, size_t count);
+    size_t phaseStartup(host_float *out, size_t count);
+    size_t phaseAttack(host_float *out, size_t count);
+    size_t phaseDecay(host_float *out, size_t count);
+    size_t phaseSustain(host_float *out, size_t count);
+    size_t phaseRelease(host_float *out, size_t count);
+
+    // Samples of a phase of the given length left in a run of count samples, at least one
+    size_t runLength(int samples, size_t count) const;
+
+    // Renders a shaped segment from start to end over samples, continuing at currentSample
+    void renderSegment(host_float *out, size_t count, host_float start, host_float end, int samples, host_float shape);
 
     static host_float powerLerp(host_float start, host_float end, host_float p, host_float shape);
     static host_float shapeToExponent(host_float f);
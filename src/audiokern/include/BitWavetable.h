@@ -11,5 +11,5 @@ public:
 
 protected:
     // Fills the given buffer with one cycle of a bitchrush waveform
-    void createWavetable(DSPBuffer &buffer, dsp_float frequency) override;
+    void createWavetable(DSPBuffer &buffer, dsp_float frequency, dsp_float sampleRate) override;
 };
@@ -5,6 +5,19 @@
 #include "DSPObjectCollection.h"
 #include <string>
 
+/**
+ * @brief The sample buffers of a bus, as seen by the dependency and liveness analysis.
+ */
+struct DSPBusChannels
+{
+    /// @brief Maximum number of sample buffers of a bus
+    static constexpr size_t maxChannels = 2;
+
+    const host_float *data[maxChannels]; ///< Sample buffers, the first one is the bus key
+    size_t count;                        ///< Number of sample buffers
+    size_t size;                         ///< Samples per buffer
+};
+
 /**
  * @brief Base class for all DSP bus types providing common bus management functionality
  *
@@ -91,6 +104,25 @@ public:
      */
     bool getIsManaged() const;
 
+    /**
+     * @brief Identifies the sample memory behind the bus
+     *
+     * Copies of a bus share their buffers, so all copies return the same key.
+     * Used to derive processing dependencies between DSP objects.
+     *
+     * @return Pointer to the first sample buffer, nullptr if not initialized
+     */
+    virtual const void *getKey() const = 0;
+
+    /**
+     * @brief Returns the sample buffers of the bus
+     *
+     * Used to give buses with disjoint lifetimes shared storage, see DSPGraph::finalize().
+     *
+     * @return Buffer pointers, count and size
+     */
+    virtual DSPBusChannels getChannels() const = 0;
+
     /**
      * @brief Check if the bus has been properly initialized
      *
@@ -180,6 +212,11 @@ public:
      */
     static void validate();
 
+    /**
+     * @brief Destroys all buses created by create(), called before the DSP arena is reset
+     */
+    static void clear();
+
     /**
      * @brief Creates a new DSP modulation bus instance
      *
@@ -195,6 +232,12 @@ public:
     /// @brief The buffer that holds the modulation data
     DSPSampleBuffer m;
 
+    /// @brief Bus key, the modulation buffer
+    const void *getKey() const override { return m.data(); }
+
+    /// @brief The modulation buffer
+    DSPBusChannels getChannels() const override { return {{m.data(), nullptr}, 1, m.size()}; }
+
 protected:
     /**
      * @brief Initialize the modulation bus with name and buffer size
@@ -204,10 +247,6 @@ protected:
      * @param size Buffer size, typically DSP::blockSize
      */
     void initializeBus(size_t size) override;
-
-private:
-    /// @brief Just holds the instances created by create(size_t size)
-    static DSPObjectCollection<DSPModulationBus> modulationBusses;
 };
 
 /**
@@ -270,6 +309,11 @@ public:
      */
     static void validate();
 
+    /**
+     * @brief Destroys all buses created by create(), called before the DSP arena is reset
+     */
+    static void clear();
+
     /**
      * @brief Creates a new DSP audio bus instance
      *
@@ -288,6 +332,12 @@ public:
     /// @brief The buffer that holds right channel audio samples
     DSPSampleBuffer r;
 
+    /// @brief Bus key, the left channel buffer
+    const void *getKey() const override { return l.data(); }
+
+    /// @brief The left and right channel buffers
+    DSPBusChannels getChannels() const override { return {{l.data(), r.data()}, 2, l.size()}; }
+
 protected:
     /**
      * @brief Initialize the audio bus with name and buffer size
@@ -297,8 +347,4 @@ protected:
      * @param size Buffer size, typically DSP::blockSize
      */
     void initializeBus(size_t size) override;
-
-private:
-    /// @brief Just holds the instances created by create(size_t size)
-    static DSPObjectCollection<DSPAudioBus> audioBusses;
 };
\ No newline at end of file
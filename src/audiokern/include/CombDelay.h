@@ -136,6 +136,11 @@ private:
      */
     static void processBlock(DSPObject *dsp);
 
+    /**
+     * @brief Applies a delay time queued by setTime() at the fade midpoint.
+     */
+    static void applyTime(const ParamFader::ParamChange &change);
+
     /**
      * @brief Main block processing method.
      *
@@ -4,17 +4,34 @@
 #include <stddef.h>
 #include <string>
 #include <mutex>
+#include <unordered_map>
 #include <vector>
 #include <iomanip>
 #include <sstream>
 
+// Internal processing block in samples, engines split host buffers of any length into blocks of this size
+#ifndef DSP_SUB_BLOCK_SIZE
+#define DSP_SUB_BLOCK_SIZE 64
+#endif
+
+// Thread-local storage for plain data, without the initialization wrappers of thread_local
+#if defined(__GNUC__)
+#define DSP_THREAD_LOCAL __thread
+#else
+#define DSP_THREAD_LOCAL thread_local
+#endif
+
 class DSPObject; // Forward declaration
+class DSPGraph;  // Forward declaration
+class DSPArena;  // Forward declaration
+class DSPEngine; // Forward declaration
 
 /**
  * @brief Static utility and management class for the DSP system.
  * 
- * Provides centralized initialization, logging, and global object registration
- * for all DSP.melated components.
+ * Provides centralized initialization, logging, and object registration
+ * for all DSP.melated components. Initialization, registration and the
+ * settings refer to the engine current on the calling thread, see DSPEngine.
  */
 class DSP
 {
@@ -63,7 +80,7 @@ public:
     static void registerLogger(LogFunc func);
 
     /**
-     * @brief Registers a DSPObject with the global registry.
+     * @brief Registers a DSPObject with the registry of the current engine.
      * 
      * Each DSPObject must have a unique name. Duplicate names will throw.
      * 
@@ -81,6 +98,36 @@ public:
      */
     static const std::vector<DSPObject*>& getRegistry();
 
+    /**
+     * @brief Looks up a registered DSPObject by name in constant time.
+     * 
+     * The position of an object in getRegistry() is its integer handle,
+     * it stays valid until the next initializeAudio(...).
+     * 
+     * @param name Name of the object as returned by DSPObject::getName().
+     * @return Pointer to the object or nullptr if no object has that name.
+     */
+    static DSPObject* findObject(const std::string& name);
+
+    /**
+     * @brief Registers a processing graph to be finalized by finalizeAudio().
+     * 
+     * The graph derives its dependencies from the bus connections, so it must
+     * be finalized after all objects are connected.
+     * 
+     * @param graph Reference to the graph, must outlive the audio session.
+     */
+    static void registerGraph(DSPGraph& graph);
+
+    /**
+     * @brief Returns the arena all sample buffers and buses are allocated from.
+     * 
+     * The arena is reset by initializeAudio(...), buffers must be initialized again after that.
+     * 
+     * @return Reference to the arena of the audio session.
+     */
+    static DSPArena& getArena();
+
     /**
      * @brief Replaces very small values with zero to avoid denormals.
      * 
@@ -94,9 +141,9 @@ public:
     /**
      * @brief Indicates whether the DSP system has been successfully initialized.
      * 
-     * @return True if initializeAudio(...) has been called.
+     * @return True if initializeAudio(...) has been called for the current engine.
      */
-    static bool isInitialized() { return initialized; }
+    static bool isInitialized();
 
     /**
      * @brief Advances internal block statistics (e.g., block count).
@@ -108,17 +155,22 @@ public:
     /// Maximum allowed sample block size
     static constexpr size_t maxBlockSize = 2048;
 
+    /// Fixed block size of engines that accept host buffers of any length, see DSP_SUB_BLOCK_SIZE
+    static constexpr size_t subBlockSize = DSP_SUB_BLOCK_SIZE;
+
+    static_assert(subBlockSize > 0 && subBlockSize <= maxBlockSize, "DSP: sub-block size out of range");
+
     /// Maximum supported sampling rate
     static constexpr dsp_float maxSamplerate = 96000.0;
 
     /// Threshold for denormal suppression
     static constexpr dsp_float epsilon = 1e-10;
 
-    /// Current system sampling rate in Hz
-    static dsp_float sampleRate;
+    /// Sampling rate in Hz of the engine current on this thread
+    static DSP_THREAD_LOCAL dsp_float sampleRate;
 
-    /// Current block size in samples
-    static size_t blockSize;
+    /// Block size in samples of the engine current on this thread
+    static DSP_THREAD_LOCAL size_t blockSize;
 
     /**
      * @brief Formatted log message output (like printf).
@@ -156,25 +208,9 @@ private:
     /// log function
     static void logv(const char* fmt, va_list args);
 
-    /// Internal flag: true after successful initialization
-    static bool initialized;
-
-    /// Total number of processed samples (for stats)
-    static long elapsedSamples;
-
-    /// Total number of processed blocks (for stats)
-    static long processedBlocks;
-
     /// Current logger callback function
     static LogFunc logger;
 
     /// Current log intervall counter
     static size_t currentLogInterval;
-
-    /**
-     * @brief Returns the mutable internal DSP object registry.
-     * 
-     * Used by registerObject(...) to store object pointers.
-     */
-    static std::vector<DSPObject*>& getMutableRegistry();
 };
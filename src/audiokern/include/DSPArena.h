@@ -0,0 +1,140 @@
+#pragma once
+
+#include "dsp_types.h"
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Bump allocator for the sample buffers and buses of the DSP.
+ *
+ * All memory handed out by the arena is aligned to 64 bytes (one cache line,
+ * one AVX-512 vector) and comes from a few large chunks instead of one heap
+ * allocation per buffer. Slices are handed out in allocation order, so buffers
+ * and buses that are created together, e.g. the buses of one voice or the left
+ * and right channel of a bus, sit next to each other in memory.
+ *
+ * Individual slices are never freed. reset() rewinds the arena in one call when
+ * the DSP is re-initialized and merges the chunks, so the next initialization
+ * is served from one contiguous block. Objects constructed with create() must
+ * be destroyed by their owner before the arena is reset.
+ *
+ * The arena is not thread-safe, it is used while the DSP is initialized.
+ *
+ * Usage:
+ * @code
+ * DSPArena arena;
+ * host_float *samples = arena.allocateSamples(DSP::blockSize);
+ * DSPAudioBus *bus = arena.create<DSPAudioBus>();
+ * ...
+ * bus->~DSPAudioBus();
+ * arena.reset();
+ * @endcode
+ */
+class DSPArena
+{
+public:
+    /// Alignment of every slice in bytes
+    static constexpr size_t alignment = 64;
+
+    /// Size of a chunk unless a single request is larger
+    static constexpr size_t defaultChunkSize = 256 * 1024;
+
+    /**
+     * @brief Constructs an empty arena, memory is reserved on first use.
+     * @param chunkSize Minimum size of the chunks allocated from the heap
+     */
+    explicit DSPArena(size_t chunkSize = defaultChunkSize);
+
+    /**
+     * @brief Frees all chunks.
+     */
+    ~DSPArena();
+
+    /**
+     * @brief Returns an uninitialized slice.
+     * @param bytes Requested size, rounded up to full cache lines
+     * @return Pointer aligned to 64 bytes
+     */
+    void *allocate(size_t bytes);
+
+    /**
+     * @brief Returns a zeroed sample slice.
+     *
+     * The slice is padded to full cache lines, so vector loads and stores of
+     * the last partial vector stay within it.
+     *
+     * @param count Number of samples
+     * @return Pointer aligned to 64 bytes
+     */
+    host_float *allocateSamples(size_t count);
+
+    /**
+     * @brief Constructs an object in the arena.
+     *
+     * The memory is reclaimed by reset(), the owner must call the destructor before.
+     */
+    template <typename T, typename... Args>
+    T *create(Args &&...args)
+    {
+        static_assert(alignof(T) <= alignment, "DSPArena: alignment of type exceeds 64 bytes");
+        return new (allocate(sizeof(T))) T(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Rewinds the arena, all slices become invalid.
+     *
+     * If the last initialization needed several chunks they are replaced by
+     * one chunk of their total size.
+     */
+    void reset();
+
+    /**
+     * @brief Returns all memory to the heap, all slices become invalid.
+     */
+    void release();
+
+    /**
+     * @brief Checks whether memory belongs to the arena.
+     * @param ptr Any pointer
+     * @return True if ptr points into one of the chunks
+     */
+    bool owns(const void *ptr) const;
+
+    /**
+     * @brief Returns the number of bytes handed out since the last reset.
+     */
+    size_t getBytesUsed() const { return bytesUsed; }
+
+    /**
+     * @brief Returns the number of bytes allocated from the heap.
+     */
+    size_t getBytesReserved() const;
+
+    // Prevent copy construction and assignment, the chunks have a single owner
+    DSPArena(const DSPArena &) = delete;
+    DSPArena &operator=(const DSPArena &) = delete;
+
+private:
+    /**
+     * @brief One heap allocation.
+     */
+    struct Chunk
+    {
+        uint8_t *data; ///< Start of the chunk, aligned to 64 bytes
+        size_t size;   ///< Size in bytes
+    };
+
+    /**
+     * @brief Allocates a chunk of at least the given size and makes it current.
+     */
+    void addChunk(size_t bytes);
+
+    std::vector<Chunk> chunks; ///< Chunks in allocation order
+    size_t currentChunk;       ///< Chunk slices are taken from
+    size_t offset;             ///< Next free byte in the current chunk
+    size_t bytesUsed;          ///< Bytes handed out since the last reset
+    size_t chunkSize;          ///< Minimum chunk size
+};
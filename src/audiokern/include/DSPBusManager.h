@@ -1,22 +1,35 @@
 
 #pragma once
 
+#include "DSPEngine.h"
 #include "DSPObjectCollection.h"
 #include "DSPSampleBuffer.h"
 #include "omfg.h"
 #include "Busses.h"
 #include <stdexcept>
+#include <string>
+#include <unordered_map>
 
 /**
  * @brief Static manager for registering and accessing named audio and modulation buses.
  *
  * This class provides static registration and retrieval of DSP buses by name.
- * All buses are allocated statically to ensure Organelle compatibility (no heap allocation).
+ * All buses and their buffers are allocated from the DSP arena (see DSP::getArena()),
+ * buses registered one after another sit next to each other in memory.
  * Must be initialized after DSP::blockSize is known.
+ *
+ * Names are hashed, registration and lookup by name take constant time
+ * regardless of the number of buses. Objects that look up a bus repeatedly
+ * can resolve its name once to a BusHandle, handles stay valid until clear().
+ *
+ * The buses belong to the engine current on the calling thread, see DSPEngine.
  */
 class DSPBusManager
 {
 public:
+    /// Index of a registered bus, valid until clear()
+    using BusHandle = size_t;
+
     /**
      * @brief Initializes the DSP bus manager
      */
@@ -97,8 +110,46 @@ public:
     static DSPModulationBus &getModulationBus(const std::string &name);
 
     /**
-     * @brief Clears all registered bus names and resets counters.
-     * Does not deallocate the static buffers.
+     * @brief Resolves the name of an audio bus to its handle.
+     * Panics if the name is not registered.
+     *
+     * @param name The name of the audio bus.
+     * @return Handle to pass to getAudioBus(BusHandle).
+     */
+    static BusHandle getAudioBusHandle(const std::string &name);
+
+    /**
+     * @brief Resolves the name of a modulation bus to its handle.
+     * Panics if the name is not registered.
+     *
+     * @param name The name of the modulation bus.
+     * @return Handle to pass to getModulationBus(BusHandle).
+     */
+    static BusHandle getModulationBusHandle(const std::string &name);
+
+    /**
+     * @brief Returns the audio bus of a handle, the handle is not checked.
+     */
+    static DSPAudioBus &getAudioBus(BusHandle handle) { return DSPEngine::current().audioBusses[handle]; }
+
+    /**
+     * @brief Returns the modulation bus of a handle, the handle is not checked.
+     */
+    static DSPModulationBus &getModulationBus(BusHandle handle) { return DSPEngine::current().modulationBusses[handle]; }
+
+    /**
+     * @brief Returns the number of registered audio buses.
+     */
+    static size_t getAudioBusCount() { return DSPEngine::current().audioBusses.size(); }
+
+    /**
+     * @brief Returns the number of registered modulation buses.
+     */
+    static size_t getModulationBusCount() { return DSPEngine::current().modulationBusses.size(); }
+
+    /**
+     * @brief Destroys all managed and unmanaged buses.
+     * Their buffers are reclaimed by resetting the DSP arena.
      */
     static void clear();
 
@@ -116,11 +167,4 @@ public:
      * DSP objects can connect to this bus to have a buffer available.
      */
     const std::string nullBusName = "null";
-
-private:
-    // Audio bus storage
-    static DSPObjectCollection<DSPAudioBus> audioBusses;
-
-    // Modulation bus storage
-    static DSPObjectCollection<DSPModulationBus> modulationBusses;
 };
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Real-time safe fork-join dispatcher for a fixed set of jobs per block.
+ *
+ * Unlike DSPThreadPool, run() neither allocates nor takes a lock. A job is a
+ * plain function pointer with a context pointer and a job index, so no
+ * std::function is constructed per block.
+ *
+ * - Workers park on an epoch counter: they spin for a short while and then
+ *   sleep on a futex (Linux) until the next run() bumps the epoch.
+ * - Jobs are claimed with a compare-and-swap on a word that packs the epoch
+ *   and the next job index, so a worker waking up late can never claim a job
+ *   of a newer run. run() marks the word exhausted before it changes the job
+ *   count, so the number of jobs may differ from run to run. The calling
+ *   (audio) thread claims jobs as well instead of idling.
+ * - Completion is an atomic barrier on the number of finished jobs, the
+ *   calling thread spins on it once it runs out of jobs to claim.
+ *
+ * Usage:
+ * @code
+ * DSPDispatcher dispatcher;
+ * dispatcher.initialize(2); // two helper threads, the caller is the third participant
+ *
+ * // per block
+ * dispatcher.run(&MySynth::renderVoice, this, numVoices);
+ * @endcode
+ *
+ * @note initialize() and the destructor start and join threads and must not be
+ *       called from the audio thread. run() must only be called from one thread.
+ */
+class DSPDispatcher
+{
+public:
+    /// Job function, called once per index in [0, numJobs)
+    using JobFunc = void (*)(void *context, size_t index);
+
+    /**
+     * @brief Constructs an empty dispatcher, run() executes inline until initialize() is called.
+     */
+    DSPDispatcher();
+
+    /**
+     * @brief Stops and joins all worker threads.
+     */
+    ~DSPDispatcher();
+
+    /**
+     * @brief (Re)starts the dispatcher with a number of helper threads.
+     * @param numWorkers Helper threads in addition to the calling thread, 0 runs all jobs inline
+     */
+    void initialize(size_t numWorkers);
+
+    /**
+     * @brief Runs func(context, i) for all i in [0, numJobs) and returns when all have finished.
+     *
+     * @param func Job function
+     * @param context Context pointer passed to every job
+     * @param numJobs Number of jobs
+     */
+    void run(JobFunc func, void *context, size_t numJobs);
+
+    /**
+     * @brief Sets the number of busy-wait iterations before a worker sleeps on the futex.
+     */
+    void setSpinCount(uint32_t count) { spinCount.store(count, std::memory_order_relaxed); }
+
+    /**
+     * @brief Returns the number of helper threads.
+     */
+    size_t getNumWorkers() const { return workers.size(); }
+
+    // Prevent copy construction and assignment
+    DSPDispatcher(const DSPDispatcher &) = delete;
+    DSPDispatcher &operator=(const DSPDispatcher &) = delete;
+
+private:
+    /**
+     * @brief Worker loop: waits for a new epoch, claims jobs, repeats.
+     * @param startEpoch Epoch at the time the worker was started
+     */
+    void workerThread(uint32_t startEpoch);
+
+    /**
+     * @brief Claims and runs jobs until none are left.
+     */
+    void runJobs();
+
+    /**
+     * @brief Stops and joins all workers.
+     */
+    void shutdown();
+
+    std::vector<std::thread> workers; ///< Helper threads
+
+    alignas(64) std::atomic<uint32_t> epoch;  ///< Bumped by run(), futex word the workers wait on
+    alignas(64) std::atomic<uint64_t> claim;  ///< Epoch (high 32 bit) and next job index (low 32 bit)
+    alignas(64) std::atomic<size_t> doneJobs; ///< Completion barrier
+    alignas(64) std::atomic<int> sleepers;    ///< Workers currently sleeping on the futex
+
+    std::atomic<JobFunc> jobFunc;     ///< Current job function
+    std::atomic<void *> jobContext;   ///< Current job context
+    std::atomic<size_t> jobCount;     ///< Current number of jobs
+    std::atomic<uint32_t> spinCount;  ///< Busy-wait iterations before sleeping
+    std::atomic<bool> shuttingDown;   ///< True while the workers are being stopped
+};
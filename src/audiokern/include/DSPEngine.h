@@ -0,0 +1,181 @@
+#pragma once
+
+#include "DSP.h"
+#include "DSPArena.h"
+#include "DSPObjectCollection.h"
+#include "DSPProfiler.h"
+#include "Busses.h"
+#include "dsp_types.h"
+#include <chrono>
+#include <stddef.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class DSPObject; // Forward declaration
+class DSPGraph;  // Forward declaration
+
+/**
+ * @brief State of one audio session.
+ *
+ * An engine owns the sample rate, the block size, the object and graph
+ * registries, the audio and modulation buses, the arena their buffers are
+ * allocated from and the profiler figures of its objects. Engines are
+ * independent of each other, so several synths or Pd objects can live in one
+ * process and render on different threads.
+ *
+ * The static interfaces of DSP and DSPBusManager act on the engine that is
+ * current on the calling thread, see Scope. A thread that never binds an
+ * engine uses the default engine, so hosts with a single instance need no
+ * changes. DSP::sampleRate and DSP::blockSize are per-thread copies of the
+ * settings of the current engine. DSPGraph hands the engine and the settings
+ * to the threads that render the graph.
+ *
+ * Binding an engine also switches flush-to-zero/denormals-are-zero on for the
+ * thread (see cpu_flush_denormals()), a scope restores the previous mode.
+ *
+ * Usage:
+ * @code
+ * DSPEngine engine;
+ *
+ * {
+ *     DSPEngine::Scope scope(engine);
+ *     DSP::initializeAudio(48000.0, DSP::subBlockSize);
+ *     ... initialize and connect objects
+ *     DSP::finalizeAudio();
+ * }
+ *
+ * // Audio thread, per block
+ * DSPEngine::Scope scope(engine);
+ * ... process objects and graphs
+ * @endcode
+ */
+class DSPEngine
+{
+    friend class DSP;
+    friend class DSPBusManager;
+    friend class DSPAudioBus;
+    friend class DSPModulationBus;
+    friend class DSPProfiler;
+
+public:
+    /**
+     * @brief Makes an engine current on the calling thread while the scope exists.
+     *
+     * Scopes nest, the previous engine, its settings and the floating-point
+     * mode of the thread are restored on exit.
+     */
+    class Scope
+    {
+    public:
+        explicit Scope(DSPEngine &engine);
+        ~Scope();
+
+        // A scope restores the state of the thread it was created on
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        DSPEngine *previous;            ///< Engine current before the scope
+        dsp_float previousSampleRate;   ///< DSP::sampleRate before the scope
+        size_t previousBlockSize;       ///< DSP::blockSize before the scope
+        unsigned int previousFloatMode; ///< Floating-point mode before the scope
+    };
+
+    /**
+     * @brief Constructs an uninitialized engine, see DSP::initializeAudio().
+     */
+    DSPEngine();
+
+    /**
+     * @brief Destroys the buses and releases the arena.
+     *
+     * Objects registered with the engine must not be processed afterwards.
+     */
+    ~DSPEngine();
+
+    /**
+     * @brief Returns the engine current on the calling thread.
+     */
+    static DSPEngine &current() { return currentEngine ? *currentEngine : getDefault(); }
+
+    /**
+     * @brief Returns the engine of threads that bind no engine.
+     */
+    static DSPEngine &getDefault();
+
+    /**
+     * @brief Makes an engine current on a rendering thread, without restoring the previous one.
+     *
+     * Called by the threads a graph is processed on, before they run its nodes.
+     * Sets the floating-point mode of the thread according to getFlushDenormals().
+     *
+     * @param engine The engine
+     * @param rate Sample rate the nodes see as DSP::sampleRate
+     * @param size Block size the nodes see as DSP::blockSize
+     */
+    static void bindThread(DSPEngine &engine, dsp_float rate, size_t size);
+
+    /**
+     * @brief Returns the sample rate set by DSP::initializeAudio().
+     */
+    dsp_float getSampleRate() const { return sampleRate; }
+
+    /**
+     * @brief Returns the block size set by DSP::initializeAudio().
+     */
+    size_t getBlockSize() const { return blockSize; }
+
+    /**
+     * @brief Indicates whether DSP::initializeAudio() has been called for this engine.
+     */
+    bool isInitialized() const { return initialized; }
+
+    /**
+     * @brief Returns the number of blocks processed since the engine was initialized.
+     */
+    long getProcessedBlocks() const { return processedBlocks; }
+
+    /**
+     * @brief Sets whether threads bound to the engine flush subnormal floats to zero.
+     *
+     * On by default. Takes effect the next time a thread binds the engine.
+     */
+    void setFlushDenormals(bool flush) { flushDenormals = flush; }
+
+    /**
+     * @brief Indicates whether threads bound to the engine flush subnormal floats to zero.
+     */
+    bool getFlushDenormals() const { return flushDenormals; }
+
+    // The registries refer to the engine's objects, buses and memory
+    DSPEngine(const DSPEngine &) = delete;
+    DSPEngine &operator=(const DSPEngine &) = delete;
+
+private:
+    static DSP_THREAD_LOCAL DSPEngine *currentEngine; ///< Engine of the calling thread, nullptr for the default
+
+    dsp_float sampleRate;   ///< Sample rate in Hz
+    size_t blockSize;       ///< Block size in samples
+    bool initialized;       ///< True after DSP::initializeAudio()
+    long elapsedSamples;    ///< Samples processed since initialization
+    long processedBlocks;   ///< Blocks processed since initialization
+    bool flushDenormals;    ///< FTZ/DAZ on the threads bound to the engine
+    std::chrono::steady_clock::time_point initializeStart; ///< Start of the session, for the startup report
+
+    std::vector<DSPObject *> registry;                      ///< Registered objects, the position is the handle
+    std::unordered_map<std::string, size_t> registryIndex;  ///< Registry positions by object name
+    std::vector<DSPGraph *> graphs;                         ///< Graphs finalized by DSP::finalizeAudio()
+    DSPProfiler::EngineState profile;                       ///< Profiler figures keyed by registry slot
+
+    // The arena is declared before the buses, which are destroyed first
+    DSPArena arena; ///< Memory of all buses and sample buffers
+
+    DSPObjectCollection<DSPAudioBus> audioBusses;                 ///< Buses registered by name
+    DSPObjectCollection<DSPModulationBus> modulationBusses;       ///< Buses registered by name
+    std::unordered_map<std::string, size_t> audioBusHandles;      ///< Handles of the audio buses by name
+    std::unordered_map<std::string, size_t> modulationBusHandles; ///< Handles of the modulation buses by name
+
+    DSPObjectCollection<DSPAudioBus> unmanagedAudioBusses;           ///< Buses created by objects
+    DSPObjectCollection<DSPModulationBus> unmanagedModulationBusses; ///< Buses created by objects
+};
@@ -0,0 +1,264 @@
+#pragma once
+
+#include "DSPObject.h"
+#include "DSPDispatcher.h"
+#include <atomic>
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+class DSPBus;    // Forward declaration
+class DSPEngine; // Forward declaration
+
+/**
+ * @brief Dependency-aware processing graph scheduled over a DSPDispatcher.
+ *
+ * Nodes are DSP objects or plain tasks, each with the buses it reads and
+ * writes. DSP objects bring the accesses recorded by their connect*ToBus
+ * methods. finalize() derives the edges once: a node depends on every earlier
+ * node it shares a bus with, unless both only read it. The insertion order
+ * therefore is the serial reference order and the graph reproduces its output
+ * exactly, no matter how many threads take part.
+ *
+ * finalize() also computes the lifetime of every bus within a block, from the
+ * node that overwrites it first to the last node that accesses it, and lets
+ * buses with disjoint lifetimes share storage (see BusAliasing). This keeps the
+ * memory touched per block small.
+ *
+ * process() runs the nodes as a dataflow: every executor owns a fixed-size
+ * work-stealing deque (Chase-Lev), pushes successors that became ready to its
+ * own deque and steals from the others when it runs dry. Nothing is allocated
+ * or locked per block.
+ *
+ * Usage:
+ * @code
+ * graph.addNode(voice1);
+ * graph.addNode(voice2);   // independent of voice1, may run concurrently
+ * graph.add(mixer);        // reads both voice buses, runs after them
+ * graph.finalize();
+ *
+ * // per block
+ * graph.process(dispatcher);
+ * @endcode
+ *
+ * @note Build and finalize the graph outside the audio thread. Connections
+ *       changed after finalize() are not picked up until the next finalize().
+ * @note The accesses of a node must cover every bus it touches that another node
+ *       touches as well. Buses also accessed outside the graph must be pinned.
+ */
+class DSPGraph
+{
+public:
+    /// Task function of a node
+    using TaskFunc = void (*)(void *context);
+
+    /// Maximum number of threads taking part in one block
+    static constexpr size_t maxExecutors = 64;
+
+    /**
+     * @brief How finalize() lets buses with disjoint lifetimes share storage.
+     *
+     * Only buses in DSP arena memory whose first node overwrites them qualify,
+     * buses that carry data from one block to the next keep their storage.
+     */
+    enum class BusAliasing
+    {
+        Off,      ///< Every bus keeps its own storage
+        Parallel, ///< Share where the dependencies already order the lifetimes, keeps all parallelism
+        Serial    ///< Share along the reference order and add the dependencies this needs
+    };
+
+    /**
+     * @brief Constructs an empty graph.
+     */
+    DSPGraph();
+
+    /**
+     * @brief Removes all nodes.
+     */
+    void clear();
+
+    /**
+     * @brief Adds a DSP object the way the object wants to be scheduled, see DSPObject::addToGraph().
+     * @param obj The DSP object
+     */
+    void add(DSPObject &obj);
+
+    /**
+     * @brief Adds a DSP object as a single node, processed with obj.process().
+     * @param obj The DSP object, its bus bindings become the node's accesses
+     * @return Node index
+     */
+    size_t addNode(DSPObject &obj);
+
+    /**
+     * @brief Adds a plain task as a node.
+     * @param name Node name for logging
+     * @param func Task function
+     * @param context Context pointer passed to func
+     * @return Node index, declare its bus accesses with addAccess()
+     */
+    size_t addTask(const std::string &name, TaskFunc func, void *context);
+
+    /**
+     * @brief Declares a bus access of a node.
+     * @param node Node index
+     * @param bus The accessed bus
+     * @param access Access mode
+     */
+    void addAccess(size_t node, const DSPBus &bus, DSPBusAccess access);
+
+    /**
+     * @brief Enables or disables a node for the following blocks.
+     *
+     * A disabled node is skipped, its successors still run. Buses the node
+     * overwrites may share storage, readers must skip them as well.
+     *
+     * @param node Node index
+     * @param enabled True to process the node
+     */
+    void setNodeEnabled(size_t node, bool enabled) { nodes[node].enabled = enabled; }
+
+    /**
+     * @brief Sets how buses share storage, takes effect at the next finalize().
+     *
+     * Sharing is permanent for the buses of the audio session: finalize()
+     * points every copy of a bus to the shared storage.
+     *
+     * @param mode Aliasing mode, Parallel by default
+     */
+    void setBusAliasing(BusAliasing mode) { busAliasing = mode; }
+
+    /**
+     * @brief Keeps the storage of a bus that is accessed outside the graph.
+     * @param bus The bus
+     */
+    void pinBus(const DSPBus &bus);
+
+    /**
+     * @brief Derives the dependencies and prepares the execution state.
+     *
+     * Called by DSP::finalizeAudio() for registered graphs.
+     */
+    void finalize();
+
+    /**
+     * @brief Processes one block, returns when all nodes have run.
+     *
+     * The nodes run with the engine and the block size current on the calling thread.
+     * @param dispatcher Dispatcher that provides the threads, runs serially if it has no workers,
+     *                   at most maxExecutors threads take part
+     */
+    void process(DSPDispatcher &dispatcher);
+
+    /**
+     * @brief Returns the number of nodes.
+     */
+    size_t size() const { return nodes.size(); }
+
+    /**
+     * @brief Returns the bytes of bus storage the nodes touch per block.
+     */
+    size_t getBusWorkingSet() const { return busWorkingSet; }
+
+    /**
+     * @brief Returns the bytes of bus storage the nodes would touch without sharing.
+     */
+    size_t getBusFootprint() const { return busFootprint; }
+
+    /**
+     * @brief Writes the nodes, their level and dependencies to DSP::log.
+     */
+    void log() const;
+
+    // Prevent copy construction and assignment
+    DSPGraph(const DSPGraph &) = delete;
+    DSPGraph &operator=(const DSPGraph &) = delete;
+
+private:
+    /**
+     * @brief A bus access of a node.
+     */
+    struct Access
+    {
+        const void *key;         ///< Bus key, see DSPBus::getKey()
+        DSPBusAccess access;     ///< Access mode
+        DSPBusChannels channels; ///< Sample buffers of the bus
+    };
+
+    /**
+     * @brief A node of the graph.
+     */
+    struct Node
+    {
+        std::string name;                ///< Name for logging
+        TaskFunc func;                   ///< Task function
+        void *context;                   ///< Task context
+        std::vector<Access> accesses;    ///< Bus accesses
+        std::vector<uint32_t> successors; ///< Nodes that depend on this one
+        uint32_t numPredecessors;        ///< Number of nodes this one depends on
+        size_t level;                    ///< Length of the longest dependency chain to this node
+        bool enabled;                    ///< False skips the task function
+    };
+
+    /**
+     * @brief Fixed-capacity Chase-Lev deque, the owner pushes and pops at the bottom, thieves take from the top.
+     *
+     * Every node is pushed at most once per block, so a capacity of the node count
+     * never wraps when top and bottom are reset before each block.
+     */
+    struct alignas(64) WorkQueue
+    {
+        std::atomic<int64_t> top;                  ///< Next index to steal
+        std::atomic<int64_t> bottom;               ///< Next index to push
+        std::unique_ptr<std::atomic<uint32_t>[]> items; ///< Node indices
+    };
+
+    /**
+     * @brief Lets buses with disjoint lifetimes share storage, adds edges in Serial mode.
+     */
+    void aliasBuses();
+
+    /**
+     * @brief Dispatcher job, one per executor.
+     */
+    static void executorJob(void *context, size_t index);
+
+    /**
+     * @brief Node task of a DSP object.
+     */
+    static void processObject(void *context);
+
+    /**
+     * @brief Runs nodes until all nodes of the block have completed.
+     */
+    void runExecutor(size_t self);
+
+    /**
+     * @brief Runs one node and pushes the successors it made ready to the executor's queue.
+     */
+    void runNode(size_t self, uint32_t node);
+
+    static void push(WorkQueue &queue, uint32_t node);
+    static bool pop(WorkQueue &queue, uint32_t &node);
+    static bool steal(WorkQueue &queue, uint32_t &node);
+
+    std::vector<Node> nodes;                         ///< All nodes in insertion order
+    std::vector<uint32_t> roots;                     ///< Nodes without predecessors
+    std::unique_ptr<std::atomic<uint32_t>[]> pending; ///< Unfinished predecessors per node
+    std::unique_ptr<WorkQueue[]> queues;             ///< One deque per executor
+    size_t numExecutors;                             ///< Executors of the current block
+    size_t criticalPath;                             ///< Number of levels
+    bool finalized;                                  ///< True after finalize()
+    BusAliasing busAliasing;                         ///< How buses share storage
+    DSPEngine *runEngine;                            ///< Engine of the current block, bound by the executors
+    dsp_float runSampleRate;                         ///< Sample rate of the current block
+    size_t runBlockSize;                             ///< Block size of the current block
+    std::vector<const void *> pinnedBuses;           ///< Keys of buses that keep their storage
+    size_t busWorkingSet;                            ///< Bus bytes touched per block
+    size_t busFootprint;                             ///< Bus bytes without sharing
+
+    alignas(64) std::atomic<size_t> completed; ///< Nodes completed in the current block
+};
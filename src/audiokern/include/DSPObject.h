@@ -2,11 +2,37 @@
 
 #include <stddef.h>
 #include <stdexcept>
+#include <string>
+#include <vector>
 #include "clamp.h"
+#include "Busses.h"
 #include "DSPSampleBuffer.h"
 #include "omfg.h"
 
-class DSP; // Forward declaration
+class DSP;       // Forward declaration
+class DSPGraph;  // Forward declaration
+class DSPEngine; // Forward declaration
+
+/**
+ * @brief How a DSP object accesses a connected bus during process().
+ */
+enum class DSPBusAccess
+{
+    Read,     ///< Bus is only read
+    Write,    ///< Bus is overwritten
+    ReadWrite ///< Bus is processed in place
+};
+
+/**
+ * @brief A bus connection of a DSP object, recorded by the connect*ToBus methods.
+ */
+struct DSPBusBinding
+{
+    std::string role;        ///< Connection role, e.g. "input" or "output"
+    const void *key;         ///< Bus key, see DSPBus::getKey()
+    DSPBusAccess access;     ///< Access mode
+    DSPBusChannels channels; ///< Sample buffers of the bus
+};
 
 /**
  * @brief Abstract base class for all DSP components.
@@ -17,6 +43,8 @@ class DSP; // Forward declaration
  */
 class DSPObject : public DSP
 {
+    friend class DSP;
+
 public:
     /**
      * @brief Constructs an uninitialized DSPObject.
@@ -34,6 +62,14 @@ public:
      */
     const std::string &getName() const { return objectName; }
 
+    /**
+     * @brief Returns the engine the object was initialized in.
+     *
+     * Buffers and buses of the object belong to this engine, it must be
+     * current while the object is processed.
+     */
+    DSPEngine &getEngine() const { return *engine; }
+
     /**
      * @brief Initializes the DSP object with a given name.
      * @param name The name to assign.
@@ -61,7 +97,33 @@ public:
      */
     void process();
 
+    /**
+     * @brief Returns the bus connections recorded for this object.
+     */
+    const std::vector<DSPBusBinding> &getBusBindings() const { return busBindings; }
+
+    /**
+     * @brief Adds this object to a processing graph.
+     *
+     * The default adds the object as one node. Composite objects can override
+     * this to add their parts as separate nodes, so they can run in parallel.
+     *
+     * @param graph The graph to add to
+     */
+    virtual void addToGraph(DSPGraph &graph);
+
 protected:
+    /**
+     * @brief Records a bus connection for dependency analysis.
+     *
+     * Connecting a role again replaces the previous binding of that role.
+     *
+     * @param role Connection role
+     * @param bus The connected bus
+     * @param access How process() accesses the bus
+     */
+    void declareBusAccess(const std::string &role, const DSPBus &bus, DSPBusAccess access);
+
     /**
      * @brief Typedef for the block processing function.
      *
@@ -111,4 +173,19 @@ private:
      * @brief Name assigned to this DSP object.
      */
     std::string objectName;
+
+    /**
+     * @brief Index in the DSP registry, used as profiler slot.
+     */
+    size_t registryIndex;
+
+    /**
+     * @brief Engine current when the object was initialized.
+     */
+    DSPEngine *engine;
+
+    /**
+     * @brief Bus connections recorded by declareBusAccess().
+     */
+    std::vector<DSPBusBinding> busBindings;
 };
@@ -1,8 +1,10 @@
 #pragma once
 
 #include "dsp_types.h"
+#include "DSPArena.h"
 #include <cstdlib>
 #include <memory>
+#include <utility>
 
 /**
  * @brief A template collection for managing DSP object pointers
@@ -14,12 +16,16 @@
  * Usage:
  * 
  * - Call add() to insert object pointers into the collection
+ * - Call create() to construct an object in a DSPArena, next to the
+ *   objects created before it
  * - Use operator[] for direct reference access to objects
  * - Call size() to get the current number of objects
  * - Call clear() to remove and delete all objects
  * 
  * The collection automatically deletes all managed objects when destroyed
- * or when clear() is called, ensuring no memory leaks.
+ * or when clear() is called, ensuring no memory leaks. Objects created in an
+ * arena are only destructed, their memory is reclaimed by DSPArena::reset().
+ * Such a collection must be cleared before the arena is reset.
  * 
  * Example:
  * @code
@@ -39,7 +45,7 @@ class DSPObjectCollection
 {
 public:
     DSPObjectCollection()
-        : objects(std::make_unique<T*[]>(initialCapacity))
+        : objects(std::make_unique<Entry[]>(initialCapacity))
         , objectCount(0)
         , capacity(initialCapacity)
     {
@@ -67,7 +73,30 @@ public:
             expandCapacity();
         }
         
-        objects[objectCount++] = objectPtr;
+        objects[objectCount++] = {objectPtr, false};
+        return *objectPtr;
+    }
+
+    /**
+     * @brief Constructs an object in an arena and adds it to the collection
+     * 
+     * The collection calls the destructor of the object when it is destroyed
+     * or cleared, the memory belongs to the arena.
+     *
+     * @param arena Arena the object is allocated from
+     * @param args Constructor arguments
+     * @return Reference to the managed object
+     */
+    template<typename... Args>
+    T& create(DSPArena& arena, Args&&... args)
+    {
+        if (objectCount >= capacity)
+        {
+            expandCapacity();
+        }
+
+        T* objectPtr = arena.create<T>(std::forward<Args>(args)...);
+        objects[objectCount++] = {objectPtr, true};
         return *objectPtr;
     }
 
@@ -82,7 +111,7 @@ public:
      */
     T& operator[](size_t index)
     {
-        return *objects[index];
+        return *objects[index].object;
     }
 
     /**
@@ -95,7 +124,7 @@ public:
      */
     const T& operator[](size_t index) const
     {
-        return *objects[index];
+        return *objects[index].object;
     }
 
     /**
@@ -118,7 +147,10 @@ public:
     {
         for (size_t i = 0; i < objectCount; ++i)
         {
-            delete objects[i];
+            if (objects[i].inArena)
+                objects[i].object->~T();
+            else
+                delete objects[i].object;
         }
         objectCount = 0;
     }
@@ -144,12 +176,19 @@ public:
      */
     T* getPointer(size_t index)
     {
-        return objects[index];
+        return objects[index].object;
     }
 
 private:
+    /// @brief Object pointer and whether its memory belongs to an arena
+    struct Entry
+    {
+        T* object;
+        bool inArena;
+    };
+
     /// @brief Internal storage for object pointers
-    std::unique_ptr<T*[]> objects;
+    std::unique_ptr<Entry[]> objects;
     
     /// @brief Current number of objects in the collection
     size_t objectCount;
@@ -168,7 +207,7 @@ private:
     void expandCapacity()
     {
         size_t newCapacity = capacity * 2;
-        auto newObjects = std::make_unique<T*[]>(newCapacity);
+        auto newObjects = std::make_unique<Entry[]>(newCapacity);
         
         // Copy existing pointers to new storage
         for (size_t i = 0; i < objectCount; ++i)
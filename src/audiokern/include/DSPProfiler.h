@@ -0,0 +1,177 @@
+#pragma once
+
+#include "dsp_types.h"
+#include <atomic>
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * @brief Aggregated profiling figures of one DSP object (or one object type).
+ */
+struct DSPProfileEntry
+{
+    std::string name;     ///< Object name from the DSP registry (or type name for grouped views)
+    uint64_t calls;       ///< Number of process() dispatches
+    double totalNs;       ///< Inclusive time spent in process(), including nested objects
+    double selfNs;        ///< Exclusive time, nested process() calls subtracted
+    double maxNs;         ///< Longest single inclusive dispatch
+    double selfPerBlockNs; ///< Average exclusive time per audio block
+};
+
+/**
+ * @brief Opt-in hot path profiler for DSPObject::process().
+ *
+ * When enabled, every dispatch through DSPObject::process() is timestamped
+ * with a cheap cycle counter (rdtsc on x86, the virtual counter on AArch64,
+ * clock_gettime elsewhere). Figures are accumulated per registry slot into
+ * per-thread counters, so the audio thread and the voice worker threads never
+ * share a cache line or take a lock while profiling. The snapshot API sums all
+ * threads and maps slots back to the object names of DSP::getRegistry().
+ *
+ * Registry slots belong to a DSPEngine, so the figures are kept per engine:
+ * a thread has counters for each engine it dispatches objects of, and reset(),
+ * snapshot() and log() act on the engine current on the calling thread.
+ * Enabling switches the timing on for all engines.
+ *
+ * Nested dispatches (e.g. the oscillators and filter inside a voice) are
+ * tracked with a per-thread depth stack, so both inclusive and self time
+ * are available.
+ *
+ * Objects that are not in the registry are accounted under "(unregistered)".
+ */
+class DSPProfiler
+{
+public:
+    /// Maximum number of registry slots tracked per thread
+    static constexpr size_t maxSlots = 4096;
+
+    /// Slot used for objects without registry index
+    static constexpr size_t unregisteredSlot = maxSlots;
+
+    /// Maximum tracked nesting depth of process() calls
+    static constexpr size_t maxDepth = 32;
+
+    /**
+     * @brief Profiling state of one engine, owned by the DSPEngine.
+     */
+    class EngineState
+    {
+        friend class DSPProfiler;
+
+    public:
+        EngineState();
+
+        /// Hands the counters of the engine back to their threads for reuse
+        ~EngineState();
+
+        EngineState(const EngineState &) = delete;
+        EngineState &operator=(const EngineState &) = delete;
+
+    private:
+        uint32_t id;                        ///< Unique per engine, counters refer to it
+        std::atomic<uint32_t> generation{0}; ///< Bumped by reset()
+        std::atomic<long> blocks{0};        ///< Blocks counted since the last reset
+        std::atomic<uint64_t> startTicks{0}; ///< Cycle counter at the last reset
+        std::atomic<int64_t> startNs{0};    ///< Steady clock at the last reset
+    };
+
+    /**
+     * @brief Returns true if profiling is currently enabled.
+     */
+    static inline bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Enables or disables profiling. Enabling resets the counters of the current engine.
+     */
+    static void enable(bool enable);
+
+    /**
+     * @brief Discards the figures collected for the current engine.
+     *
+     * Counters are cleared lazily by their owning thread on its next dispatch.
+     */
+    static void reset();
+
+    /**
+     * @brief Counts one processed audio block of an engine, used for per block averages.
+     * @param state Profiling state of the engine
+     */
+    static inline void nextBlock(EngineState &state)
+    {
+        if (isEnabled())
+            state.blocks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Reads the cycle counter.
+     */
+    static inline uint64_t now()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#elif defined(__aarch64__)
+        uint64_t ticks;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+        return ticks;
+#else
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+#endif
+    }
+
+    /**
+     * @brief Marks the start of a profiled dispatch on the calling thread.
+     * @return Start time stamp to pass to end()
+     */
+    static uint64_t begin();
+
+    /**
+     * @brief Marks the end of a profiled dispatch on the calling thread.
+     * @param slot Registry slot of the dispatched object
+     * @param start Time stamp returned by begin()
+     */
+    static void end(size_t slot, uint64_t start);
+
+    /**
+     * @brief Sums the counters of all threads per registered object of the current engine.
+     * @return Entries sorted by self time, objects without calls are omitted
+     */
+    static std::vector<DSPProfileEntry> snapshot();
+
+    /**
+     * @brief Like snapshot(), but objects are grouped by name with all digits
+     *        stripped, e.g. the six voice filters end up in one entry.
+     */
+    static std::vector<DSPProfileEntry> snapshotByType();
+
+    /**
+     * @brief Writes a formatted report of the current figures to DSP::log.
+     * @param maxEntries Maximum number of rows per table
+     */
+    static void log(size_t maxEntries = 20);
+
+    /**
+     * @brief Number of audio blocks of the current engine counted since the last reset.
+     */
+    static long getBlocks();
+
+private:
+    struct ThreadCounters;
+
+    static EngineState &currentState();
+    static ThreadCounters &threadCounters(EngineState &state);
+    static ThreadCounters *createThreadCounters();
+    static std::vector<ThreadCounters *> &getCounterRegistry();
+    static void clearCounters(ThreadCounters &c);
+    static double ticksPerNs(const EngineState &state);
+
+    static std::atomic<bool> enabled;
+};
@@ -8,12 +8,17 @@
 #include <string>
 #include <cstring>
 #include <cmath>
+#include <unordered_map>
 
 /**
  * @brief Represents a sample buffer used for audio signal processing.
  *
  * This class manages a 1D buffer of `host_float` values (either `float` or `double`, depending on `HOST_USE_DOUBLE`).
- * The buffer can either own its memory or refer to external/shared memory.
+ * The buffer either refers to a 64-byte aligned slice of the DSP arena (see DSP::getArena())
+ * or to external/shared memory. Arena slices stay valid until DSP::initializeAudio(...).
+ *
+ * Copies of a buffer share its memory. All buffers are tracked, so the memory
+ * every copy refers to can be exchanged at once with redirect().
  */
 class DSPSampleBuffer
 {
@@ -24,10 +29,26 @@ public:
     DSPSampleBuffer();
 
     /**
-     * @brief Destroys the buffer and releases owned memory.
+     * @brief Constructs a buffer that shares the memory of another buffer.
+     * @param other Source buffer to link to.
+     */
+    DSPSampleBuffer(const DSPSampleBuffer &other);
+
+    /**
+     * @brief Destroys the buffer, arena memory is reclaimed by the arena.
      */
     ~DSPSampleBuffer();
 
+    /**
+     * @brief Points all buffers that refer to given memory to other memory.
+     *
+     * Used to give buses with disjoint lifetimes shared storage. Must not be
+     * called while buffers are processed.
+     *
+     * @param targets Replacement per memory start, the memory must be at least as large
+     */
+    static void redirect(const std::unordered_map<const host_float *, const host_float *> &targets);
+
     /**
      * @brief Returns the name assigned to this buffer.
      * @return Reference to the buffer name string.
@@ -35,7 +56,10 @@ public:
     const std::string &getName() const { return bufferName; }
 
     /**
-     * @brief Initializes the buffer with a given name and size, allocating memory.
+     * @brief Initializes the buffer with a given name and size, allocating a zeroed arena slice.
+     *
+     * The slice is aligned to 64 bytes and padded to full cache lines.
+     *
      * @param name Name of the buffer.
      * @param size Number of samples.
      */
@@ -76,6 +100,14 @@ public:
      */
     void assign(const std::string &name, host_float *externalBuffer);
 
+    /**
+     * @brief Assigns an external buffer of known size and name.
+     * @param name Name to assign.
+     * @param externalBuffer External sample buffer (not owned).
+     * @param size Number of samples in the external buffer.
+     */
+    void assign(const std::string &name, host_float *externalBuffer, size_t size);
+
     /**
      * @brief Fills the buffer with a constant value.
      * @param value Value to fill.
@@ -119,7 +151,7 @@ public:
     host_float peak() const;
 
     /**
-     * @brief Frees allocated memory if owned.
+     * @brief Detaches the buffer from its memory.
      */
     void free();
 
@@ -140,6 +172,17 @@ public:
 private:
     host_float *buffer = nullptr; ///< Pointer to buffer memory
     size_t bufferSize = 0;        ///< Number of samples
-    bool ownsBuffer = false;      ///< Whether this instance owns the memory
     std::string bufferName;       ///< Human.meadable name for logging/debugging
+
+    DSPSampleBuffer *previousBuffer = nullptr; ///< Previous tracked buffer
+    DSPSampleBuffer *nextBuffer = nullptr;     ///< Next tracked buffer
+
+    /// Adds the buffer to the tracked buffers
+    void track();
+
+    /// Removes the buffer from the tracked buffers
+    void untrack();
+
+    /// First tracked buffer
+    static DSPSampleBuffer *firstBuffer;
 };
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+/**
+ * @brief Fixed-capacity lock-free queue for one producer and one consumer thread.
+ *
+ * The records are stored in place, so pushing and popping never allocate,
+ * lock or wait. Typically a control thread (GUI, Pd messages, MIDI) pushes
+ * small records that the audio thread pops once per block.
+ *
+ * Each side keeps a cached copy of the other side's index, so the shared
+ * cache lines are only read when the ring looks full or empty.
+ *
+ * Usage:
+ * @code
+ * DSPSpscRing<Command, 32> ring;
+ *
+ * // Producer thread
+ * if (!ring.push(command))
+ *     ... ring full, the command is not queued
+ *
+ * // Consumer thread
+ * Command command;
+ * while (ring.pop(command))
+ *     apply(command);
+ * @endcode
+ *
+ * @tparam T Record type, must be trivially copyable
+ * @tparam Capacity Number of records, must be a power of two
+ */
+template <typename T, size_t Capacity>
+class DSPSpscRing
+{
+    static_assert(std::is_trivially_copyable<T>::value, "DSPSpscRing: records must be trivially copyable");
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "DSPSpscRing: capacity must be a power of two");
+
+public:
+    DSPSpscRing() : head(0), cachedTail(0), tail(0), cachedHead(0)
+    {
+    }
+
+    /**
+     * @brief Appends a record, called by the producer thread only.
+     * @param record Record to copy into the ring
+     * @return False if the ring is full, the record is not queued then
+     */
+    bool push(const T &record)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+
+        if (h - cachedTail == Capacity)
+        {
+            cachedTail = tail.load(std::memory_order_acquire);
+
+            if (h - cachedTail == Capacity)
+                return false;
+        }
+
+        records[h & mask] = record;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest record, called by the consumer thread only.
+     * @param record Receives the record
+     * @return False if the ring is empty
+     */
+    bool pop(T &record)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+
+        if (t == cachedHead)
+        {
+            cachedHead = head.load(std::memory_order_acquire);
+
+            if (t == cachedHead)
+                return false;
+        }
+
+        record = records[t & mask];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Checks for queued records, exact on the consumer thread.
+     */
+    bool empty() const
+    {
+        return tail.load(std::memory_order_relaxed) == head.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Returns the number of records the ring holds.
+     */
+    static constexpr size_t capacity() { return Capacity; }
+
+    // The indices are shared with the other thread
+    DSPSpscRing(const DSPSpscRing &) = delete;
+    DSPSpscRing &operator=(const DSPSpscRing &) = delete;
+
+private:
+    static constexpr size_t mask = Capacity - 1;
+
+    alignas(64) std::atomic<size_t> head; ///< Next slot to write, owned by the producer
+    size_t cachedTail;                    ///< Producer's copy of tail
+
+    alignas(64) std::atomic<size_t> tail; ///< Next slot to read, owned by the consumer
+    size_t cachedHead;                    ///< Consumer's copy of head
+
+    alignas(64) T records[Capacity]; ///< Record storage
+};
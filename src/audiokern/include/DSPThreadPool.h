@@ -95,7 +95,8 @@ private:
     /**
      * @brief The worker loop executed by each thread.
      *
-     * Waits for new tasks, executes them, and signals completion.
+     * Waits for new tasks, executes them, and signals completion. Subnormal
+     * floats are flushed to zero on the worker threads.
      */
     void workerThread();
 
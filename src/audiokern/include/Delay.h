@@ -93,6 +93,11 @@ private:
      */
     static void processBlock(DSPObject *dsp);
 
+    /**
+     * @brief Applies a delay time queued by setTime() at the fade midpoint.
+     */
+    static void applyTime(const ParamFader::ParamChange &change);
+
     /**
      * @brief Processes one audio block: applies delay and feedback.
      */
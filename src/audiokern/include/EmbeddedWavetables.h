@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+/**
+ * @brief A wavetable set linked into the library, see WavetableFile for the image layout.
+ */
+struct EmbeddedWavetable
+{
+    const char *name;       ///< Waveform name, e.g. "saw"
+    uint32_t sampleRate;    ///< Sample rate the tables were generated for
+    const uint8_t *begin;   ///< Start of the image
+    const uint8_t *end;     ///< End of the image
+};
+
+/**
+ * @brief Directory of the wavetable sets precomputed at build time.
+ *
+ * The audiokern Makefile builds and runs tools/wtgen, which generates the
+ * tables of every waveform for the common sample rates and emits them as
+ * read-only data (.incbin) plus this directory. Looking up a set is a scan
+ * over a few dozen entries, no file is touched.
+ */
+class EmbeddedWavetables
+{
+public:
+    /**
+     * @brief Finds the embedded set of a waveform.
+     * @param name Waveform name
+     * @param sampleRate Sample rate
+     * @return The set or nullptr if it was not generated for this rate
+     */
+    static const EmbeddedWavetable *find(const std::string &name, uint32_t sampleRate);
+
+    /**
+     * @brief Returns the number of embedded sets.
+     */
+    static size_t size() { return numEntries; }
+
+private:
+    static const EmbeddedWavetable entries[]; ///< Generated directory
+    static const size_t numEntries;           ///< Number of generated entries
+};
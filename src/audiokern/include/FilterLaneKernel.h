@@ -0,0 +1,92 @@
+#pragma once
+
+#include "dsp_types.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Structure-of-arrays state of the lowpass filters of several voices.
+ *
+ * Every array holds one lane per voice, so a SIMD kernel filters as many
+ * voices per instruction as its vector has lanes. Lanes whose active mask
+ * is 0 are not processed, their state stays as it is.
+ */
+struct FilterLaneState
+{
+    /// Maximum number of lanes of any kernel
+    static constexpr size_t maxLanes = 8;
+
+    alignas(64) host_float y1L[maxLanes];       ///< First integrator, left
+    alignas(64) host_float y2L[maxLanes];       ///< Second integrator = output, left
+    alignas(64) host_float y1R[maxLanes];       ///< First integrator, right
+    alignas(64) host_float y2R[maxLanes];       ///< Second integrator = output, right
+    alignas(64) host_float resonance[maxLanes]; ///< Feedback gain
+    alignas(64) host_float drive[maxLanes];     ///< Gain before the soft clip
+    alignas(64) uint32_t active[maxLanes];      ///< All bits set if the lane holds a voice, else 0
+};
+
+/**
+ * @brief Samples of one filtered block, voice-major: sample i of lane v is at [i * lanes + v].
+ */
+struct FilterLaneBlock
+{
+    host_float *l;            ///< Left input, replaced by the output
+    host_float *r;            ///< Right input, replaced by the output
+    const host_float *cutoff; ///< Cutoff frequency in Hz
+    host_float T;             ///< 1 / sample rate
+    size_t numSamples;        ///< Samples to filter
+};
+
+/**
+ * @brief Runs the KorgonFilter lowpass of several voices with SIMD lanes across voices.
+ *
+ * The kernel is picked once at startup: AVX2 (8 voices per instruction),
+ * SSE2 or NEON (4) or a portable scalar loop over 4 lanes. The SIMD kernels
+ * require single precision host samples and fall back to the scalar loop
+ * otherwise.
+ *
+ * Per lane and sample the kernel computes the same steps as
+ * KorgonFilter::processBlockLP(): samples with a cutoff above 15 kHz pass
+ * unchanged, all others run through the two integrators with resonance
+ * feedback and the asymmetric soft clip. The SIMD kernels use float constants
+ * and fold 2 pi into the sample period, their output differs from the
+ * scalar filter by the rounding the integrators accumulate.
+ */
+class FilterLaneKernel
+{
+public:
+    /**
+     * @brief Filters a block and advances the integrators of the active lanes.
+     * @param state Filter state, getLanes() lanes are processed
+     * @param block Voice-major samples with getLanes() lanes per sample
+     */
+    static void processLP(FilterLaneState &state, const FilterLaneBlock &block);
+
+    /**
+     * @brief Returns the number of lanes of the selected kernel.
+     */
+    static size_t getLanes();
+
+    /**
+     * @brief Returns the name of the selected kernel, e.g. "avx2".
+     */
+    static const char *getName();
+
+private:
+    using ProcessFunc = void (*)(FilterLaneState &, const FilterLaneBlock &);
+
+    /**
+     * @brief The kernel picked for this CPU.
+     */
+    struct Kernel
+    {
+        ProcessFunc process; ///< Process function
+        size_t lanes;        ///< Lanes per sample
+        const char *name;    ///< Kernel name
+    };
+
+    /**
+     * @brief Returns the kernel for this CPU, selected on first use.
+     */
+    static const Kernel &kernel();
+};
@@ -2,10 +2,12 @@
 
 #include "SoundProcessor.h"
 #include "DSPSampleBuffer.h"
+#include "FilterLaneKernel.h"
 #include "VoiceOptions.h"
 #include "dsp_types.h"
 #include "clamp.h"
 #include "dsp_math.h"
+#include <algorithm>
 #include <cmath>
 
 /**
@@ -57,6 +59,22 @@ public:
      */
     void reset();
 
+    /**
+     * @brief Processes the filters of several voices at once.
+     *
+     * Lowpass filters are packed into the SIMD lanes of FilterLaneKernel, one
+     * voice per lane, lanes without a filter are masked. Highpass filters are
+     * processed one by one. The lanes compute the coefficients in single precision
+     * from a precomputed 2 pi T, so the result matches calling process() on each
+     * filter only within float rounding. The integrators accumulate the rounding,
+     * in the jpbench timeline the output differs by up to about 0.5 % of the
+     * signal peak (2.5e-4 at a peak of 0.073).
+     *
+     * @param filters Filters to process, distinct objects
+     * @param count Number of filters
+     */
+    static void processBatch(KorgonFilter *const *filters, size_t count);
+
 protected:
     /**
      * @brief Initializes the processor, including state and bus connections.
@@ -90,6 +108,14 @@ private:
      */
     void processBlockHP();
 
+    /**
+     * @brief Runs up to FilterLaneKernel::getLanes() lowpass filters in the lanes of one kernel call per chunk.
+     */
+    static void processLanes(KorgonFilter *const *filters, size_t count);
+
+    /// Samples per kernel call, the voice-major chunk lives on the stack
+    static constexpr size_t laneChunkSize = 32;
+
     // === Filter State ===
 
     host_float y1L; ///< Output of first integrator (left channel)
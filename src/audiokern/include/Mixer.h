@@ -39,6 +39,17 @@ public:
      */
     void connectOutputToBus(DSPAudioBus &bus);
 
+    /**
+     * @brief Includes or excludes an input from the mix.
+     *
+     * Inactive inputs are skipped entirely, their bus content is not read.
+     * All inputs are active after initialization.
+     *
+     * @param index Index of the input channel
+     * @param active True to mix the input
+     */
+    void setInputActive(size_t index, bool active) { inputActive[index] = active; }
+
 protected:
     /**
      * @brief Initializes the mixer instance and registers input busses.
@@ -67,5 +78,6 @@ private:
 
     size_t busCount;                   // Number of input busses
     std::vector<DSPAudioBus *> busses; // The actual input buffers
+    std::vector<bool> inputActive;     // Inputs included in the mix
     DSPAudioBus outputBus;             // Output bus where the mixed signal is written
 };
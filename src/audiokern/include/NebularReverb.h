@@ -9,6 +9,7 @@
 #include "ButterworthFilter.h"
 #include "HadamardMatrixMixer.h"
 #include <array>
+#include <memory>
 #include <vector>
 
 /**
@@ -70,6 +71,15 @@ public:
      */
     void setTimeRatio(dsp_math::TimeRatio ratio);
 
+    /**
+     * @brief Adds the reverb as separate nodes: damping, one per comb delay, the mix and the wet fader.
+     *
+     * The comb delays are independent of each other and run in parallel.
+     *
+     * @param graph The graph to add to
+     */
+    void addToGraph(DSPGraph &graph) override;
+
 protected:
     /**
      * @brief Called during DSP activation. Prepares all delay lines and faders.
@@ -99,6 +109,36 @@ private:
      */
     void processBlock();
 
+    /**
+     * @brief Pushes the input into a comb delay and processes it, if the line is active.
+     * @param index Delay line index
+     */
+    void processDelay(int index);
+
+    /**
+     * @brief Sums the active delay lines into the wet bus.
+     */
+    void mixDelays();
+
+    /**
+     * @brief Context of a comb delay graph task.
+     */
+    struct DelayTask
+    {
+        NebularReverb *reverb; ///< Owning reverb
+        int index;             ///< Delay line index
+    };
+
+    /**
+     * @brief Graph task of a comb delay.
+     */
+    static void processDelayTask(void *context);
+
+    /**
+     * @brief Graph task of the delay mix.
+     */
+    static void mixDelaysTask(void *context);
+
     /**
      * @brief Updates internal delay lines based on the current parameters.
      * Called after each parameter change.
@@ -118,7 +158,7 @@ private:
     dsp_math::TimeRatio timeRatio;
 
     /// @brief All comb delay instances
-    std::vector<CombDelay *> delays;
+    std::vector<std::unique_ptr<CombDelay>> delays;
 
     /// @brief Unique names for bus registration
     std::vector<std::string> delayNames;
@@ -126,6 +166,9 @@ private:
     /// @brief Pointers to output buses of delay lines
     std::vector<DSPAudioBus *> delayBusses;    
 
+    /// @brief Graph task contexts of the delay lines
+    std::array<DelayTask, maxDelays> delayTasks;
+
     /// @brief combined with damping for damping the high end in the resulting signal
     ButterworthFilter lowPass;
 };
@@ -1,9 +1,9 @@
 #pragma once
 
-#include <functional>
-#include <queue>
+#include <atomic>
 #include "DSP.h"
 #include "DSPSampleBuffer.h"
+#include "DSPSpscRing.h"
 #include "SoundProcessor.h"
 #include "dsp_types.h"
 
@@ -15,7 +15,10 @@
  * click-free manner. It does this by fading the audio output down to zero,
  * applying the parameter change, and fading back up — all within a configurable sample duration.
  *
- * Changes are queued via `change(...)` and applied one at a time per audio block.
+ * Changes are small records holding a static apply function, the object it applies to
+ * and its arguments. `change(...)` copies them into a fixed lock-free ring, so a control
+ * thread can queue changes without allocating or blocking while the audio thread applies
+ * them at the fade midpoint.
  *
  * ### Usage Example
  * @code
@@ -23,9 +26,12 @@
  * fader.initialize();
  *
  * // Schedule a detune change for smooth application
- * fader.change([=]() {
- *     osc->setDetune(newDetune);
- * });
+ * static void applyDetune(const ParamFader::ParamChange &change)
+ * {
+ *     static_cast<Oscillator *>(change.target)->setDetune(change.value[0]);
+ * }
+ *
+ * fader.change({applyDetune, osc, nullptr, {newDetune, 0.0}, 0});
  *
  * DSP::connect(osc, fader);
  * DSP::connect(fader, output);
@@ -47,21 +53,48 @@ public:
     ParamFader();
 
     /**
-     * @brief Defines a deferred parameter change function.
+     * @brief A deferred parameter change.
      *
-     * This type is typically a lambda or callable that performs a DSP parameter update.
+     * The apply function is usually a static member of the owner that casts
+     * the target back, like the static processBlock functions of DSP objects.
      */
-    using ParamChange = std::function<void()>;
+    struct ParamChange
+    {
+        using ApplyFunc = void (*)(const ParamChange &change);
+
+        ApplyFunc apply;    ///< Performs the change on the audio thread
+        void *target;       ///< Object the change applies to
+        void *object;       ///< Pointer argument, e.g. an oscillator to switch to
+        dsp_float value[2]; ///< Numeric arguments
+        int count;          ///< Integer argument
+    };
+
+    /// Number of changes that can be queued between two fades
+    static constexpr size_t maxChanges = 32;
 
     /**
      * @brief Queues a parameter change to be applied safely.
      *
      * The change will be applied after the output signal fades out to silence,
      * and then the output will fade back in over `fadeLength` samples.
+     * May be called from one thread other than the audio thread, it never allocates or blocks.
      *
-     * @param fn The function that modifies DSP parameters.
+     * @param change The change record, it is copied.
+     * @return False if maxChanges changes are already queued, the change is dropped then.
+     */
+    bool change(const ParamChange &change);
+
+    /**
+     * @brief Indicates whether a queued change is still fading or waiting to be applied.
+     * Called on the audio thread.
+     * @return True while the fader has work to do
+     */
+    bool isPending() const { return applyParamChange || !changes.empty(); }
+
+    /**
+     * @brief Returns the number of changes dropped because the queue was full.
      */
-    void change(ParamChange fn);
+    size_t getDroppedChanges() const { return droppedChanges.load(std::memory_order_relaxed); }
 
 private:
     /**
@@ -75,9 +108,10 @@ private:
      */
     void processBlock();
 
-    std::queue<ParamChange> changes;  ///< Queue of scheduled parameter change functions
+    DSPSpscRing<ParamChange, maxChanges> changes; ///< Queue of scheduled parameter changes
+    std::atomic<size_t> droppedChanges{0}; ///< Changes lost to a full queue
     int fadeCounter = 0;              ///< Tracks current fade progress
     const int fadeLength = 16;        ///< Number of samples for fade-out and fade-in
     dsp_float fadeValue = 1.0;        ///< Current gain multiplier during fade
-    bool applyParamChange = false;    ///< Indicates that a change should be applied mid-fade
+    bool applyParamChange = false;    ///< Indicates that a fade is running, audio thread only
 };
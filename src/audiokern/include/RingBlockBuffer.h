@@ -71,6 +71,8 @@ public:
      *
      * Converts time settings into block-aligned sizes based on `DSP::sampleRate`.
      * Sets up internal ring buffers and prepares output and feedback buffers.
+     * Without a prior `setMaxTime()` the maximum is 5000 ms. Initializing again
+     * reuses the ring buffers.
      *
      * @param name Identifier used for logging/debugging.
      */
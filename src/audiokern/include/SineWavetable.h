@@ -11,7 +11,7 @@ public:
 
 protected:
     // Fills the given buffer with one cycle of a sine waveform
-    void createWavetable(DSPBuffer &buffer, dsp_float frequency) override;
+    void createWavetable(DSPBuffer &buffer, dsp_float frequency, dsp_float sampleRate) override;
 
 private:
     // Indicated if the wavetable has been loaded.
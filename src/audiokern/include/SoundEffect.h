@@ -89,6 +89,16 @@ protected:
      */
     void registerEffectBlockProcessor(BlockProcessor f);
 
+    /**
+     * @brief Adds the dry/wet fader as a graph node.
+     *
+     * For effects that add their processing to a graph in parts, the fader
+     * must come last.
+     *
+     * @param graph The graph to add to
+     */
+    void addWetFaderToGraph(DSPGraph &graph);
+
     /**
      * @brief Finalized initialization without voice count.
      */
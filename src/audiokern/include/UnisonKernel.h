@@ -0,0 +1,87 @@
+#pragma once
+
+#include "dsp_types.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Structure-of-arrays state of the unison voices of a wavetable oscillator.
+ *
+ * Every array holds one lane per voice, so a SIMD kernel renders as many
+ * voices per instruction as its vector has lanes. Lanes beyond the voice
+ * count must stay silent: zero gain and zero increment.
+ */
+struct UnisonState
+{
+    /// Maximum number of unison voices
+    static constexpr size_t maxVoices = 16;
+
+    alignas(64) host_float phase[maxVoices];     ///< Phase [0..1)
+    alignas(64) host_float increment[maxVoices]; ///< Phase increment per sample
+    alignas(64) host_float gainL[maxVoices];     ///< Left gain including amplitude compensation
+    alignas(64) host_float gainR[maxVoices];     ///< Right gain including amplitude compensation
+    alignas(64) uint32_t fmLeft[maxVoices];      ///< All bits set if the voice follows the left FM channel, else 0
+};
+
+/**
+ * @brief Parameters of one rendered block.
+ */
+struct UnisonBlock
+{
+    const host_float *table; ///< Wavetable, the size must be a power of two
+    uint32_t mask;           ///< Table size - 1
+    host_float size;         ///< Table size
+    const host_float *fmL;   ///< Left FM input, nullptr renders without FM
+    const host_float *fmR;   ///< Right FM input
+    host_float modIndex;     ///< FM depth
+    host_float *outL;        ///< Left output
+    host_float *outR;        ///< Right output
+    size_t numSamples;       ///< Samples to render
+};
+
+/**
+ * @brief Renders stacked unison voices from a wavetable with SIMD lanes across voices.
+ *
+ * The kernel is picked once at startup: AVX-512 (16 voices per instruction)
+ * or AVX2 (8) with hardware gathers, SSE2 or NEON (4) with scalar table
+ * loads, or a portable scalar loop. The SIMD kernels require single precision
+ * host samples and fall back to the scalar loop otherwise.
+ *
+ * Per voice and sample the kernel reads the table with linear interpolation
+ * at the (FM modulated) phase, adds it to the stereo output weighted by the
+ * voice gains and advances the phase.
+ */
+class UnisonKernel
+{
+public:
+    /**
+     * @brief Renders a block and advances the voice phases.
+     * @param state Voice state, all lanes of the selected kernel width are processed
+     * @param numVoices Number of voices in use
+     * @param block Table, FM input and output
+     * @return True if any voice phase wrapped
+     */
+    static bool render(UnisonState &state, size_t numVoices, const UnisonBlock &block);
+
+    /**
+     * @brief Returns the name of the selected kernel, e.g. "avx2".
+     */
+    static const char *getName();
+
+private:
+    using RenderFunc = bool (*)(UnisonState &, size_t, const UnisonBlock &);
+
+    /**
+     * @brief The kernel picked for this CPU.
+     */
+    struct Kernel
+    {
+        RenderFunc render; ///< Render function
+        const char *name;  ///< Kernel name
+    };
+
+    /**
+     * @brief Returns the kernel for this CPU, selected on first use.
+     */
+    static const Kernel &kernel();
+};
@@ -1,25 +1,33 @@
 #pragma once
 #include <vector>
 #include <memory>
+#include <stdint.h>
 
 /**
  * @brief Container for a single voice and its state metadata.
  *
- * This structure wraps a voice instance (`TVoice`) and tracks relevant voice
+ * This structure refers to a voice instance (`TVoice`) and tracks relevant voice
  * allocation metadata:
- * - The `age` counter is incremented on each allocation to track reuse order.
- * - The `note` represents the last MIDI note assigned to this voice.
+ * - The `stamp` is the value of the allocator's allocation counter when the
+ *   voice was last allocated, 0 if it never was.
+ * - The `note` represents the MIDI note currently assigned to this voice.
  * - The `reclaimable` flag determines if the voice may be reused (e.g. on Note-Off).
+ * - `prev` and `next` link the voice into the free or the active list of the allocator.
+ * - `sameNote` links voices that were allocated for the same note without a Note-Off.
  *
  * This structure is intended for use with `VoiceAllocator`.
  */
 template <typename TVoice>
 struct ManagedVoice
 {
-    std::unique_ptr<TVoice> voice; ///< Owned voice instance
-    int age = 0;                   ///< Allocation age counter (used for oldest-first logic)
-    int note = -1;                 ///< Last MIDI note assigned to this voice
-    bool reclaimable = true;      ///< Whether this voice can be reused (e.g., after Note-Off)
+    TVoice *voice = nullptr;       ///< Voice instance
+    std::unique_ptr<TVoice> owned; ///< Owner of the voice if it was handed over
+    uint64_t stamp = 0;            ///< Allocation counter at the last allocation
+    int note = -1;                 ///< MIDI note assigned to this voice
+    bool reclaimable = true;       ///< Whether this voice can be reused (e.g., after Note-Off)
+    int prev = -1;                 ///< Previous voice in its list, -1 at the head
+    int next = -1;                 ///< Next voice in its list, -1 at the tail
+    int sameNote = -1;             ///< Voice allocated earlier for the same note, -1 if none
 };
 
 /**
@@ -27,7 +35,19 @@ struct ManagedVoice
  *
  * `VoiceAllocator` manages a list of polyphonic voice objects and provides logic
  * for note-to-voice assignment, reuse, and access. Voices are wrapped in `ManagedVoice`
- * structures which track MIDI note assignment, allocation age, and reclaimability.
+ * structures which track MIDI note assignment, allocation stamp, and reclaimability.
+ *
+ * Every voice is linked into one of two lists that are kept in reuse order:
+ * - the free list holds reclaimable voices, unused ones first, then released ones
+ *   in the order they were released,
+ * - the active list holds voices with a held note in the order they were allocated.
+ *
+ * A table maps MIDI notes 0..127 to the voice allocated last for them. Allocating,
+ * selecting and releasing a note therefore take constant time independent of the
+ * number of voices, and no call allocates memory except add().
+ *
+ * setActiveCount() limits allocation to the first voices of the pool, so the
+ * polyphony can change while the pool stays in place.
  *
  * ### Usage Example
  * @code
@@ -38,8 +58,7 @@ struct ManagedVoice
  * JPVoice* voice = allocator.allocate(note);
  * voice->trigger(note, velocity);
  *
- * auto all = allocator.getVoices();
- * for (auto* v : all) v.mender();
+ * for (JPVoice* v : allocator.getVoices()) v->render();
  * @endcode
  *
  * @tparam TVoice Any voice type implementing your DSP voice logic (e.g., `JPVoice`)
@@ -48,6 +67,11 @@ template <typename TVoice>
 class VoiceAllocator
 {
 public:
+    /// Number of MIDI notes with a table entry, other notes are searched linearly
+    static constexpr int numNotes = 128;
+
+    VoiceAllocator();
+
     /**
      * @brief Clears the internal voice list and resets all metadata.
      */
@@ -56,24 +80,54 @@ public:
     /**
      * @brief Adds a new voice to the pool.
      *
-     * Takes ownership of the voice instance.
+     * Takes ownership of the voice instance. The voice is appended to the free list
+     * and can be allocated.
      *
      * @param v A unique pointer to a TVoice instance.
      */
     void add(std::unique_ptr<TVoice> v);
 
     /**
-     * @brief Returns raw pointers to all managed voices.
+     * @brief Adds a voice owned by the caller to the pool.
+     *
+     * Lets the caller keep its voices in one contiguous pool. The voice must
+     * outlive its use by the allocator, see clear(). The voice is appended to the
+     * free list and can be allocated.
+     *
+     * @param v A TVoice instance.
+     */
+    void add(TVoice *v);
+
+    /**
+     * @brief Returns raw pointers to all managed voices in index order.
+     *
+     * The vector is maintained by add() and clear(), reading it does not allocate.
      *
      * @return A vector of TVoice* (non-owning).
      */
-    std::vector<TVoice*> getVoices();
+    const std::vector<TVoice*> &getVoices() const { return voicePointers; }
+
+    /**
+     * @brief Limits allocation to the first voices of the pool.
+     *
+     * Voices from index count on are taken out of both lists and forget their
+     * notes, the caller stops those that still sound. Voices that become
+     * available again are appended to the free list. Does not allocate memory.
+     *
+     * @param count Number of voices that can be allocated, at most size().
+     */
+    void setActiveCount(size_t count);
+
+    /**
+     * @brief Returns the number of voices that can be allocated.
+     */
+    size_t getActiveCount() const { return activeCount; }
 
     /**
      * @brief Allocates a voice for the given MIDI note.
      *
-     * Reuses the oldest reclaimable voice, if available. If none is reclaimable,
-     * it reuses the oldest voice regardless of state.
+     * Takes the first voice of the free list. If none is reclaimable,
+     * it steals the voice allocated least recently.
      *
      * @param note MIDI note to assign.
      * @return A pointer to the selected TVoice.
@@ -83,6 +137,7 @@ public:
     /**
      * @brief Returns the voice currently assigned to the given MIDI note.
      *
+     * If the note was allocated several times, the latest voice is returned.
      * If no voice is found, returns nullptr.
      *
      * @param note MIDI note number.
@@ -93,10 +148,17 @@ public:
     /**
      * @brief Marks a voice with a given note as reclaimable (e.g. after Note-Off).
      *
+     * The voice is appended to the free list.
+     *
      * @param note MIDI note number.
      */
     void setReclaimable(int note);
 
+    /**
+     * @brief Returns the number of managed voices.
+     */
+    size_t size() const { return voices.size(); }
+
     /**
      * @brief Accesses a voice by index.
      *
@@ -131,7 +193,34 @@ public:
     void forEachVoice(Func&& fn);
 
 private:
+    /**
+     * @brief Head and tail of an intrusive voice list.
+     */
+    struct VoiceList
+    {
+        int head = -1; ///< First voice, reused next
+        int tail = -1; ///< Last voice
+    };
+
+    /// Appends a voice to the end of a list
+    void pushBack(VoiceList &list, int index);
+
+    /// Removes a voice from the list it is linked into
+    void unlink(VoiceList &list, int index);
+
+    /// Returns the index of the voice holding a note, -1 if there is none
+    int findNote(int note) const;
+
+    /// Removes a voice from the voices holding its note
+    void releaseNote(int index);
+
     std::vector<ManagedVoice<TVoice>> voices; ///< Internal list of managed voices
+    std::vector<TVoice*> voicePointers;       ///< Voices in index order, see getVoices()
+    VoiceList freeVoices;                     ///< Reclaimable voices in reuse order
+    VoiceList activeVoices;                   ///< Voices with a held note in allocation order
+    int noteTable[numNotes];                  ///< Voice index per MIDI note, -1 if none
+    size_t activeCount = 0;                   ///< Voices that can be allocated, see setActiveCount()
+    uint64_t allocations = 0;                 ///< Monotonic allocation counter
 };
 
 // Implementation
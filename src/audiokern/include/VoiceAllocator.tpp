@@ -1,116 +1,154 @@
 #pragma once
+#include "omfg.h"
 #include <stdexcept>
 
+template <typename TVoice>
+VoiceAllocator<TVoice>::VoiceAllocator()
+{
+    clear();
+}
+
 template <typename TVoice>
 void VoiceAllocator<TVoice>::clear()
 {
     voices.clear();
+    voicePointers.clear();
+
+    freeVoices = VoiceList();
+    activeVoices = VoiceList();
+    allocations = 0;
+    activeCount = 0;
+
+    for (int &index : noteTable)
+        index = -1;
 }
 
 template <typename TVoice>
 void VoiceAllocator<TVoice>::add(std::unique_ptr<TVoice> v)
+{
+    add(v.get());
+    voices.back().owned = std::move(v);
+}
+
+template <typename TVoice>
+void VoiceAllocator<TVoice>::add(TVoice *v)
 {
     ManagedVoice<TVoice> mv;
-    mv.voice = std::move(v);
-    mv.age = 0;
-    mv.note = -1;
-    mv.reclaimable = true;
+    mv.voice = v;
+
+    voicePointers.push_back(v);
     voices.push_back(std::move(mv));
+
+    setActiveCount(voices.size());
 }
 
 template <typename TVoice>
-std::vector<TVoice *> VoiceAllocator<TVoice>::getVoices()
+void VoiceAllocator<TVoice>::setActiveCount(size_t count)
 {
-    std::vector<TVoice *> result;
-    result.reserve(voices.size());
-    for (auto &mv : voices)
+    if (count > voices.size())
+        count = voices.size();
+
+    for (size_t i = count; i < activeCount; ++i)
+    {
+        int index = static_cast<int>(i);
+        auto &mv = voices[index];
+
+        if (mv.reclaimable)
+        {
+            unlink(freeVoices, index);
+        }
+        else
+        {
+            unlink(activeVoices, index);
+            releaseNote(index);
+        }
+
+        mv.reclaimable = true;
+        mv.note = -1;
+    }
+
+    for (size_t i = activeCount; i < count; ++i)
     {
-        result.push_back(mv.voice.get());
+        pushBack(freeVoices, static_cast<int>(i));
     }
-    return result;
+
+    activeCount = count;
 }
 
 template <typename TVoice>
 TVoice *VoiceAllocator<TVoice>::allocate(int note)
 {
-    if (voices.empty())
+    if (activeCount == 0)
         PANIC("VoiceAllocator: No voices available");
 
-    int bestIndex = -1;
-    int bestAge = -1;
+    int index;
 
-    // Step 1: Prefer reclaimable voices
-    for (size_t i = 0; i < voices.size(); ++i)
+    // Prefer reclaimable voices, else steal the voice allocated least recently
+    if (freeVoices.head != -1)
     {
-        if (voices[i].reclaimable && voices[i].age > bestAge)
-        {
-            bestAge = voices[i].age;
-            bestIndex = static_cast<int>(i);
-        }
+        index = freeVoices.head;
+        unlink(freeVoices, index);
     }
-
-    // Step 2: If no reclaimable voice, pick oldest overall
-    if (bestIndex == -1)
+    else
     {
-        for (size_t i = 0; i < voices.size(); ++i)
-        {
-            if (voices[i].age > bestAge)
-            {
-                bestAge = voices[i].age;
-                bestIndex = static_cast<int>(i);
-            }
-        }
+        index = activeVoices.head;
+        unlink(activeVoices, index);
+        releaseNote(index);
     }
 
-    // Update ages
-    for (auto &mv : voices)
-        mv.age++;
-
-    auto &selected = voices[bestIndex];
+    auto &selected = voices[index];
 
-    selected.age = 0;
+    selected.stamp = ++allocations;
     selected.reclaimable = false;
     selected.note = note;
+    selected.sameNote = -1;
 
-    return selected.voice.get();
+    if (note >= 0 && note < numNotes)
+    {
+        selected.sameNote = noteTable[note];
+        noteTable[note] = index;
+    }
+
+    pushBack(activeVoices, index);
+
+    return selected.voice;
 }
 
 template <typename TVoice>
 TVoice *VoiceAllocator<TVoice>::select(int note)
 {
-    for (auto &mv : voices)
-    {
-        if (mv.note == note)
-            return mv.voice.get();
-    }
+    int index = findNote(note);
 
-    return nullptr;
+    return index == -1 ? nullptr : voices[index].voice;
 }
 
 template <typename TVoice>
 void VoiceAllocator<TVoice>::setReclaimable(int note)
 {
-    for (auto &mv : voices)
-    {
-        if (mv.note == note)
-        {
-            mv.reclaimable = true;
-            mv.note = -1;
-            break;
-        }
-    }
+    int index = findNote(note);
+
+    if (index == -1)
+        return;
+
+    unlink(activeVoices, index);
+    releaseNote(index);
+
+    voices[index].reclaimable = true;
+    voices[index].note = -1;
+
+    pushBack(freeVoices, index);
 }
 
 template <typename TVoice>
 TVoice *VoiceAllocator<TVoice>::getVoice(size_t index)
 {
-    return voices.at(index).voice.get();
+    return voices.at(index).voice;
 }
 
 template <typename TVoice>
 const TVoice *VoiceAllocator<TVoice>::getVoice(size_t index) const
 {
-    return voices.at(index).voice.get();
+    return voices.at(index).voice;
 }
 
 template <typename TVoice>
@@ -128,4 +166,74 @@ void VoiceAllocator<TVoice>::forEachVoice(Func &&fn)
         if (managed.voice)
             fn(*managed.voice);
     }
-}
\ No newline at end of file
+}
+
+template <typename TVoice>
+void VoiceAllocator<TVoice>::pushBack(VoiceList &list, int index)
+{
+    auto &mv = voices[index];
+
+    mv.prev = list.tail;
+    mv.next = -1;
+
+    if (list.tail != -1)
+        voices[list.tail].next = index;
+    else
+        list.head = index;
+
+    list.tail = index;
+}
+
+template <typename TVoice>
+void VoiceAllocator<TVoice>::unlink(VoiceList &list, int index)
+{
+    auto &mv = voices[index];
+
+    if (mv.prev != -1)
+        voices[mv.prev].next = mv.next;
+    else
+        list.head = mv.next;
+
+    if (mv.next != -1)
+        voices[mv.next].prev = mv.prev;
+    else
+        list.tail = mv.prev;
+
+    mv.prev = mv.next = -1;
+}
+
+template <typename TVoice>
+int VoiceAllocator<TVoice>::findNote(int note) const
+{
+    if (note >= 0 && note < numNotes)
+        return noteTable[note];
+
+    // Notes outside the table are rare, only held voices can match
+    for (int index = activeVoices.head; index != -1; index = voices[index].next)
+    {
+        if (voices[index].note == note)
+            return index;
+    }
+
+    return -1;
+}
+
+template <typename TVoice>
+void VoiceAllocator<TVoice>::releaseNote(int index)
+{
+    int note = voices[index].note;
+
+    if (note < 0 || note >= numNotes)
+        return;
+
+    // Usually the voice is the latest one of its note, the chain is short otherwise
+    int *link = &noteTable[note];
+
+    while (*link != -1 && *link != index)
+        link = &voices[*link].sameNote;
+
+    if (*link == index)
+        *link = voices[index].sameNote;
+
+    voices[index].sameNote = -1;
+}
@@ -45,6 +45,13 @@ enum class FMType
     Relative
 };
 
+// Handling of a voice that is allocated again while it sounds
+enum class VoiceStealMode
+{
+    Retrigger, // Envelopes ramp down from their current level before the attack
+    Tail       // Attack starts at once, the old output fades out as a short tail
+};
+
 // Enum for selecting the filter mode
 enum class FilterMode
 {
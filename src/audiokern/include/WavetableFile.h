@@ -0,0 +1,177 @@
+#pragma once
+
+#include "dsp_types.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Read-only, memory-mapped binary wavetable set (.akwt).
+ *
+ * Layout (native byte order):
+ * - Header: magic "AKWTBL\0\0", format version, byte order mark, sample size,
+ *   sample rate, table version, number of tables, payload size and an FNV-1a
+ *   checksum over the payload
+ * - Directory: base frequency, size and data offset of every table
+ * - Table data: host_float samples, each table aligned to 64 bytes
+ *
+ * open() maps the file with PROT_READ and MAP_SHARED, so all oscillators and
+ * all processes using the same set share one copy in the page cache. A file
+ * that does not match this build (format, byte order, sample size), the sample
+ * rate or the table version, or whose checksum fails, is reported as stale.
+ * The same image can also be used in place from memory, e.g. when it is
+ * linked into the binary (see EmbeddedWavetables).
+ *
+ * Usage:
+ * @code
+ * WavetableFile file;
+ * if (!file.open("tables/saw_48000.akwt", 48000, 1))
+ * {
+ *     // generate, WavetableFile::write(...), open again
+ * }
+ * const host_float *table = file.getTable(0);
+ * @endcode
+ */
+class WavetableFile
+{
+public:
+    /// Version of the binary layout
+    static constexpr uint32_t formatVersion = 1;
+
+    /**
+     * @brief Constructs an unmapped file.
+     */
+    WavetableFile();
+
+    /**
+     * @brief Unmaps the file, pointers returned by getTable() become invalid.
+     */
+    ~WavetableFile();
+
+    /**
+     * @brief Maps and validates a table file.
+     * @param path File path
+     * @param sampleRate Expected sample rate
+     * @param tableVersion Expected version of the table content
+     * @return False if the file is missing or stale, the reason is logged
+     */
+    bool open(const std::string &path, uint32_t sampleRate, uint32_t tableVersion);
+
+    /**
+     * @brief Uses a table image in memory, the memory is not copied and must outlive this object.
+     *
+     * The checksum is not verified, the image is expected to be part of the binary.
+     *
+     * @param data Start of the image, aligned to 64 bytes
+     * @param size Image size in bytes
+     * @param sampleRate Expected sample rate
+     * @param tableVersion Expected version of the table content
+     * @return False if the image is stale
+     */
+    bool open(const void *data, size_t size, uint32_t sampleRate, uint32_t tableVersion);
+
+    /**
+     * @brief Unmaps the file or releases the memory image.
+     */
+    void close();
+
+    /**
+     * @brief Returns the number of tables.
+     */
+    size_t getNumTables() const { return entries.size(); }
+
+    /**
+     * @brief Returns the base frequency of a table.
+     */
+    host_float getBaseFrequency(size_t index) const { return static_cast<host_float>(entries[index].baseFrequency); }
+
+    /**
+     * @brief Returns the number of samples of a table.
+     */
+    size_t getTableSize(size_t index) const { return static_cast<size_t>(entries[index].size); }
+
+    /**
+     * @brief Returns the samples of a table, valid as long as the file is mapped.
+     */
+    const host_float *getTable(size_t index) const;
+
+    /**
+     * @brief Writes a table set.
+     *
+     * The file is written under a temporary name and renamed, so a concurrent
+     * reader never maps a partially written file.
+     *
+     * @param path File path
+     * @param sampleRate Sample rate of the tables
+     * @param tableVersion Version of the table content
+     * @param baseFrequencies Base frequency per table
+     * @param tables Samples per table
+     * @return False on I/O errors, the reason is logged
+     */
+    static bool write(const std::string &path,
+                      uint32_t sampleRate,
+                      uint32_t tableVersion,
+                      const std::vector<host_float> &baseFrequencies,
+                      const std::vector<std::vector<host_float>> &tables);
+
+    /**
+     * @brief Reads a legacy comma-separated .wave file (one "frequency,size,samples..." line per table).
+     * @param path File path
+     * @param baseFrequencies Receives the base frequency per table
+     * @param tables Receives the samples per table
+     * @return False if the file is missing or malformed
+     */
+    static bool readLegacy(const std::string &path,
+                           std::vector<host_float> &baseFrequencies,
+                           std::vector<std::vector<host_float>> &tables);
+
+    // Prevent copy construction and assignment, the mapping has a single owner
+    WavetableFile(const WavetableFile &) = delete;
+    WavetableFile &operator=(const WavetableFile &) = delete;
+
+private:
+    /**
+     * @brief File header.
+     */
+    struct Header
+    {
+        char magic[8];         ///< "AKWTBL\0\0"
+        uint32_t version;      ///< formatVersion
+        uint32_t byteOrder;    ///< byteOrderMark as written by this machine
+        uint32_t sampleBytes;  ///< sizeof(host_float)
+        uint32_t sampleRate;   ///< Sample rate of the tables
+        uint32_t tableVersion; ///< Version of the table content
+        uint32_t numTables;    ///< Number of directory entries
+        uint64_t payloadBytes; ///< Bytes following the header
+        uint64_t checksum;     ///< FNV-1a 64 over the payload
+    };
+
+    /**
+     * @brief Directory entry of a table.
+     */
+    struct Entry
+    {
+        double baseFrequency; ///< Lowest frequency the table is used for
+        uint64_t size;        ///< Number of samples
+        uint64_t offset;      ///< Byte offset of the samples from the start of the file
+    };
+
+    static constexpr uint32_t byteOrderMark = 0x01020304;
+
+    /**
+     * @brief FNV-1a 64 bit hash.
+     */
+    static uint64_t checksum(const uint8_t *data, size_t size);
+
+    /**
+     * @brief Validates the image and reads the directory.
+     * @return Reason why the image is stale, nullptr if it is valid
+     */
+    const char *validate(uint32_t sampleRate, uint32_t tableVersion, bool verifyChecksum);
+
+    const uint8_t *mapping;     ///< Image, nullptr if closed
+    size_t mappingSize;         ///< Image size in bytes
+    bool mapped;                ///< True if the image is a mapping owned by this object
+    std::vector<Entry> entries; ///< Directory copy
+};
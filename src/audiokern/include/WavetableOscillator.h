@@ -5,10 +5,17 @@
 #include "DSPSampleBuffer.h"
 #include "dsp_math.h"
 #include "clamp.h"
+#include "FastRand.h"
+#include "UnisonKernel.h"
+#include "WavetableFile.h"
+#include "EmbeddedWavetables.h"
+#include "DSPThreadPool.h"
 
 #include <vector>
+#include <deque>
 #include <cmath>
 #include <memory>
+#include <mutex>
 #include <fstream>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -22,25 +29,28 @@ class DSPObject; // Forward declaration
  * @brief Struct holding a shared wavetable set for reuse between oscillator instances.
  *
  * This structure is used to cache wavetable data across multiple oscillator instances
- * to avoid redundant recalculation or file loading. Tables are identified by a waveform name.
+ * to avoid redundant recalculation or file loading. Tables are identified by a waveform name
+ * and the sample rate they were generated for. The sets and their buffers are never released
+ * and never move, oscillators of any engine may refer to them.
  */
 struct SharedWavetableSet
 {
     std::string name;
+    uint32_t sampleRate; ///< Sample rate the tables are band-limited for
     std::vector<host_float> baseFrequencies;
     std::vector<size_t> tableSizes;
     std::vector<DSPSampleBuffer *> buffers;
+    std::shared_ptr<WavetableFile> file; ///< Mapped table file the buffers point into
 };
 
 /**
- * @brief Internal representation of a single oscillator voice with detune and stereo gain.
+ * @brief Configuration of a single unison voice with detune and stereo gain.
  *
- * Each WavetableVoice defines the phase state, detune offset, amplitude scaling, and stereo panning
- * used in polyphonic or unison-mode oscillator operation.
+ * Each WavetableVoice defines the detune offset, amplitude scaling, and stereo panning
+ * used in unison-mode oscillator operation. The per-sample state lives in UnisonState.
  */
 struct WavetableVoice
 {
-    host_float phase;        ///< Current oscillator phase [0..1)
     host_float detune_ratio; ///< Detune ratio relative to base frequency
     host_float amp_ratio;    ///< Amplitude weight for stereo spread
     host_float gainL;        ///< Gain applied to left channel
@@ -63,6 +73,46 @@ struct WavetableVoice
 class WavetableOscillator : public SoundGenerator
 {
 public:
+    /// Maximum number of unison voices
+    static constexpr int maxVoices = static_cast<int>(UnisonState::maxVoices);
+
+    /// Version of the generated table content, bump it to invalidate cached table files
+    static constexpr uint32_t tableVersion = 4;
+
+    /// Base frequency of the lowest mipmap level, every further level starts one octave higher
+    static constexpr host_float lowestFrequency = 20.0;
+
+    /// Smallest and largest table size of a mipmap level
+    static constexpr size_t minTableSize = 256;
+    static constexpr size_t maxTableSize = 16384;
+
+    /// Table version of the content of legacy CSV .wave files
+    static constexpr uint32_t legacyTableVersion = 1;
+
+    /**
+     * @brief Returns the unique waveform name the tables are stored under.
+     */
+    const std::string &getWaveformName() const { return waveformName; }
+
+    /**
+     * @brief Generates the wavetable set for DSP::sampleRate with createWavetable(), one level per thread.
+     * @param frequencies Receives the base frequency per table
+     * @param tables Receives the samples per table
+     */
+    void generate(std::vector<host_float> &frequencies, std::vector<std::vector<host_float>> &tables);
+
+    /**
+     * @brief Queues the generation of every level on a thread pool.
+     *
+     * The tables are complete after pool.wait(). Queue several oscillators
+     * before waiting to generate all of their levels in parallel.
+     *
+     * @param frequencies Receives the base frequency per table
+     * @param tables Receives the samples per table, must stay in place until pool.wait() returns
+     * @param pool Thread pool running the levels
+     */
+    void generate(std::vector<host_float> &frequencies, std::vector<std::vector<host_float>> &tables, DSPThreadPool &pool);
+
     /// Virtual destructor releases all allocated buffers
     ~WavetableOscillator();
 
@@ -72,7 +122,7 @@ public:
      * Re-initializes internal voice buffers. Must be ≥ 1.
      * Can be called at runtime to change number of stacked voices.
      *
-     * @param count Number of detuned voices (≥ 1)
+     * @param count Number of detuned voices, clamped to [1, maxVoices]
      */
     void setNumVoices(int count);
 
@@ -144,6 +194,51 @@ public:
      */
     void setAnalogDrift(host_float d);
 
+    /**
+     * @brief Enables the crossfade between mipmap levels.
+     *
+     * When the frequency moves into another octave from one block to the next,
+     * the block is rendered from both levels and faded from the previous to the
+     * new one, so per-block pitch modulation does not click at level boundaries.
+     * Enabled by default.
+     *
+     * @param enabled True to crossfade, false to switch hard
+     */
+    void setLevelCrossfade(bool enabled);
+
+    /**
+     * @brief Returns the table set the oscillator reads from, nullptr before initialize().
+     */
+    const SharedWavetableSet *getWavetable() const { return wavetable; }
+
+    /**
+     * @brief Switches the waveform by reading from another shared table set.
+     *
+     * Frequency, unison voices and phases are kept, the next block starts on the
+     * new tables without a level crossfade. Nothing is allocated, so the switch
+     * can be made on the audio thread.
+     *
+     * @param set Table set for DSP::sampleRate, see acquireWavetable()
+     */
+    void setWavetable(const SharedWavetableSet *set);
+
+    /**
+     * @brief Returns the shared table set of a waveform for DSP::sampleRate.
+     *
+     * The tables are taken from the cache, the embedded sets or a table file, or
+     * are generated by a temporary T if none exist. Oscillators switch between
+     * the returned sets with setWavetable() instead of holding one instance per waveform.
+     *
+     * @tparam T Concrete oscillator of the waveform, e.g. SawWavetable
+     * @return The set or nullptr if it could not be loaded
+     */
+    template <typename T>
+    static const SharedWavetableSet *acquireWavetable()
+    {
+        T oscillator;
+        return oscillator.acquireSharedWavetable();
+    }
+
 protected:
     /**
      * @brief Called by base class after DSP system is initialized.
@@ -168,15 +263,19 @@ protected:
      *
      * Must be implemented by concrete subclasses to fill the buffer with one waveform cycle.
      *
+     * Runs on the threads of a pool that have no engine bound, so the sample
+     * rate is passed instead of read from DSP::sampleRate.
+     *
      * @param buffer Output buffer to fill (high precision)
      * @param frequency Target base frequency of the waveform
+     * @param sampleRate Sample rate the table is band-limited for
      */
-    virtual void createWavetable(DSPBuffer &buffer, dsp_float frequency) = 0;
+    virtual void createWavetable(DSPBuffer &buffer, dsp_float frequency, dsp_float sampleRate) = 0;
 
-    /// List of frequency boundaries used to select wavetable variants
+    /// Lowest frequency of each mipmap level, octaves from lowestFrequency up to Nyquist
     std::vector<host_float> baseFrequencies;
 
-    /// Corresponding wavetable size for each frequency band
+    /// Corresponding wavetable size for each level, shrinking with pitch
     std::vector<size_t> tableSizes;
 
 private:
@@ -191,19 +290,26 @@ private:
     /// Processes a single block of audio for one voice
     void processBlockVoice();
 
-    /// Processes a single block of audio for all voices (polyphonic)
+    /// Renders one voice from a table into the outputs and advances the phase
+    void renderVoice(const DSPSampleBuffer &table, host_float *outL, host_float *outR);
+
+    /// Fades the output block in from the block rendered into the fade buffers
+    void crossfadeLevels();
+
+    /// Processes a single block of audio for all voices (unison), see UnisonKernel
     void processBlockVoices();
 
+    /// Copies the voice configuration into the SIMD lanes
+    void updateUnison();
+
     // === Wavetable generation and selection ===
 
-    /// Loads an existing wavetable set from file
-    bool load();
+    /// Maps the binary wavetable set, false if it is missing or stale
+    bool load(WavetableFile &file) const;
 
-    /// Saves the generated wavetable set to file
-    void save() const;
 
-    /// Selects the appropriate wavetable based on current frequency
-    void selectTable(double frequency);
+    /// Returns the mipmap level for a phase increment in O(1): the octave above lowestFrequency
+    size_t selectLevel(host_float increment) const;
 
     /// Recomputes voice detune settings
     void updateDetune();
@@ -211,19 +317,24 @@ private:
     /// Computes gain scaling based on number of voices
     host_float getVocieGain(int numVoices);
 
-    /// Attempts to acquire precomputed wavetable set from shared cache
-    void acquireSharedWavetable();
+    /// Returns the wavetable set of this waveform from the shared cache, loads or generates it if missing
+    const SharedWavetableSet *acquireSharedWavetable();
 
     // === Data ===
 
     std::string waveformName; ///< Unique name for this waveform
 
-    const DSPSampleBuffer *selectedWaveTable; ///< Pointer to currently selected table
-    size_t selectedWaveTableSize;             ///< Number of samples in selected table
-    host_float lastFrequency;                  ///< Last used frequency for table selection
+    static constexpr size_t noLevel = static_cast<size_t>(-1);
+
+    size_t selectedLevel = noLevel; ///< Mipmap level of the last block, noLevel before the first block
+    host_float levelScale = 0.0;    ///< Sample rate / lowestFrequency, maps an increment to octaves
+    bool levelCrossfade = true;     ///< Crossfade blocks that change the level
+    DSPSampleBuffer fadeL;          ///< Left block rendered from the previous level
+    DSPSampleBuffer fadeR;          ///< Right block rendered from the previous level
 
     int numVoices = 1;                  ///< Number of detuned voices
-    std::vector<WavetableVoice> voices; ///< Per-voice phase and detune states
+    std::vector<WavetableVoice> voices; ///< Per-voice detune and gain configuration
+    UnisonState unison;                 ///< Per-voice phase, increment and gain lanes
 
     host_float detune = 0.03;         ///< Detune spread factor
     host_float frequency = 440.0;     ///< Core oscillator frequency
@@ -239,7 +350,9 @@ private:
 
     host_float drift; ///< Optional analog-style drift
 
-    static std::vector<SharedWavetableSet> sharedWavetables; ///< Global shared cache
-    std::vector<DSPBuffer *> wavetableCalcBuffers;           ///< Temp buffer for table generation
-    std::vector<DSPSampleBuffer *> wavetableSampleBuffers;   ///< Final runtime wavetable data
+    FastRand phaseRand; ///< Random start phases, per object since voices may render in parallel
+
+    static std::deque<SharedWavetableSet> sharedWavetables; ///< Global shared cache, entries keep their address
+    static std::mutex sharedWavetablesMutex;                ///< Engines may initialize on different threads
+    const SharedWavetableSet *wavetable = nullptr;          ///< Tables read at runtime
 };
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <stdint.h>
 #include <thread>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
 /**
  * @brief Returns the number of hardware CPU cores available.
  *
@@ -14,3 +19,127 @@ inline unsigned int cpu_count()
 {
     return std::thread::hardware_concurrency();
 }
+
+/**
+ * @brief Hints the CPU that the calling thread is in a spin loop.
+ *
+ * Issues `pause` on x86 and `yield` on ARM, a no-op elsewhere.
+ */
+inline void cpu_relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield");
+#endif
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+/// FTZ (bit 15) and DAZ (bit 6) in MXCSR
+static constexpr unsigned int cpu_flush_mask = 0x8040;
+#elif defined(__aarch64__) || defined(__arm__)
+/// FZ (bit 24) in FPCR/FPSCR, flushes subnormal inputs and results
+static constexpr unsigned int cpu_flush_mask = 1u << 24;
+#else
+static constexpr unsigned int cpu_flush_mask = 0;
+#endif
+
+/**
+ * @brief Returns the floating-point control register of the calling thread.
+ *
+ * MXCSR on x86, FPCR on AArch64, FPSCR on 32-bit ARM, 0 elsewhere.
+ */
+inline unsigned int cpu_get_float_mode()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return _mm_getcsr();
+#elif defined(__aarch64__)
+    uint64_t fpcr;
+    asm volatile("mrs %0, fpcr" : "=r"(fpcr));
+    return static_cast<unsigned int>(fpcr);
+#elif defined(__arm__) && defined(__ARM_FP)
+    unsigned int fpscr;
+    asm volatile("vmrs %0, fpscr" : "=r"(fpscr));
+    return fpscr;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Sets the floating-point control register of the calling thread.
+ * @param mode Value returned by cpu_get_float_mode()
+ */
+inline void cpu_set_float_mode(unsigned int mode)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_setcsr(mode);
+#elif defined(__aarch64__)
+    uint64_t fpcr = mode;
+    asm volatile("msr fpcr, %0" : : "r"(fpcr));
+#elif defined(__arm__) && defined(__ARM_FP)
+    asm volatile("vmsr fpscr, %0" : : "r"(mode));
+#else
+    (void)mode;
+#endif
+}
+
+/**
+ * @brief Switches flush-to-zero/denormals-are-zero on or off for the calling thread.
+ *
+ * With flushing on, subnormal inputs and results of float and double
+ * arithmetic are replaced by zero. Decaying feedback paths (reverb, delay,
+ * filter states) otherwise end in subnormals, which the CPU processes many
+ * times slower than normal numbers.
+ */
+inline void cpu_flush_denormals(bool flush)
+{
+    unsigned int mode = cpu_get_float_mode();
+    unsigned int next = flush ? mode | cpu_flush_mask : mode & ~cpu_flush_mask;
+
+    if (next != mode)
+        cpu_set_float_mode(next);
+}
+
+/**
+ * @brief Sets flush-to-zero/denormals-are-zero for the lifetime of the guard.
+ *
+ * The previous floating-point mode of the thread is restored on destruction,
+ * so a host's own settings survive a call into the DSP.
+ *
+ * Usage:
+ * @code
+ * void workerLoop()
+ * {
+ *     DSPDenormalGuard denormals;
+ *     ...
+ * }
+ * @endcode
+ */
+class DSPDenormalGuard
+{
+public:
+    /**
+     * @brief Saves the current mode and switches flushing on or off.
+     * @param flush True to flush subnormals to zero
+     */
+    explicit DSPDenormalGuard(bool flush = true) : previous(cpu_get_float_mode())
+    {
+        cpu_flush_denormals(flush);
+    }
+
+    /**
+     * @brief Restores the mode saved by the constructor.
+     */
+    ~DSPDenormalGuard()
+    {
+        cpu_set_float_mode(previous);
+    }
+
+    // The saved mode belongs to the thread the guard was created on
+    DSPDenormalGuard(const DSPDenormalGuard &) = delete;
+    DSPDenormalGuard &operator=(const DSPDenormalGuard &) = delete;
+
+private:
+    unsigned int previous; ///< Mode before the guard
+};
@@ -93,6 +93,13 @@ void ADSR::triggerStart()
     enterPhase(startAtCurrentEnv ? ADSRPhase::Attack : ADSRPhase::Startup);
 }
 
+void ADSR::triggerRestart()
+{
+    currentEnv = 0.0;
+    phaseStartEnv = 0.0;
+    enterPhase(ADSRPhase::Attack);
+}
+
 void ADSR::triggerStop()
 {
     if (oneShot || phase == ADSRPhase::Idle || phase == ADSRPhase::Release)
@@ -130,38 +137,83 @@ void ADSR::enterPhase(ADSRPhase newPhase)
     }
 }
 
-void ADSR::phaseIdle()
+size_t ADSR::runLength(int samples, size_t count) const
+{
+    // A phase shortened below the current position ends after one sample
+    return std::min(count, static_cast<size_t>(std::max(1, samples - currentSample)));
+}
+
+void ADSR::renderSegment(host_float *out, size_t count, host_float start, host_float end, int samples, host_float shape)
+{
+    // Linear segments are a plain ramp the compiler vectorizes
+    if (shape == 1.0)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            host_float p = std::min(static_cast<host_float>(currentSample + static_cast<int>(i)) / samples, static_cast<host_float>(1.0));
+            out[i] = start + (end - start) * p;
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            host_float p = static_cast<host_float>(currentSample + static_cast<int>(i)) / samples;
+            out[i] = powerLerp(start, end, p, shape);
+        }
+    }
+
+    currentSample += static_cast<int>(count);
+    currentEnv = out[count - 1];
+}
+
+size_t ADSR::phaseIdle(host_float *out, size_t count)
 {
     currentEnv = 0.0;
+    std::fill(out, out + count, static_cast<host_float>(0.0));
+
+    return count;
 }
 
-void ADSR::phaseStartup()
+size_t ADSR::phaseStartup(host_float *out, size_t count)
 {
-    host_float p = static_cast<host_float>(currentSample) / startupSamples;
-    currentEnv = powerLerp(phaseStartEnv, 0.0, p, 1.0);
+    size_t n = runLength(startupSamples, count);
+    renderSegment(out, n, phaseStartEnv, 0.0, startupSamples, 1.0);
 
-    if (++currentSample >= startupSamples)
+    if (currentSample >= startupSamples)
     {
         phaseStartEnv = 0.0;
         enterPhase(ADSRPhase::Attack);
     }
+
+    return n;
 }
 
-void ADSR::phaseAttack()
+size_t ADSR::phaseAttack(host_float *out, size_t count)
 {
-    host_float p = static_cast<host_float>(currentSample) / attackSamples;
-    currentEnv = powerLerp(phaseStartEnv, 1.0, p, attackShape);
+    size_t n = runLength(attackSamples, count);
+    renderSegment(out, n, phaseStartEnv, 1.0, attackSamples, attackShape);
 
-    if (++currentSample >= attackSamples)
+    if (currentSample >= attackSamples)
         enterPhase(ADSRPhase::Decay);
+
+    return n;
 }
 
-void ADSR::phaseDecay()
+size_t ADSR::phaseDecay(host_float *out, size_t count)
 {
-    host_float p = static_cast<host_float>(currentSample) / decaySamples;
-    currentEnv = (1.0 - p) * (1.0 - sustainLevel) + sustainLevel;
+    size_t n = runLength(decaySamples, count);
 
-    if (++currentSample >= decaySamples)
+    for (size_t i = 0; i < n; ++i)
+    {
+        host_float p = static_cast<host_float>(currentSample + static_cast<int>(i)) / decaySamples;
+        out[i] = (1.0 - p) * (1.0 - sustainLevel) + sustainLevel;
+    }
+
+    currentSample += static_cast<int>(n);
+    currentEnv = out[n - 1];
+
+    if (currentSample >= decaySamples)
     {
         if (oneShot)
         {
@@ -173,31 +225,43 @@ void ADSR::phaseDecay()
             enterPhase(ADSRPhase::Sustain);
         }
     }
+
+    return n;
 }
 
-void ADSR::phaseSustain()
+size_t ADSR::phaseSustain(host_float *out, size_t count)
 {
     currentEnv = sustainLevel;
+    std::fill(out, out + count, sustainLevel);
+
+    return count;
 }
 
-void ADSR::phaseRelease()
+size_t ADSR::phaseRelease(host_float *out, size_t count)
 {
-    host_float p = static_cast<host_float>(currentSample) / releaseSamples;
-    currentEnv = powerLerp(phaseStartEnv, 0.0, p, releaseShape);
+    size_t n = runLength(releaseSamples, count);
+    renderSegment(out, n, phaseStartEnv, 0.0, releaseSamples, releaseShape);
 
-    if (++currentSample >= releaseSamples)
+    if (currentSample >= releaseSamples)
         enterPhase(ADSRPhase::Idle);
+
+    return n;
 }
 
-// Next sample block generation
+// Next sample block generation, one run per envelope phase instead of a call per sample
 void ADSR::processBlock(DSPObject *dsp)
 {
     ADSR *adsr = static_cast<ADSR *>(dsp);
     size_t blocksize = DSP::blockSize;
+    host_float *out = adsr->modulationBus.m.data();
+
+    for (size_t i = 0; i < blocksize;)
+    {
+        i += (adsr->*adsr->phaseFunc)(out + i, blocksize - i);
+    }
 
     for (size_t i = 0; i < blocksize; ++i)
     {
-        (adsr->*adsr->phaseFunc)();
-        adsr->modulationBus.m[i] = adsr->currentEnv * adsr->gain;
+        out[i] *= adsr->gain;
     }
-}
\ No newline at end of file
+}
@@ -7,8 +7,8 @@ static dsp_float bitAmplitude(int harmonic)
     return ((harmonic & 5) == 5) ? 1.0 / harmonic : 0.0;
 }
 
-void BitWavetable::createWavetable(DSPBuffer &buffer, dsp_float frequency)
+void BitWavetable::createWavetable(DSPBuffer &buffer, dsp_float frequency, dsp_float sampleRate)
 {
     // Fill one full waveform cycle (0 to 2π) across the buffer
-    WaveformGenerator::generateWavetable(buffer, frequency, bitAmplitude, 0.5);
+    WaveformGenerator::generateWavetable(buffer, frequency, sampleRate, bitAmplitude, 0.5);
 }
@@ -1,5 +1,6 @@
 #include "DSP.h"
 #include "Busses.h"
+#include "DSPEngine.h"
 #include "dsp_math.h"
 #include <stdexcept>
 
@@ -37,8 +38,6 @@ bool DSPBus::getIsManaged() const
 //            DSPModulationBus
 // *******************************************
 
-DSPObjectCollection<DSPModulationBus> DSPModulationBus::modulationBusses;
-
 void DSPModulationBus::initializeBus(size_t size)
 {
     m.initialize(getName(), size);
@@ -56,6 +55,8 @@ void DSPModulationBus::fill(host_float v)
 
 void DSPModulationBus::log()
 {
+    DSPObjectCollection<DSPModulationBus> &modulationBusses = DSPEngine::current().unmanagedModulationBusses;
+
     for (size_t i = 0; i < modulationBusses.size(); ++i)
     {
         DSPModulationBus &bus = modulationBusses[i];
@@ -71,6 +72,8 @@ void DSPModulationBus::log()
 
 void DSPModulationBus::validate()
 {
+    DSPObjectCollection<DSPModulationBus> &modulationBusses = DSPEngine::current().unmanagedModulationBusses;
+
     for (size_t i = 0; i < modulationBusses.size(); ++i)
     {
         try
@@ -87,17 +90,21 @@ void DSPModulationBus::validate()
 
 DSPModulationBus &DSPModulationBus::create(const std::string &name, size_t size)
 {
-    DSPModulationBus *newBus = new DSPModulationBus();
-    newBus->initialize(name, size, false);
-    return modulationBusses.add(newBus);
+    // Buses created by objects belong to the current engine
+    DSPModulationBus &newBus = DSPEngine::current().unmanagedModulationBusses.create(DSP::getArena());
+    newBus.initialize(name, size, false);
+    return newBus;
+}
+
+void DSPModulationBus::clear()
+{
+    DSPEngine::current().unmanagedModulationBusses.clear();
 }
 
 // *******************************************
 //              DSPAudioBus
 // *******************************************
 
-DSPObjectCollection<DSPAudioBus> DSPAudioBus::audioBusses;
-
 void DSPAudioBus::initializeBus(size_t size)
 {
     l.initialize("L_" + getName(), size);
@@ -118,6 +125,8 @@ void DSPAudioBus::multiplyWidth(DSPModulationBus &bus)
 
 void DSPAudioBus::log()
 {
+    DSPObjectCollection<DSPAudioBus> &audioBusses = DSPEngine::current().unmanagedAudioBusses;
+
     for (size_t i = 0; i < audioBusses.size(); ++i)
     {
         DSPAudioBus &bus = audioBusses[i];
@@ -138,6 +147,8 @@ void DSPAudioBus::log()
 
 void DSPAudioBus::validate()
 {
+    DSPObjectCollection<DSPAudioBus> &audioBusses = DSPEngine::current().unmanagedAudioBusses;
+
     for (size_t i = 0; i < audioBusses.size(); ++i)
     {
         try
@@ -155,7 +166,12 @@ void DSPAudioBus::validate()
 
 DSPAudioBus &DSPAudioBus::create(const std::string &name, size_t size)
 {
-    DSPAudioBus *newBus = new DSPAudioBus();
-    newBus->initialize(name, size, false);
-    return audioBusses.add(newBus);
+    DSPAudioBus &newBus = DSPEngine::current().unmanagedAudioBusses.create(DSP::getArena());
+    newBus.initialize(name, size, false);
+    return newBus;
+}
+
+void DSPAudioBus::clear()
+{
+    DSPEngine::current().unmanagedAudioBusses.clear();
 }
\ No newline at end of file
@@ -44,12 +44,15 @@ void CombDelay::setTime(host_float timeMS)
         tR = tL + offsetTime;
     }
 
-    paramFader.change(
-        [=]()
-        {
-            delayBuffer.setTime(tL, tR);
-            delayBuffer.clear();
-        });
+    paramFader.change({applyTime, this, nullptr, {tL, tR}, 0});
+}
+
+void CombDelay::applyTime(const ParamFader::ParamChange &change)
+{
+    CombDelay *self = static_cast<CombDelay *>(change.target);
+
+    self->delayBuffer.setTime(change.value[0], change.value[1]);
+    self->delayBuffer.clear();
 }
 
 void CombDelay::setTimeOffset(host_float offset)
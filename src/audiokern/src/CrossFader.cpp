@@ -15,16 +15,19 @@ void CrossFader::initializeObject()
 void CrossFader::connectInputAToBus(DSPAudioBus &bus)
 {
     inputBusA = bus;
+    declareBusAccess("inputA", bus, DSPBusAccess::Read);
 }
 
 void CrossFader::connectInputBToBus(DSPAudioBus &bus)
 {
     inputBusB = bus;
+    declareBusAccess("inputB", bus, DSPBusAccess::Read);
 }
 
 void CrossFader::connectOutputToBus(DSPAudioBus &bus)
 {
     outputBus = bus;
+    declareBusAccess("output", bus, DSPBusAccess::Write);
 }
 
 void CrossFader::setMix(double value)
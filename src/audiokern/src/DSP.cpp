@@ -7,17 +7,18 @@
 #include <cmath>
 #include "clamp.h"
 #include "DSP.h"
+#include "DSPArena.h"
+#include "DSPEngine.h"
 #include "DSPObject.h"
+#include "DSPGraph.h"
 #include "dsp_types.h"
 #include "dsp_math.h"
 #include "DSPBusManager.h"
+#include "DSPProfiler.h"
 #include "dsp_rnd.h"
 
-size_t DSP::blockSize = 64;
-dsp_float DSP::sampleRate = -1.0;
-bool DSP::initialized = false;
-long DSP::elapsedSamples = 0;
-long DSP::processedBlocks = 0;
+DSP_THREAD_LOCAL size_t DSP::blockSize = 64;
+DSP_THREAD_LOCAL dsp_float DSP::sampleRate = -1.0;
 size_t DSP::currentLogInterval = 0;
 
 // Dummy logger, does nothing
@@ -40,41 +41,81 @@ DSP::~DSP()
 // Indicates that the host turned the DSP off
 void DSP::off()
 {
-    initialized = false;
+    DSPEngine::current().initialized = false;
+}
+
+bool DSP::isInitialized()
+{
+    return DSPEngine::current().initialized;
 }
 
 void DSP::nextBlock()
 {
-    elapsedSamples += blockSize;
-    processedBlocks++;
+    DSPEngine &engine = DSPEngine::current();
+
+    engine.elapsedSamples += blockSize;
+    engine.processedBlocks++;
+
+    DSPProfiler::nextBlock(engine.profile);
 }
 
 // Initializes the DSP with samplerate and blocksize
 void DSP::initializeAudio(dsp_float rate, size_t size)
 {
+    DSPEngine &engine = DSPEngine::current();
+
+    engine.initializeStart = std::chrono::steady_clock::now();
+
     dsp_math::init_trig_lut();
     dsp_rnd::initialize();
 
-    sampleRate = clamp(rate, 1.0, maxSamplerate);
-    blockSize = clamp(size, static_cast<size_t>(1), maxBlockSize);
+    // The engine keeps the settings, the thread works with its copy
+    engine.sampleRate = sampleRate = clamp(rate, 1.0, maxSamplerate);
+    engine.blockSize = blockSize = clamp(size, static_cast<size_t>(1), maxBlockSize);
 
     DSP::log("DSP audio settings: samplerate is %f", sampleRate);
     DSP::log("DSP audio settings: block size is %i", blockSize);
 
-    getMutableRegistry().clear();
+    engine.registry.clear();
+    engine.registryIndex.clear();
+    engine.graphs.clear();
 
     DSPBusManager::clear();
 
+    // Bus objects are gone, all buffer memory is handed out again
+    engine.arena.reset();
+
+    // Registry slots are reassigned from here on
+    DSPProfiler::reset();
+
     currentLogInterval = 0;
-    initialized = true;
+    engine.elapsedSamples = 0;
+    engine.processedBlocks = 0;
+    engine.initialized = true;
 }
 
 void DSP::finalizeAudio()
 {
-    for (DSPObject *obj : getRegistry())
+    DSPEngine &engine = DSPEngine::current();
+
+    for (DSPObject *obj : engine.registry)
     {
         obj->finalize();
     }
+
+    // Dependencies are derived from the final bus connections
+    for (DSPGraph *graph : engine.graphs)
+    {
+        graph->finalize();
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - engine.initializeStart).count();
+
+    DSP::log("DSP start: %zu objects, %zu audio buses, %zu modulation buses in %.3f ms",
+             engine.registry.size(),
+             DSPBusManager::getAudioBusCount(),
+             DSPBusManager::getModulationBusCount(),
+             ms);
 }
 
 // Log function callback registration
@@ -85,30 +126,40 @@ void DSP::registerLogger(LogFunc func)
 
 void DSP::registerObject(DSPObject &obj)
 {
-    auto &registry = getMutableRegistry();
+    DSPEngine &engine = DSPEngine::current();
 
-    // Check for duplicate object name
-    for (const auto *existing : registry)
+    // Check for duplicate object name, the registry position is the handle
+    if (!engine.registryIndex.emplace(obj.getName(), engine.registry.size()).second)
     {
-        if (existing->getName() == obj.getName())
-        {
-            PANIC("DSP::registerObject: object name '" + obj.getName() + "' is already registered");
-        }
+        PANIC("DSP::registerObject: object name '" + obj.getName() + "' is already registered");
     }
 
     // Add new object to the registry
-    registry.push_back(&obj);
+    obj.registryIndex = engine.registry.size();
+    engine.registry.push_back(&obj);
 }
 
-std::vector<DSPObject *> &DSP::getMutableRegistry()
+DSPArena &DSP::getArena()
 {
-    static std::vector<DSPObject *> registry;
-    return registry;
+    return DSPEngine::current().arena;
 }
 
 const std::vector<DSPObject *> &DSP::getRegistry()
 {
-    return getMutableRegistry();
+    return DSPEngine::current().registry;
+}
+
+DSPObject *DSP::findObject(const std::string &name)
+{
+    DSPEngine &engine = DSPEngine::current();
+    auto it = engine.registryIndex.find(name);
+
+    return it == engine.registryIndex.end() ? nullptr : engine.registry[it->second];
+}
+
+void DSP::registerGraph(DSPGraph &graph)
+{
+    DSPEngine::current().graphs.push_back(&graph);
 }
 
 // Zeros a value if it is in the range of +/- epsilon
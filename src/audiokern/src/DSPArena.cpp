@@ -0,0 +1,115 @@
+#include "DSPArena.h"
+#include <cstring>
+
+// Slices cover full cache lines
+static size_t alignSize(size_t bytes)
+{
+    return (bytes + DSPArena::alignment - 1) & ~(DSPArena::alignment - 1);
+}
+
+DSPArena::DSPArena(size_t chunkSize)
+    : currentChunk(0), offset(0), bytesUsed(0), chunkSize(alignSize(chunkSize))
+{
+}
+
+DSPArena::~DSPArena()
+{
+    release();
+}
+
+void *DSPArena::allocate(size_t bytes)
+{
+    bytes = alignSize(bytes == 0 ? 1 : bytes);
+
+    // Continue in the next chunk that has room, chunks are kept after reset
+    while (currentChunk < chunks.size() && offset + bytes > chunks[currentChunk].size)
+    {
+        ++currentChunk;
+        offset = 0;
+    }
+
+    if (currentChunk == chunks.size())
+    {
+        addChunk(bytes);
+    }
+
+    void *slice = chunks[currentChunk].data + offset;
+    offset += bytes;
+    bytesUsed += bytes;
+
+    return slice;
+}
+
+host_float *DSPArena::allocateSamples(size_t count)
+{
+    size_t bytes = alignSize(count * sizeof(host_float));
+    host_float *samples = static_cast<host_float *>(allocate(bytes));
+
+    std::memset(samples, 0, bytes);
+
+    return samples;
+}
+
+void DSPArena::reset()
+{
+    if (chunks.size() > 1)
+    {
+        size_t total = getBytesReserved();
+
+        release();
+        addChunk(total);
+    }
+
+    currentChunk = 0;
+    offset = 0;
+    bytesUsed = 0;
+}
+
+void DSPArena::release()
+{
+    for (Chunk &chunk : chunks)
+    {
+        ::operator delete(chunk.data, std::align_val_t(alignment));
+    }
+
+    chunks.clear();
+    currentChunk = 0;
+    offset = 0;
+    bytesUsed = 0;
+}
+
+bool DSPArena::owns(const void *ptr) const
+{
+    const uint8_t *p = static_cast<const uint8_t *>(ptr);
+
+    for (const Chunk &chunk : chunks)
+    {
+        if (p >= chunk.data && p < chunk.data + chunk.size)
+            return true;
+    }
+
+    return false;
+}
+
+size_t DSPArena::getBytesReserved() const
+{
+    size_t total = 0;
+
+    for (const Chunk &chunk : chunks)
+    {
+        total += chunk.size;
+    }
+
+    return total;
+}
+
+void DSPArena::addChunk(size_t bytes)
+{
+    Chunk chunk;
+    chunk.size = bytes > chunkSize ? bytes : chunkSize;
+    chunk.data = static_cast<uint8_t *>(::operator new(chunk.size, std::align_val_t(alignment)));
+
+    chunks.push_back(chunk);
+    currentChunk = chunks.size() - 1;
+    offset = 0;
+}
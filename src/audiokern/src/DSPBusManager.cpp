@@ -1,8 +1,5 @@
 #include "DSPBusManager.h"
 
-DSPObjectCollection<DSPAudioBus> DSPBusManager::audioBusses;
-DSPObjectCollection<DSPModulationBus> DSPBusManager::modulationBusses;
-
 void DSPBusManager::initialize()
 {
     registerAudioBus(nullBusName);
@@ -13,16 +10,16 @@ void DSPBusManager::initialize()
 
 DSPAudioBus &DSPBusManager::registerAudioBus(const std::string &name)
 {
-    // Skip registration if channel name already exists
-    for (size_t i = 0; i < audioBusses.size(); ++i)
-    {
-        if (audioBusses[i].getName() == name)
-            PANIC("DSPBusManager: audio buffer " << audioBusses[i].getName() << " already exists");
-    }
+    DSPEngine &engine = DSPEngine::current();
+
+    // The handle is the position in the collection
+    if (!engine.audioBusHandles.emplace(name, engine.audioBusses.size()).second)
+        PANIC("DSPBusManager: audio buffer " << name << " already exists");
 
-    DSPAudioBus *newBus = new DSPAudioBus();
-    newBus->initialize(name, DSP::blockSize, true);
-    return audioBusses.add(newBus);
+    // The bus object and its buffers follow the previously registered bus
+    DSPAudioBus &newBus = engine.audioBusses.create(engine.arena);
+    newBus.initialize(name, DSP::blockSize, true);
+    return newBus;
 }
 
 DSPAudioBus &DSPBusManager::registerAudioBus(const std::string &name, host_float *outL, host_float *outR)
@@ -37,16 +34,16 @@ DSPAudioBus &DSPBusManager::registerAudioBus(const std::string &name, host_float
 
 DSPModulationBus &DSPBusManager::registerModulationBus(const std::string &name)
 {
-    // Skip registration if channel name already exists
-    for (size_t i = 0; i < modulationBusses.size(); ++i)
-    {
-        if (modulationBusses[i].getName() == name)
-            PANIC("DSPBusManager: modulation buffer " << modulationBusses[i].getName() << " already exists");
-    }
+    DSPEngine &engine = DSPEngine::current();
+
+    // The handle is the position in the collection
+    if (!engine.modulationBusHandles.emplace(name, engine.modulationBusses.size()).second)
+        PANIC("DSPBusManager: modulation buffer " << name << " already exists");
 
-    DSPModulationBus *newBus = new DSPModulationBus();
-    newBus->initialize(name, DSP::blockSize, true);
-    return modulationBusses.add(newBus);
+    // The bus object and its buffers follow the previously registered bus
+    DSPModulationBus &newBus = engine.modulationBusses.create(engine.arena);
+    newBus.initialize(name, DSP::blockSize, true);
+    return newBus;
 }
 
 DSPModulationBus &DSPBusManager::registerModulationBus(const std::string &name, host_float *out)
@@ -62,59 +59,82 @@ DSPModulationBus &DSPBusManager::registerModulationBus(const std::string &name,
 
 DSPAudioBus &DSPBusManager::getAudioBus(const std::string &name)
 {
-    for (size_t i = 0; i < audioBusses.size(); ++i)
-    {
-        if (audioBusses[i].getName() == name)
-            return audioBusses[i];
-    }
-
-    PANIC("invalid audio bus name: " << name);
+    return getAudioBus(getAudioBusHandle(name));
 }
 
 DSPModulationBus &DSPBusManager::getModulationBus(const std::string &name)
 {
-    for (size_t i = 0; i < modulationBusses.size(); ++i)
-    {
-        if (modulationBusses[i].getName() == name)
-            return modulationBusses[i];
-    }
+    return getModulationBus(getModulationBusHandle(name));
+}
+
+DSPBusManager::BusHandle DSPBusManager::getAudioBusHandle(const std::string &name)
+{
+    DSPEngine &engine = DSPEngine::current();
+
+    auto it = engine.audioBusHandles.find(name);
+
+    if (it == engine.audioBusHandles.end())
+        PANIC("invalid audio bus name: " << name);
+
+    return it->second;
+}
+
+DSPBusManager::BusHandle DSPBusManager::getModulationBusHandle(const std::string &name)
+{
+    DSPEngine &engine = DSPEngine::current();
 
-    PANIC("invalid modulation bus name: " << name);
+    auto it = engine.modulationBusHandles.find(name);
+
+    if (it == engine.modulationBusHandles.end())
+        PANIC("invalid modulation bus name: " << name);
+
+    return it->second;
 }
 
 // ----------- Clear -----------
 
 void DSPBusManager::clear()
 {
-    audioBusses.clear();
-    modulationBusses.clear();
+    DSPEngine &engine = DSPEngine::current();
+
+    engine.audioBusses.clear();
+    engine.modulationBusses.clear();
+
+    // Buckets are kept, the next session registers about as many buses
+    engine.audioBusHandles.clear();
+    engine.modulationBusHandles.clear();
+
+    DSPAudioBus::clear();
+    DSPModulationBus::clear();
 }
 
 void DSPBusManager::validate()
 {
-    for (size_t i = 0; i < audioBusses.size(); ++i)
+    DSPEngine &engine = DSPEngine::current();
+
+    for (size_t i = 0; i < engine.audioBusses.size(); ++i)
     {
         try
         {
-            audioBusses[i].l.isValid();
-            audioBusses[i].r.isValid();
+            engine.audioBusses[i].l.isValid();
+            engine.audioBusses[i].r.isValid();
         }
         catch (const std::runtime_error &e)
         {
-            DSP::log("AudioBus '%s' validation failed: %s", audioBusses[i].getName().c_str(), e.what());
+            DSP::log("AudioBus '%s' validation failed: %s", engine.audioBusses[i].getName().c_str(), e.what());
             throw;
         }
     }
 
-    for (size_t i = 0; i < modulationBusses.size(); ++i)
+    for (size_t i = 0; i < engine.modulationBusses.size(); ++i)
     {
         try
         {
-            modulationBusses[i].m.isValid();
+            engine.modulationBusses[i].m.isValid();
         }
         catch (const std::runtime_error &e)
         {
-            DSP::log("ModulationBus '%s' validation failed: %s", modulationBusses[i].getName().c_str(), e.what());
+            DSP::log("ModulationBus '%s' validation failed: %s", engine.modulationBusses[i].getName().c_str(), e.what());
             throw;
         }
     }
@@ -125,9 +145,11 @@ void DSPBusManager::validate()
 
 void DSPBusManager::log()
 {
-    for (size_t i = 0; i < audioBusses.size(); ++i)
+    DSPEngine &engine = DSPEngine::current();
+
+    for (size_t i = 0; i < engine.audioBusses.size(); ++i)
     {
-        DSPAudioBus &bus = audioBusses[i];
+        DSPAudioBus &bus = engine.audioBusses[i];
 
         DSP::log("Audio bus (managed): %s", bus.getName().c_str());
 
@@ -142,9 +164,9 @@ void DSPBusManager::log()
                  bus.r.peak());
     }
 
-    for (size_t i = 0; i < modulationBusses.size(); ++i)
+    for (size_t i = 0; i < engine.modulationBusses.size(); ++i)
     {
-        DSPModulationBus &bus = modulationBusses[i];
+        DSPModulationBus &bus = engine.modulationBusses[i];
 
         DSP::log("Modulation bus (managed): %s", bus.getName().c_str());
 
@@ -0,0 +1,214 @@
+#include "DSPDispatcher.h"
+#include "dsp_runtime.h"
+#include <climits>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be 32 bit");
+
+// Sleeps while *word == expected
+static void futexWait(std::atomic<uint32_t> *word, uint32_t expected)
+{
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#else
+    if (word->load(std::memory_order_acquire) == expected)
+        std::this_thread::yield();
+#endif
+}
+
+// Wakes all threads sleeping on word
+static void futexWakeAll(std::atomic<uint32_t> *word)
+{
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+    (void)word;
+#endif
+}
+
+DSPDispatcher::DSPDispatcher()
+    : epoch(0), claim(0), doneJobs(0), sleepers(0),
+      jobFunc(nullptr), jobContext(nullptr), jobCount(0),
+      spinCount(4000), shuttingDown(false)
+{
+}
+
+DSPDispatcher::~DSPDispatcher()
+{
+    shutdown();
+}
+
+void DSPDispatcher::initialize(size_t numWorkers)
+{
+    shutdown();
+
+    shuttingDown.store(false, std::memory_order_relaxed);
+    jobCount.store(0, std::memory_order_relaxed);
+    claim.store(0, std::memory_order_relaxed);
+    doneJobs.store(0, std::memory_order_relaxed);
+
+    // Workers start from the current epoch, a thread that is scheduled late
+    // must still see a shutdown that happened in the meantime
+    uint32_t startEpoch = epoch.load(std::memory_order_acquire);
+
+    for (size_t i = 0; i < numWorkers; ++i)
+    {
+        workers.emplace_back(&DSPDispatcher::workerThread, this, startEpoch);
+    }
+}
+
+void DSPDispatcher::shutdown()
+{
+    if (workers.empty())
+        return;
+
+    shuttingDown.store(true, std::memory_order_seq_cst);
+    epoch.fetch_add(1, std::memory_order_seq_cst);
+    futexWakeAll(&epoch);
+
+    for (auto &thread : workers)
+    {
+        if (thread.joinable())
+            thread.join();
+    }
+
+    workers.clear();
+}
+
+void DSPDispatcher::run(JobFunc func, void *context, size_t numJobs)
+{
+    if (numJobs == 0)
+        return;
+
+    if (workers.empty() || numJobs == 1)
+    {
+        for (size_t i = 0; i < numJobs; ++i)
+        {
+            func(context, i);
+        }
+
+        return;
+    }
+
+    uint32_t next = epoch.load(std::memory_order_relaxed) + 1;
+
+    // Exhaust the claim word before the job set changes. A late worker still
+    // holding the claim of the previous run could otherwise pass the index
+    // check against a larger new count and win its compare-and-swap, the
+    // fence orders the exhausted claim before the new count for it.
+    claim.store((static_cast<uint64_t>(next) << 32) | UINT32_MAX, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // Publish the job set, the claim word is written last so a worker that
+    // sees the new epoch also sees the matching function and context
+    jobFunc.store(func, std::memory_order_relaxed);
+    jobContext.store(context, std::memory_order_relaxed);
+    jobCount.store(numJobs, std::memory_order_relaxed);
+    doneJobs.store(0, std::memory_order_relaxed);
+    claim.store(static_cast<uint64_t>(next) << 32, std::memory_order_release);
+
+    epoch.store(next, std::memory_order_seq_cst);
+
+    // Only enter the kernel if a worker is actually asleep
+    if (sleepers.load(std::memory_order_seq_cst) > 0)
+    {
+        futexWakeAll(&epoch);
+    }
+
+    // The calling thread renders its share
+    runJobs();
+
+    // Barrier: wait until the jobs claimed by workers have finished, yield
+    // after a while in case a worker got preempted on an oversubscribed CPU
+    uint32_t spins = 0;
+    uint32_t maxSpins = spinCount.load(std::memory_order_relaxed);
+
+    while (doneJobs.load(std::memory_order_acquire) < numJobs)
+    {
+        if (spins < maxSpins)
+        {
+            ++spins;
+            cpu_relax();
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void DSPDispatcher::runJobs()
+{
+    uint64_t current = claim.load(std::memory_order_acquire);
+
+    while (true)
+    {
+        size_t index = static_cast<uint32_t>(current);
+        size_t count = jobCount.load(std::memory_order_relaxed);
+        JobFunc func = jobFunc.load(std::memory_order_relaxed);
+        void *context = jobContext.load(std::memory_order_relaxed);
+
+        if (index >= count)
+            return;
+
+        // Pairs with the fence in run(): a count of a newer run implies its exhausted claim
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        // Fails if another thread claimed the index or a new run was published
+        if (!claim.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+            continue;
+
+        func(context, index);
+
+        doneJobs.fetch_add(1, std::memory_order_release);
+
+        current = claim.load(std::memory_order_acquire);
+    }
+}
+
+void DSPDispatcher::workerThread(uint32_t startEpoch)
+{
+#ifdef __linux__
+    pthread_setname_np(pthread_self(), "DSPDispatcher");
+#endif
+
+    // Jobs of a graph apply the setting of their engine, see DSPEngine::bindThread()
+    DSPDenormalGuard denormals;
+
+    uint32_t seen = startEpoch;
+
+    while (true)
+    {
+        uint32_t current;
+        uint32_t spins = 0;
+        uint32_t maxSpins = spinCount.load(std::memory_order_relaxed);
+
+        // Spin first, then sleep until run() bumps the epoch
+        while ((current = epoch.load(std::memory_order_acquire)) == seen)
+        {
+            if (spins < maxSpins)
+            {
+                ++spins;
+                cpu_relax();
+                continue;
+            }
+
+            sleepers.fetch_add(1, std::memory_order_seq_cst);
+            futexWait(&epoch, seen);
+            sleepers.fetch_sub(1, std::memory_order_seq_cst);
+        }
+
+        seen = current;
+
+        if (shuttingDown.load(std::memory_order_acquire))
+            return;
+
+        runJobs();
+    }
+}
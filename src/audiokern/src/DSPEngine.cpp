@@ -0,0 +1,50 @@
+#include "DSPEngine.h"
+#include "dsp_runtime.h"
+
+DSP_THREAD_LOCAL DSPEngine *DSPEngine::currentEngine = nullptr;
+
+DSPEngine::DSPEngine()
+    : sampleRate(-1.0), blockSize(64), initialized(false), elapsedSamples(0), processedBlocks(0), flushDenormals(true)
+{
+}
+
+DSPEngine::~DSPEngine()
+{
+    // Bus objects live in the arena
+    audioBusses.clear();
+    modulationBusses.clear();
+    unmanagedAudioBusses.clear();
+    unmanagedModulationBusses.clear();
+}
+
+DSPEngine &DSPEngine::getDefault()
+{
+    // Never destroyed, objects of static lifetime may still refer to it at exit
+    static DSPEngine *engine = new DSPEngine();
+    return *engine;
+}
+
+void DSPEngine::bindThread(DSPEngine &engine, dsp_float rate, size_t size)
+{
+    currentEngine = &engine;
+    DSP::sampleRate = rate;
+    DSP::blockSize = size;
+
+    cpu_flush_denormals(engine.flushDenormals);
+}
+
+DSPEngine::Scope::Scope(DSPEngine &engine)
+    : previous(currentEngine), previousSampleRate(DSP::sampleRate), previousBlockSize(DSP::blockSize),
+      previousFloatMode(cpu_get_float_mode())
+{
+    bindThread(engine, engine.sampleRate, engine.blockSize);
+}
+
+DSPEngine::Scope::~Scope()
+{
+    currentEngine = previous;
+    DSP::sampleRate = previousSampleRate;
+    DSP::blockSize = previousBlockSize;
+
+    cpu_set_float_mode(previousFloatMode);
+}
@@ -0,0 +1,554 @@
+#include "DSPGraph.h"
+#include "Busses.h"
+#include "DSP.h"
+#include "DSPArena.h"
+#include "DSPEngine.h"
+#include "dsp_runtime.h"
+#include <algorithm>
+#include <unordered_map>
+
+DSPGraph::DSPGraph()
+    : numExecutors(1), criticalPath(0), finalized(false), busAliasing(BusAliasing::Parallel),
+      runEngine(nullptr), runSampleRate(0.0), runBlockSize(0), busWorkingSet(0), busFootprint(0), completed(0)
+{
+}
+
+void DSPGraph::clear()
+{
+    nodes.clear();
+    roots.clear();
+    pending.reset();
+    queues.reset();
+    pinnedBuses.clear();
+    criticalPath = 0;
+    busWorkingSet = 0;
+    busFootprint = 0;
+    finalized = false;
+}
+
+void DSPGraph::add(DSPObject &obj)
+{
+    obj.addToGraph(*this);
+}
+
+size_t DSPGraph::addNode(DSPObject &obj)
+{
+    size_t node = addTask(obj.getName(), &DSPGraph::processObject, &obj);
+
+    for (const auto &binding : obj.getBusBindings())
+    {
+        nodes[node].accesses.push_back({binding.key, binding.access, binding.channels});
+    }
+
+    return node;
+}
+
+size_t DSPGraph::addTask(const std::string &name, TaskFunc func, void *context)
+{
+    Node node;
+    node.name = name;
+    node.func = func;
+    node.context = context;
+    node.numPredecessors = 0;
+    node.level = 0;
+    node.enabled = true;
+
+    nodes.push_back(node);
+    finalized = false;
+
+    return nodes.size() - 1;
+}
+
+void DSPGraph::addAccess(size_t node, const DSPBus &bus, DSPBusAccess access)
+{
+    nodes[node].accesses.push_back({bus.getKey(), access, bus.getChannels()});
+    finalized = false;
+}
+
+void DSPGraph::pinBus(const DSPBus &bus)
+{
+    pinnedBuses.push_back(bus.getKey());
+    finalized = false;
+}
+
+// Two accesses conflict if they touch the same bus and at least one of them writes
+static bool conflicts(const void *keyA, DSPBusAccess a, const void *keyB, DSPBusAccess b)
+{
+    return keyA == keyB && (a != DSPBusAccess::Read || b != DSPBusAccess::Read);
+}
+
+void DSPGraph::finalize()
+{
+    size_t numNodes = nodes.size();
+
+    for (auto &node : nodes)
+    {
+        node.successors.clear();
+        node.numPredecessors = 0;
+        node.level = 0;
+    }
+
+    // Insertion order is the reference order: an edge i -> j for every
+    // earlier node i that conflicts with j on any bus
+    for (size_t j = 0; j < numNodes; ++j)
+    {
+        for (size_t i = 0; i < j; ++i)
+        {
+            bool dependent = false;
+
+            for (const auto &a : nodes[i].accesses)
+            {
+                for (const auto &b : nodes[j].accesses)
+                {
+                    if (conflicts(a.key, a.access, b.key, b.access))
+                    {
+                        dependent = true;
+                        break;
+                    }
+                }
+
+                if (dependent)
+                    break;
+            }
+
+            if (dependent)
+            {
+                nodes[i].successors.push_back(static_cast<uint32_t>(j));
+                ++nodes[j].numPredecessors;
+            }
+        }
+    }
+
+    aliasBuses();
+
+    // Topological sort (Kahn), yields the levels and catches cycles
+    std::vector<uint32_t> indegree(numNodes);
+    std::vector<uint32_t> order;
+    order.reserve(numNodes);
+    roots.clear();
+
+    for (size_t i = 0; i < numNodes; ++i)
+    {
+        indegree[i] = nodes[i].numPredecessors;
+
+        if (indegree[i] == 0)
+        {
+            roots.push_back(static_cast<uint32_t>(i));
+            order.push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    criticalPath = numNodes > 0 ? 1 : 0;
+
+    for (size_t k = 0; k < order.size(); ++k)
+    {
+        Node &node = nodes[order[k]];
+
+        for (uint32_t s : node.successors)
+        {
+            nodes[s].level = std::max(nodes[s].level, node.level + 1);
+            criticalPath = std::max(criticalPath, nodes[s].level + 1);
+
+            if (--indegree[s] == 0)
+            {
+                order.push_back(s);
+            }
+        }
+    }
+
+    if (order.size() != numNodes)
+    {
+        PANIC("DSPGraph::finalize: dependency cycle detected");
+    }
+
+    pending.reset(new std::atomic<uint32_t>[numNodes]);
+    queues.reset(new WorkQueue[maxExecutors]);
+
+    for (size_t i = 0; i < maxExecutors; ++i)
+    {
+        queues[i].top.store(0, std::memory_order_relaxed);
+        queues[i].bottom.store(0, std::memory_order_relaxed);
+        queues[i].items.reset(new std::atomic<uint32_t>[numNodes]);
+    }
+
+    finalized = true;
+}
+
+// Node sets as bit masks, the graphs are small
+using NodeSet = std::vector<uint64_t>;
+
+static void insertNode(NodeSet &set, size_t node)
+{
+    set[node / 64] |= uint64_t(1) << (node % 64);
+}
+
+static bool containsNode(const NodeSet &set, size_t node)
+{
+    return (set[node / 64] >> (node % 64)) & 1;
+}
+
+static bool isSubset(const NodeSet &set, const NodeSet &of)
+{
+    for (size_t i = 0; i < set.size(); ++i)
+    {
+        if (set[i] & ~of[i])
+            return false;
+    }
+
+    return true;
+}
+
+static size_t busBytes(const DSPBusChannels &channels)
+{
+    return channels.count * channels.size * sizeof(host_float);
+}
+
+void DSPGraph::aliasBuses()
+{
+    size_t numNodes = nodes.size();
+    size_t words = (numNodes + 63) / 64;
+
+    // A bus lives from the node that overwrites it first to the last node that accesses it
+    struct Lifetime
+    {
+        DSPBusChannels channels; ///< Storage of the bus
+        NodeSet accessors;       ///< Nodes that access the bus
+        size_t first;            ///< First accessor in reference order
+        bool shareable;          ///< Overwritten by the first accessor, arena memory, not pinned
+    };
+
+    std::vector<Lifetime> buses;
+    std::unordered_map<const void *, size_t> busIndex;
+    DSPArena &arena = DSP::getArena();
+
+    for (size_t j = 0; j < numNodes; ++j)
+    {
+        for (const auto &a : nodes[j].accesses)
+        {
+            auto it = busIndex.find(a.key);
+
+            if (it == busIndex.end())
+            {
+                Lifetime bus;
+                bus.channels = a.channels;
+                bus.accessors.assign(words, 0);
+                bus.first = j;
+                bus.shareable = busAliasing != BusAliasing::Off && a.channels.count > 0 &&
+                                std::find(pinnedBuses.begin(), pinnedBuses.end(), a.key) == pinnedBuses.end();
+
+                for (size_t c = 0; c < a.channels.count; ++c)
+                {
+                    bus.shareable = bus.shareable && arena.owns(a.channels.data[c]);
+                }
+
+                it = busIndex.emplace(a.key, buses.size()).first;
+                buses.push_back(bus);
+            }
+
+            Lifetime &bus = buses[it->second];
+            insertNode(bus.accessors, j);
+
+            // Read by its first node, the bus carries data from the previous block
+            if (j == bus.first && a.access != DSPBusAccess::Write)
+                bus.shareable = false;
+        }
+    }
+
+    // Nodes that are guaranteed to have completed before a node starts
+    std::vector<NodeSet> ancestors(numNodes, NodeSet(words, 0));
+
+    for (size_t i = 0; i < numNodes; ++i)
+    {
+        for (uint32_t s : nodes[i].successors)
+        {
+            for (size_t w = 0; w < words; ++w)
+            {
+                ancestors[s][w] |= ancestors[i][w];
+            }
+
+            insertNode(ancestors[s], i);
+        }
+    }
+
+    std::vector<NodeSet> before = ancestors;
+
+    if (busAliasing == BusAliasing::Serial)
+    {
+        for (size_t j = 0; j < numNodes; ++j)
+        {
+            for (size_t i = 0; i < j; ++i)
+            {
+                insertNode(before[j], i);
+            }
+        }
+    }
+
+    // First fit in order of the first access: a bus joins storage whose users have all completed
+    struct Storage
+    {
+        DSPBusChannels channels;
+        NodeSet accessors;
+    };
+
+    std::vector<Storage> storages;
+    std::unordered_map<const host_float *, const host_float *> targets;
+    std::unordered_map<const void *, DSPBusChannels> aliased;
+
+    busFootprint = 0;
+    busWorkingSet = 0;
+
+    for (const Lifetime &bus : buses)
+    {
+        size_t bytes = busBytes(bus.channels);
+        busFootprint += bytes;
+
+        Storage *shared = nullptr;
+
+        for (size_t k = 0; bus.shareable && k < storages.size() && !shared; ++k)
+        {
+            Storage &storage = storages[k];
+
+            if (storage.channels.count == bus.channels.count && storage.channels.size == bus.channels.size &&
+                isSubset(storage.accessors, before[bus.first]))
+            {
+                shared = &storage;
+            }
+        }
+
+        if (!shared)
+        {
+            busWorkingSet += bytes;
+
+            if (bus.shareable)
+                storages.push_back({bus.channels, bus.accessors});
+
+            continue;
+        }
+
+        // The reference order becomes a dependency where the schedule does not imply it yet
+        for (size_t u = 0; u < numNodes; ++u)
+        {
+            if (containsNode(shared->accessors, u) && !containsNode(ancestors[bus.first], u))
+            {
+                nodes[u].successors.push_back(static_cast<uint32_t>(bus.first));
+                ++nodes[bus.first].numPredecessors;
+                insertNode(ancestors[bus.first], u);
+            }
+        }
+
+        for (size_t c = 0; c < bus.channels.count; ++c)
+        {
+            targets[bus.channels.data[c]] = shared->channels.data[c];
+        }
+
+        aliased[bus.channels.data[0]] = shared->channels;
+
+        for (size_t w = 0; w < words; ++w)
+        {
+            shared->accessors[w] |= bus.accessors[w];
+        }
+    }
+
+    // Every copy of the buses follows, the accesses take the key of the storage
+    DSPSampleBuffer::redirect(targets);
+
+    for (auto &node : nodes)
+    {
+        for (auto &a : node.accesses)
+        {
+            auto it = aliased.find(a.key);
+
+            if (it != aliased.end())
+            {
+                a.key = it->second.data[0];
+                a.channels = it->second;
+            }
+        }
+    }
+
+    if (busFootprint > 0)
+    {
+        DSP::log("DSP graph: %zu buses in %zu bytes, %zu bytes without sharing storage",
+                 buses.size(), busWorkingSet, busFootprint);
+    }
+}
+
+void DSPGraph::process(DSPDispatcher &dispatcher)
+{
+    size_t numNodes = nodes.size();
+
+    numExecutors = std::min(dispatcher.getNumWorkers() + 1, maxExecutors);
+
+    // Nothing to gain from the scheduler, run the reference order
+    if (!finalized || numExecutors == 1 || criticalPath == numNodes)
+    {
+        for (const auto &node : nodes)
+        {
+            if (node.enabled)
+                node.func(node.context);
+        }
+
+        return;
+    }
+
+    for (size_t i = 0; i < numNodes; ++i)
+    {
+        pending[i].store(nodes[i].numPredecessors, std::memory_order_relaxed);
+    }
+
+    for (size_t i = 0; i < numExecutors; ++i)
+    {
+        queues[i].top.store(0, std::memory_order_relaxed);
+        queues[i].bottom.store(0, std::memory_order_relaxed);
+    }
+
+    // Deal the roots round-robin, the dispatcher publishes them to the workers
+    for (size_t i = 0; i < roots.size(); ++i)
+    {
+        push(queues[i % numExecutors], roots[i]);
+    }
+
+    completed.store(0, std::memory_order_relaxed);
+
+    // The worker threads render for the engine of the calling thread
+    runEngine = &DSPEngine::current();
+    runSampleRate = DSP::sampleRate;
+    runBlockSize = DSP::blockSize;
+
+    dispatcher.run(&DSPGraph::executorJob, this, numExecutors);
+}
+
+void DSPGraph::executorJob(void *context, size_t index)
+{
+    DSPGraph *graph = static_cast<DSPGraph *>(context);
+
+    DSPEngine::bindThread(*graph->runEngine, graph->runSampleRate, graph->runBlockSize);
+    graph->runExecutor(index);
+}
+
+void DSPGraph::processObject(void *context)
+{
+    static_cast<DSPObject *>(context)->process();
+}
+
+void DSPGraph::runExecutor(size_t self)
+{
+    size_t numNodes = nodes.size();
+    uint32_t spins = 0;
+
+    while (completed.load(std::memory_order_acquire) < numNodes)
+    {
+        uint32_t node;
+
+        bool found = pop(queues[self], node);
+
+        for (size_t i = 1; !found && i < numExecutors; ++i)
+        {
+            found = steal(queues[(self + i) % numExecutors], node);
+        }
+
+        if (found)
+        {
+            runNode(self, node);
+            spins = 0;
+            continue;
+        }
+
+        // Another executor is still running a node whose successors are not ready yet
+        if (++spins < 64)
+        {
+            cpu_relax();
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void DSPGraph::runNode(size_t self, uint32_t index)
+{
+    const Node &node = nodes[index];
+
+    if (node.enabled)
+        node.func(node.context);
+
+    // The last predecessor to finish makes a node ready
+    for (uint32_t s : node.successors)
+    {
+        if (pending[s].fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            push(queues[self], s);
+        }
+    }
+
+    completed.fetch_add(1, std::memory_order_release);
+}
+
+void DSPGraph::push(WorkQueue &queue, uint32_t node)
+{
+    int64_t b = queue.bottom.load(std::memory_order_relaxed);
+    queue.items[b].store(node, std::memory_order_relaxed);
+    queue.bottom.store(b + 1, std::memory_order_release);
+}
+
+bool DSPGraph::pop(WorkQueue &queue, uint32_t &node)
+{
+    int64_t b = queue.bottom.load(std::memory_order_relaxed) - 1;
+    queue.bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = queue.top.load(std::memory_order_relaxed);
+
+    if (t > b)
+    {
+        // Empty
+        queue.bottom.store(b + 1, std::memory_order_relaxed);
+        return false;
+    }
+
+    node = queue.items[b].load(std::memory_order_relaxed);
+
+    if (t == b)
+    {
+        // Last item, race against the thieves for it
+        bool won = queue.top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+        queue.bottom.store(b + 1, std::memory_order_relaxed);
+        return won;
+    }
+
+    return true;
+}
+
+bool DSPGraph::steal(WorkQueue &queue, uint32_t &node)
+{
+    int64_t t = queue.top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = queue.bottom.load(std::memory_order_acquire);
+
+    if (t >= b)
+        return false;
+
+    node = queue.items[t].load(std::memory_order_relaxed);
+
+    return queue.top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+}
+
+void DSPGraph::log() const
+{
+    DSP::log("DSP graph: %zu nodes, %zu levels, %zu roots, bus working set %zu of %zu bytes%s",
+             nodes.size(), criticalPath, roots.size(), busWorkingSet, busFootprint,
+             finalized ? "" : " (not finalized)");
+
+    for (size_t i = 0; i < nodes.size(); ++i)
+    {
+        const Node &node = nodes[i];
+        std::string successors;
+
+        for (uint32_t s : node.successors)
+        {
+            successors += " " + std::to_string(s);
+        }
+
+        DSP::log("  %3zu L%-2zu %-40s ->%s", i, node.level, node.name.c_str(), successors.c_str());
+    }
+}
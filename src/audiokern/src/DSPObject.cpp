@@ -1,10 +1,15 @@
 #include "DSPObject.h"
 #include "DSP.h"
 #include "DSPBusManager.h"
+#include "DSPEngine.h"
+#include "DSPProfiler.h"
+#include "DSPGraph.h"
 
 DSPObject::DSPObject()
 {
     processBlockFunc = defaultBlockProcess;
+    registryIndex = DSPProfiler::unregisteredSlot;
+    engine = &DSPEngine::getDefault();
 }
 
 DSPObject::~DSPObject()
@@ -14,6 +19,7 @@ DSPObject::~DSPObject()
 void DSPObject::initialize(const std::string &name)
 {
     objectName = "_" + name;
+    engine = &DSPEngine::current();
     initializeObject();
 
     DSP::registerObject(*this);
@@ -22,6 +28,7 @@ void DSPObject::initialize(const std::string &name)
 void DSPObject::initialize(const std::string &name, size_t count)
 {
     objectName = "_" + name;
+    engine = &DSPEngine::current();
     initializeObject(count);
 }
 
@@ -40,9 +47,38 @@ void DSPObject::initializeObject(size_t /*count*/)
 // Generates the next audio sample block
 void DSPObject::process()
 {
+    if (DSPProfiler::isEnabled())
+    {
+        uint64_t start = DSPProfiler::begin();
+        (*processBlockFunc)(this);
+        DSPProfiler::end(registryIndex, start);
+        return;
+    }
+
     (*processBlockFunc)(this);
 }
 
+void DSPObject::addToGraph(DSPGraph &graph)
+{
+    graph.addNode(*this);
+}
+
+void DSPObject::declareBusAccess(const std::string &role, const DSPBus &bus, DSPBusAccess access)
+{
+    for (auto &binding : busBindings)
+    {
+        if (binding.role == role)
+        {
+            binding.key = bus.getKey();
+            binding.access = access;
+            binding.channels = bus.getChannels();
+            return;
+        }
+    }
+
+    busBindings.push_back({role, bus.getKey(), access, bus.getChannels()});
+}
+
 void DSPObject::registerBlockProcessor(BlockProcessor f)
 {
     processBlockFunc = f;
@@ -0,0 +1,385 @@
+#include "DSPProfiler.h"
+#include "DSP.h"
+#include "DSPEngine.h"
+#include "DSPObject.h"
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
+
+// Counters of one thread for one engine, only the owning thread writes them
+struct DSPProfiler::ThreadCounters
+{
+    std::atomic<uint64_t> calls[maxSlots + 1];
+    std::atomic<uint64_t> totalTicks[maxSlots + 1];
+    std::atomic<uint64_t> selfTicks[maxSlots + 1];
+    std::atomic<uint64_t> maxTicks[maxSlots + 1];
+
+    std::atomic<uint32_t> engine; // Id of the engine counted, 0 once the engine is gone
+    std::atomic<uint32_t> generation;
+
+    uint64_t childTicks[maxDepth];
+    size_t depth = 0;
+};
+
+std::atomic<bool> DSPProfiler::enabled{false};
+
+// Guards the list of thread counters, never taken inside a dispatch except on a thread's first one per engine
+static std::mutex countersMutex;
+
+static int64_t steadyNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+DSPProfiler::EngineState::EngineState()
+{
+    static std::atomic<uint32_t> nextId{1};
+    id = nextId.fetch_add(1, std::memory_order_relaxed);
+
+    startTicks.store(now(), std::memory_order_relaxed);
+    startNs.store(steadyNs(), std::memory_order_relaxed);
+}
+
+DSPProfiler::EngineState::~EngineState()
+{
+    std::lock_guard<std::mutex> lock(countersMutex);
+
+    for (ThreadCounters *c : getCounterRegistry())
+    {
+        if (c->engine.load(std::memory_order_relaxed) == id)
+            c->engine.store(0, std::memory_order_release);
+    }
+}
+
+// All thread counters ever created, they live until the process exits
+std::vector<DSPProfiler::ThreadCounters *> &DSPProfiler::getCounterRegistry()
+{
+    static std::vector<ThreadCounters *> counters;
+    return counters;
+}
+
+void DSPProfiler::clearCounters(ThreadCounters &c)
+{
+    for (size_t i = 0; i <= maxSlots; ++i)
+    {
+        c.calls[i].store(0, std::memory_order_relaxed);
+        c.totalTicks[i].store(0, std::memory_order_relaxed);
+        c.selfTicks[i].store(0, std::memory_order_relaxed);
+        c.maxTicks[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+DSPProfiler::EngineState &DSPProfiler::currentState()
+{
+    return DSPEngine::current().profile;
+}
+
+void DSPProfiler::enable(bool enable)
+{
+    if (enable)
+    {
+        reset();
+    }
+
+    enabled.store(enable, std::memory_order_relaxed);
+}
+
+void DSPProfiler::reset()
+{
+    EngineState &state = currentState();
+
+    state.startTicks.store(now(), std::memory_order_relaxed);
+    state.startNs.store(steadyNs(), std::memory_order_relaxed);
+    state.blocks.store(0, std::memory_order_relaxed);
+    state.generation.fetch_add(1, std::memory_order_release);
+}
+
+long DSPProfiler::getBlocks()
+{
+    return currentState().blocks.load(std::memory_order_relaxed);
+}
+
+// Registers new counters, happens once per thread and engine on the first profiled dispatch
+DSPProfiler::ThreadCounters *DSPProfiler::createThreadCounters()
+{
+    ThreadCounters *c = new ThreadCounters();
+
+    clearCounters(*c);
+    c->engine.store(0, std::memory_order_relaxed);
+    c->generation.store(0, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(countersMutex);
+    getCounterRegistry().push_back(c);
+
+    return c;
+}
+
+DSPProfiler::ThreadCounters &DSPProfiler::threadCounters(EngineState &state)
+{
+    // Counters created by this thread, the last one used is checked first
+    static thread_local std::vector<ThreadCounters *> owned;
+    static thread_local ThreadCounters *last = nullptr;
+
+    if (last && last->engine.load(std::memory_order_acquire) == state.id)
+        return *last;
+
+    ThreadCounters *unused = nullptr;
+
+    for (ThreadCounters *c : owned)
+    {
+        uint32_t engine = c->engine.load(std::memory_order_acquire);
+
+        if (engine == state.id)
+            return *(last = c);
+
+        if (engine == 0 && !unused)
+            unused = c;
+    }
+
+    // Counters of a destroyed engine are taken over, the others stay with their engine
+    if (!unused)
+    {
+        unused = createThreadCounters();
+        owned.push_back(unused);
+    }
+    else
+    {
+        clearCounters(*unused);
+    }
+
+    unused->depth = 0;
+    unused->generation.store(state.generation.load(std::memory_order_acquire), std::memory_order_relaxed);
+    unused->engine.store(state.id, std::memory_order_release);
+
+    return *(last = unused);
+}
+
+uint64_t DSPProfiler::begin()
+{
+    ThreadCounters &c = threadCounters(currentState());
+
+    if (c.depth < maxDepth)
+    {
+        c.childTicks[c.depth] = 0;
+    }
+
+    ++c.depth;
+
+    return now();
+}
+
+void DSPProfiler::end(size_t slot, uint64_t start)
+{
+    uint64_t elapsed = now() - start;
+    EngineState &state = currentState();
+    ThreadCounters &c = threadCounters(state);
+
+    if (c.depth == 0)
+    {
+        // Profiling was enabled while this dispatch was running
+        return;
+    }
+
+    --c.depth;
+
+    // Apply a pending reset, only this thread writes its counters
+    uint32_t gen = state.generation.load(std::memory_order_acquire);
+    if (c.generation.load(std::memory_order_relaxed) != gen)
+    {
+        clearCounters(c);
+        c.generation.store(gen, std::memory_order_release);
+    }
+
+    uint64_t children = c.depth < maxDepth ? c.childTicks[c.depth] : 0;
+    uint64_t self = elapsed > children ? elapsed - children : 0;
+
+    if (c.depth > 0 && c.depth - 1 < maxDepth)
+    {
+        c.childTicks[c.depth - 1] += elapsed;
+    }
+
+    if (slot > maxSlots)
+    {
+        slot = unregisteredSlot;
+    }
+
+    c.calls[slot].store(c.calls[slot].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    c.totalTicks[slot].store(c.totalTicks[slot].load(std::memory_order_relaxed) + elapsed, std::memory_order_relaxed);
+    c.selfTicks[slot].store(c.selfTicks[slot].load(std::memory_order_relaxed) + self, std::memory_order_relaxed);
+
+    if (elapsed > c.maxTicks[slot].load(std::memory_order_relaxed))
+    {
+        c.maxTicks[slot].store(elapsed, std::memory_order_relaxed);
+    }
+}
+
+// Calibrates the cycle counter against the steady clock since the last reset
+double DSPProfiler::ticksPerNs(const EngineState &state)
+{
+#if defined(__x86_64__) || defined(__i386__) || defined(__aarch64__)
+    uint64_t ticks = now() - state.startTicks.load(std::memory_order_relaxed);
+    int64_t ns = steadyNs() - state.startNs.load(std::memory_order_relaxed);
+
+    if (ns <= 0 || ticks == 0)
+    {
+        return 1.0;
+    }
+
+    return static_cast<double>(ticks) / static_cast<double>(ns);
+#else
+    (void)state;
+    return 1.0;
+#endif
+}
+
+std::vector<DSPProfileEntry> DSPProfiler::snapshot()
+{
+    const std::vector<DSPObject *> &registry = DSP::getRegistry();
+    size_t slots = std::min(registry.size(), maxSlots);
+
+    std::vector<uint64_t> calls(maxSlots + 1, 0);
+    std::vector<uint64_t> total(maxSlots + 1, 0);
+    std::vector<uint64_t> self(maxSlots + 1, 0);
+    std::vector<uint64_t> peak(maxSlots + 1, 0);
+
+    EngineState &state = currentState();
+    uint32_t gen = state.generation.load(std::memory_order_acquire);
+
+    {
+        std::lock_guard<std::mutex> lock(countersMutex);
+
+        for (ThreadCounters *c : getCounterRegistry())
+        {
+            if (c->engine.load(std::memory_order_acquire) != state.id ||
+                c->generation.load(std::memory_order_acquire) != gen)
+            {
+                continue;
+            }
+
+            for (size_t i = 0; i <= maxSlots; ++i)
+            {
+                calls[i] += c->calls[i].load(std::memory_order_relaxed);
+                total[i] += c->totalTicks[i].load(std::memory_order_relaxed);
+                self[i] += c->selfTicks[i].load(std::memory_order_relaxed);
+                peak[i] = std::max(peak[i], c->maxTicks[i].load(std::memory_order_relaxed));
+            }
+        }
+    }
+
+    double scale = 1.0 / ticksPerNs(state);
+    long numBlocks = std::max(state.blocks.load(std::memory_order_relaxed), 1L);
+
+    std::vector<DSPProfileEntry> entries;
+
+    auto add = [&](const std::string &name, size_t i)
+    {
+        if (calls[i] == 0)
+            return;
+
+        DSPProfileEntry e;
+        e.name = name;
+        e.calls = calls[i];
+        e.totalNs = total[i] * scale;
+        e.selfNs = self[i] * scale;
+        e.maxNs = peak[i] * scale;
+        e.selfPerBlockNs = e.selfNs / numBlocks;
+        entries.push_back(e);
+    };
+
+    for (size_t i = 0; i < slots; ++i)
+    {
+        add(registry[i]->getName(), i);
+    }
+
+    add("(unregistered)", unregisteredSlot);
+
+    std::sort(entries.begin(), entries.end(),
+              [](const DSPProfileEntry &a, const DSPProfileEntry &b)
+              { return a.selfNs > b.selfNs; });
+
+    return entries;
+}
+
+std::vector<DSPProfileEntry> DSPProfiler::snapshotByType()
+{
+    std::map<std::string, DSPProfileEntry> groups;
+
+    for (const DSPProfileEntry &e : snapshot())
+    {
+        std::string type;
+
+        for (char ch : e.name)
+        {
+            if (ch < '0' || ch > '9')
+                type += ch;
+        }
+
+        auto it = groups.find(type);
+
+        if (it == groups.end())
+        {
+            DSPProfileEntry g = e;
+            g.name = type;
+            groups[type] = g;
+        }
+        else
+        {
+            DSPProfileEntry &g = it->second;
+            g.calls += e.calls;
+            g.totalNs += e.totalNs;
+            g.selfNs += e.selfNs;
+            g.maxNs = std::max(g.maxNs, e.maxNs);
+            g.selfPerBlockNs += e.selfPerBlockNs;
+        }
+    }
+
+    std::vector<DSPProfileEntry> entries;
+
+    for (auto &kv : groups)
+    {
+        entries.push_back(kv.second);
+    }
+
+    std::sort(entries.begin(), entries.end(),
+              [](const DSPProfileEntry &a, const DSPProfileEntry &b)
+              { return a.selfNs > b.selfNs; });
+
+    return entries;
+}
+
+static void logEntries(const char *title, const std::vector<DSPProfileEntry> &entries, size_t maxEntries)
+{
+    double budgetNs = 1e9 * static_cast<double>(DSP::blockSize) / DSP::sampleRate;
+
+    DSP::log("%s", title);
+    DSP::log("  %-40s %10s %12s %12s %10s %7s", "name", "calls", "self/block", "total/block", "max", "budget");
+
+    long numBlocks = std::max(DSPProfiler::getBlocks(), 1L);
+
+    for (size_t i = 0; i < entries.size() && i < maxEntries; ++i)
+    {
+        const DSPProfileEntry &e = entries[i];
+
+        DSP::log("  %-40s %10llu %10.0fns %10.0fns %8.0fns %6.2f%%",
+                 e.name.c_str(),
+                 static_cast<unsigned long long>(e.calls),
+                 e.selfPerBlockNs,
+                 e.totalNs / numBlocks,
+                 e.maxNs,
+                 100.0 * e.selfPerBlockNs / budgetNs);
+    }
+}
+
+void DSPProfiler::log(size_t maxEntries)
+{
+    DSP::log("DSP profile: %ld blocks, block budget %.0fns (%s)",
+             getBlocks(),
+             1e9 * static_cast<double>(DSP::blockSize) / DSP::sampleRate,
+             isEnabled() ? "enabled" : "disabled");
+
+    logEntries("DSP profile by type:", snapshotByType(), maxEntries);
+    logEntries("DSP profile by object:", snapshot(), maxEntries);
+}
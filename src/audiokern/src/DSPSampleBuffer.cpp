@@ -1,63 +1,107 @@
 #include "DSPSampleBuffer.h"
+#include "DSPArena.h"
+#include <mutex>
+
+DSPSampleBuffer *DSPSampleBuffer::firstBuffer = nullptr;
+
+// Buffers are created and destroyed outside the audio thread, also by worker threads
+static std::mutex trackedBuffersMutex;
 
 DSPSampleBuffer::DSPSampleBuffer()
 {
     buffer = nullptr;
-    ownsBuffer = false;
+    track();
+}
+
+DSPSampleBuffer::DSPSampleBuffer(const DSPSampleBuffer &other)
+    : buffer(other.buffer), bufferSize(other.bufferSize), bufferName(other.bufferName)
+{
+    track();
 }
 
 DSPSampleBuffer::~DSPSampleBuffer()
 {
-    if (ownsBuffer && buffer)
-        delete[] buffer;
+    untrack();
 }
 
-void DSPSampleBuffer::initialize(const std::string &name, size_t size)
+void DSPSampleBuffer::track()
+{
+    std::lock_guard<std::mutex> lock(trackedBuffersMutex);
+
+    previousBuffer = nullptr;
+    nextBuffer = firstBuffer;
+
+    if (firstBuffer)
+        firstBuffer->previousBuffer = this;
+
+    firstBuffer = this;
+}
+
+void DSPSampleBuffer::untrack()
+{
+    std::lock_guard<std::mutex> lock(trackedBuffersMutex);
+
+    if (previousBuffer)
+        previousBuffer->nextBuffer = nextBuffer;
+    else
+        firstBuffer = nextBuffer;
+
+    if (nextBuffer)
+        nextBuffer->previousBuffer = previousBuffer;
+}
+
+void DSPSampleBuffer::redirect(const std::unordered_map<const host_float *, const host_float *> &targets)
 {
-    if (ownsBuffer && buffer)
-        delete[] buffer;
+    if (targets.empty())
+        return;
 
-    buffer = new host_float[size];
+    std::lock_guard<std::mutex> lock(trackedBuffersMutex);
+
+    for (DSPSampleBuffer *b = firstBuffer; b; b = b->nextBuffer)
+    {
+        auto it = targets.find(b->buffer);
+
+        // The memory is writable through every copy, the map only holds buffer starts
+        if (it != targets.end())
+            b->buffer = const_cast<host_float *>(it->second);
+    }
+}
+
+void DSPSampleBuffer::initialize(const std::string &name, size_t size)
+{
+    // Zeroed by the arena
+    buffer = DSP::getArena().allocateSamples(size);
     bufferSize = size;
-    ownsBuffer = true;
     bufferName = name;
-
-    fill(0.0);
 }
 
 DSPSampleBuffer &DSPSampleBuffer::operator=(host_float *externalBuffer)
 {
-    if (ownsBuffer && buffer)
-        delete[] buffer;
-
     buffer = externalBuffer;
-    ownsBuffer = false;
     bufferName = "_external";
     return *this;
 }
 
 DSPSampleBuffer &DSPSampleBuffer::operator=(const DSPSampleBuffer &other)
 {
-    if (ownsBuffer && buffer)
-        delete[] buffer;
-
     buffer = other.buffer;
     bufferSize = other.bufferSize;
-    ownsBuffer = false;
     bufferName = other.bufferName;
     return *this;
 }
 
 void DSPSampleBuffer::assign(const std::string &name, host_float *externalBuffer)
 {
-    if (ownsBuffer && buffer)
-        delete[] buffer;
-
     buffer = externalBuffer;
-    ownsBuffer = false;
     bufferName = name;
 }
 
+void DSPSampleBuffer::assign(const std::string &name, host_float *externalBuffer, size_t size)
+{
+    assign(name, externalBuffer);
+    bufferSize = size;
+}
+
 host_float &DSPSampleBuffer::operator[](size_t index)
 {
     return buffer[index];
@@ -114,8 +158,8 @@ host_float DSPSampleBuffer::peak() const
 
 void DSPSampleBuffer::free()
 {
-    if (ownsBuffer && buffer)
-        delete[] buffer;
+    buffer = nullptr;
+    bufferSize = 0;
 }
 
 void DSPSampleBuffer::multiplyWith(DSPSampleBuffer &sourceBuffer)
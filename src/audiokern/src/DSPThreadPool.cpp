@@ -1,5 +1,6 @@
 #include "DSPThreadPool.h"
 #include "clamp.h"
+#include "dsp_runtime.h"
 
 DSPThreadPool::DSPThreadPool() : activeTasks(0)
 {
@@ -85,6 +86,8 @@ void DSPThreadPool::wait()
 
 void DSPThreadPool::workerThread()
 {
+    DSPDenormalGuard denormals;
+
     while (true)
     {
         std::function<void()> task;
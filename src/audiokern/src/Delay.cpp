@@ -41,11 +41,14 @@ void Delay::setTime(host_float timeMSL, host_float timeMSR)
     currentTimeL = tL;
     currentTimeR = tR;
 
-    paramFader.change(
-        [=]()
-        {
-            delayBuffer.setTime(tL, tR);
-        });
+    paramFader.change({applyTime, this, nullptr, {tL, tR}, 0});
+}
+
+void Delay::applyTime(const ParamFader::ParamChange &change)
+{
+    Delay *self = static_cast<Delay *>(change.target);
+
+    self->delayBuffer.setTime(change.value[0], change.value[1]);
 }
 
 void Delay::setTimeRatio(dsp_math::TimeRatio ratio)
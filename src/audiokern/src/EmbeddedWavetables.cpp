@@ -0,0 +1,17 @@
+#include "EmbeddedWavetables.h"
+#include <cstring>
+
+// The directory itself is generated by tools/wtgen at build time
+
+const EmbeddedWavetable *EmbeddedWavetables::find(const std::string &name, uint32_t sampleRate)
+{
+    for (size_t i = 0; i < numEntries; ++i)
+    {
+        if (entries[i].sampleRate == sampleRate && std::strcmp(entries[i].name, name.c_str()) == 0)
+        {
+            return &entries[i];
+        }
+    }
+
+    return nullptr;
+}
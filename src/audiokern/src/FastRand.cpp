@@ -4,7 +4,7 @@
 
 FastRand::FastRand()
 {
-    seed();
+    current = seed();
 }
 
 unsigned int FastRand::next()
@@ -24,8 +24,8 @@ static dsp_float fibonacciAmplitude(int harmonic)
         return 0.0;
 }
 
-void FibonacciWavetable::createWavetable(DSPBuffer &buffer, dsp_float frequency)
+void FibonacciWavetable::createWavetable(DSPBuffer &buffer, dsp_float frequency, dsp_float sampleRate)
 {
     // Fill one full waveform cycle (0 to 2π) across the buffer
-    WaveformGenerator::generateWavetable(buffer, frequency, fibonacciAmplitude, 0.5);
+    WaveformGenerator::generateWavetable(buffer, frequency, sampleRate, fibonacciAmplitude, 0.5);
 }
@@ -0,0 +1,366 @@
+#include "FilterLaneKernel.h"
+#include "dsp_math.h"
+#include "clamp.h"
+
+#if defined(HOST_SINGLE_PRECISION) && (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define LANES_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(HOST_SINGLE_PRECISION) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define LANES_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Portable reference, one lane at a time so the integrators stay in registers
+static void processScalar(FilterLaneState &s, const FilterLaneBlock &b)
+{
+    constexpr size_t lanes = 4;
+
+    for (size_t v = 0; v < lanes; ++v)
+    {
+        if (!s.active[v])
+            continue;
+
+        host_float y1L = s.y1L[v];
+        host_float y2L = s.y2L[v];
+        host_float y1R = s.y1R[v];
+        host_float y2R = s.y2R[v];
+        host_float resonance = s.resonance[v];
+        host_float drive = s.drive[v];
+
+        for (size_t i = 0; i < b.numSamples; ++i)
+        {
+            size_t k = i * lanes + v;
+            host_float left = b.l[k];
+            host_float right = b.r[k];
+            host_float cutoff = b.cutoff[k];
+
+            if (cutoff > 15000.0)
+                continue;
+
+            host_float reso_scale = (cutoff <= 2500.0) ? 1.0 : clamp(1.0 - (cutoff - 2500.0) / 7500.0, 0.0, 1.0);
+            host_float wc = 2.0 * dsp_math::DSP_PI * cutoff;
+            host_float alpha = clamp(wc * b.T / (1.0 + wc * b.T), 0.0, 1.0);
+
+            host_float fbL = clamp(resonance * reso_scale * (y2L - left), -15.0, 15.0);
+            host_float fbR = clamp(resonance * reso_scale * (y2R - right), -15.0, 15.0);
+
+            y1L += alpha * (left - fbL - y1L);
+            y1R += alpha * (right - fbR - y1R);
+            y2L += alpha * (y1L - y2L);
+            y2R += alpha * (y1R - y2R);
+
+            left = y2L * drive;
+            right = y2R * drive;
+
+            b.l[k] = (left >= 0.0) ? dsp_math::fast_tanh(left) : 1.5 * dsp_math::fast_tanh(0.5 * left);
+            b.r[k] = (right >= 0.0) ? dsp_math::fast_tanh(right) : 1.5 * dsp_math::fast_tanh(0.5 * right);
+        }
+
+        s.y1L[v] = y1L;
+        s.y2L[v] = y2L;
+        s.y1R[v] = y1R;
+        s.y2R[v] = y2R;
+    }
+}
+
+#ifdef LANES_X86
+
+// fast_tanh: the rational term reaches +-1 at +-3, so clamping the input replaces the branches
+__attribute__((target("avx2"))) static inline __m256 tanhAVX2(__m256 x)
+{
+    x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-3.0f)), _mm256_set1_ps(3.0f));
+    __m256 x2 = _mm256_mul_ps(x, x);
+    __m256 num = _mm256_mul_ps(x, _mm256_add_ps(_mm256_set1_ps(27.0f), x2));
+    __m256 den = _mm256_add_ps(_mm256_set1_ps(27.0f), _mm256_mul_ps(_mm256_set1_ps(9.0f), x2));
+    return _mm256_div_ps(num, den);
+}
+
+// Asymmetric soft clip, negative half with half the slope and 1.5 times the ceiling
+__attribute__((target("avx2"))) static inline __m256 clipAVX2(__m256 x)
+{
+    __m256 positive = _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_GE_OQ);
+    __m256 t = tanhAVX2(_mm256_blendv_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), x), x, positive));
+    return _mm256_blendv_ps(_mm256_mul_ps(_mm256_set1_ps(1.5f), t), t, positive);
+}
+
+// 8 voices per instruction
+__attribute__((target("avx2"))) static void processAVX2(FilterLaneState &s, const FilterLaneBlock &b)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 bypass = _mm256_set1_ps(15000.0f);
+    const __m256 knee = _mm256_set1_ps(2500.0f);
+    const __m256 kneeScale = _mm256_set1_ps(1.0f / 7500.0f);
+    const __m256 fbMax = _mm256_set1_ps(15.0f);
+    const __m256 fbMin = _mm256_set1_ps(-15.0f);
+    const __m256 omegaT = _mm256_set1_ps(static_cast<float>(2.0 * dsp_math::DSP_PI * b.T));
+
+    __m256 y1L = _mm256_load_ps(s.y1L);
+    __m256 y2L = _mm256_load_ps(s.y2L);
+    __m256 y1R = _mm256_load_ps(s.y1R);
+    __m256 y2R = _mm256_load_ps(s.y2R);
+    __m256 resonance = _mm256_load_ps(s.resonance);
+    __m256 drive = _mm256_load_ps(s.drive);
+    __m256 active = _mm256_castsi256_ps(_mm256_load_si256(reinterpret_cast<const __m256i *>(s.active)));
+
+    for (size_t i = 0; i < b.numSamples; ++i)
+    {
+        __m256 left = _mm256_load_ps(b.l + i * 8);
+        __m256 right = _mm256_load_ps(b.r + i * 8);
+        __m256 cutoff = _mm256_load_ps(b.cutoff + i * 8);
+
+        // Lanes without a voice or above the cutoff limit keep their input and state
+        __m256 run = _mm256_and_ps(active, _mm256_cmp_ps(cutoff, bypass, _CMP_LE_OQ));
+
+        __m256 resoScale = _mm256_sub_ps(one, _mm256_mul_ps(_mm256_sub_ps(cutoff, knee), kneeScale));
+        resoScale = _mm256_min_ps(_mm256_max_ps(resoScale, zero), one);
+        __m256 feedback = _mm256_mul_ps(resonance, resoScale);
+
+        __m256 wcT = _mm256_mul_ps(cutoff, omegaT);
+        __m256 alpha = _mm256_div_ps(wcT, _mm256_add_ps(one, wcT));
+        alpha = _mm256_min_ps(_mm256_max_ps(alpha, zero), one);
+
+        __m256 fbL = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(feedback, _mm256_sub_ps(y2L, left)), fbMin), fbMax);
+        __m256 fbR = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(feedback, _mm256_sub_ps(y2R, right)), fbMin), fbMax);
+
+        __m256 n1L = _mm256_add_ps(y1L, _mm256_mul_ps(alpha, _mm256_sub_ps(_mm256_sub_ps(left, fbL), y1L)));
+        __m256 n1R = _mm256_add_ps(y1R, _mm256_mul_ps(alpha, _mm256_sub_ps(_mm256_sub_ps(right, fbR), y1R)));
+        __m256 n2L = _mm256_add_ps(y2L, _mm256_mul_ps(alpha, _mm256_sub_ps(n1L, y2L)));
+        __m256 n2R = _mm256_add_ps(y2R, _mm256_mul_ps(alpha, _mm256_sub_ps(n1R, y2R)));
+
+        y1L = _mm256_blendv_ps(y1L, n1L, run);
+        y1R = _mm256_blendv_ps(y1R, n1R, run);
+        y2L = _mm256_blendv_ps(y2L, n2L, run);
+        y2R = _mm256_blendv_ps(y2R, n2R, run);
+
+        _mm256_store_ps(b.l + i * 8, _mm256_blendv_ps(left, clipAVX2(_mm256_mul_ps(n2L, drive)), run));
+        _mm256_store_ps(b.r + i * 8, _mm256_blendv_ps(right, clipAVX2(_mm256_mul_ps(n2R, drive)), run));
+    }
+
+    _mm256_store_ps(s.y1L, y1L);
+    _mm256_store_ps(s.y2L, y2L);
+    _mm256_store_ps(s.y1R, y1R);
+    _mm256_store_ps(s.y2R, y2R);
+}
+
+#ifdef __SSE2__
+
+// SSE2 has no blend, the mask selects a where set and b elsewhere
+static inline __m128 selectSSE2(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+static inline __m128 tanhSSE2(__m128 x)
+{
+    x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-3.0f)), _mm_set1_ps(3.0f));
+    __m128 x2 = _mm_mul_ps(x, x);
+    __m128 num = _mm_mul_ps(x, _mm_add_ps(_mm_set1_ps(27.0f), x2));
+    __m128 den = _mm_add_ps(_mm_set1_ps(27.0f), _mm_mul_ps(_mm_set1_ps(9.0f), x2));
+    return _mm_div_ps(num, den);
+}
+
+static inline __m128 clipSSE2(__m128 x)
+{
+    __m128 positive = _mm_cmpge_ps(x, _mm_setzero_ps());
+    __m128 t = tanhSSE2(selectSSE2(positive, x, _mm_mul_ps(_mm_set1_ps(0.5f), x)));
+    return selectSSE2(positive, t, _mm_mul_ps(_mm_set1_ps(1.5f), t));
+}
+
+// 4 voices per instruction
+static void processSSE2(FilterLaneState &s, const FilterLaneBlock &b)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 bypass = _mm_set1_ps(15000.0f);
+    const __m128 knee = _mm_set1_ps(2500.0f);
+    const __m128 kneeScale = _mm_set1_ps(1.0f / 7500.0f);
+    const __m128 fbMax = _mm_set1_ps(15.0f);
+    const __m128 fbMin = _mm_set1_ps(-15.0f);
+    const __m128 omegaT = _mm_set1_ps(static_cast<float>(2.0 * dsp_math::DSP_PI * b.T));
+
+    __m128 y1L = _mm_load_ps(s.y1L);
+    __m128 y2L = _mm_load_ps(s.y2L);
+    __m128 y1R = _mm_load_ps(s.y1R);
+    __m128 y2R = _mm_load_ps(s.y2R);
+    __m128 resonance = _mm_load_ps(s.resonance);
+    __m128 drive = _mm_load_ps(s.drive);
+    __m128 active = _mm_castsi128_ps(_mm_load_si128(reinterpret_cast<const __m128i *>(s.active)));
+
+    for (size_t i = 0; i < b.numSamples; ++i)
+    {
+        __m128 left = _mm_load_ps(b.l + i * 4);
+        __m128 right = _mm_load_ps(b.r + i * 4);
+        __m128 cutoff = _mm_load_ps(b.cutoff + i * 4);
+
+        // Lanes without a voice or above the cutoff limit keep their input and state
+        __m128 run = _mm_and_ps(active, _mm_cmple_ps(cutoff, bypass));
+
+        __m128 resoScale = _mm_sub_ps(one, _mm_mul_ps(_mm_sub_ps(cutoff, knee), kneeScale));
+        resoScale = _mm_min_ps(_mm_max_ps(resoScale, zero), one);
+        __m128 feedback = _mm_mul_ps(resonance, resoScale);
+
+        __m128 wcT = _mm_mul_ps(cutoff, omegaT);
+        __m128 alpha = _mm_div_ps(wcT, _mm_add_ps(one, wcT));
+        alpha = _mm_min_ps(_mm_max_ps(alpha, zero), one);
+
+        __m128 fbL = _mm_min_ps(_mm_max_ps(_mm_mul_ps(feedback, _mm_sub_ps(y2L, left)), fbMin), fbMax);
+        __m128 fbR = _mm_min_ps(_mm_max_ps(_mm_mul_ps(feedback, _mm_sub_ps(y2R, right)), fbMin), fbMax);
+
+        __m128 n1L = _mm_add_ps(y1L, _mm_mul_ps(alpha, _mm_sub_ps(_mm_sub_ps(left, fbL), y1L)));
+        __m128 n1R = _mm_add_ps(y1R, _mm_mul_ps(alpha, _mm_sub_ps(_mm_sub_ps(right, fbR), y1R)));
+        __m128 n2L = _mm_add_ps(y2L, _mm_mul_ps(alpha, _mm_sub_ps(n1L, y2L)));
+        __m128 n2R = _mm_add_ps(y2R, _mm_mul_ps(alpha, _mm_sub_ps(n1R, y2R)));
+
+        y1L = selectSSE2(run, n1L, y1L);
+        y1R = selectSSE2(run, n1R, y1R);
+        y2L = selectSSE2(run, n2L, y2L);
+        y2R = selectSSE2(run, n2R, y2R);
+
+        _mm_store_ps(b.l + i * 4, selectSSE2(run, clipSSE2(_mm_mul_ps(n2L, drive)), left));
+        _mm_store_ps(b.r + i * 4, selectSSE2(run, clipSSE2(_mm_mul_ps(n2R, drive)), right));
+    }
+
+    _mm_store_ps(s.y1L, y1L);
+    _mm_store_ps(s.y2L, y2L);
+    _mm_store_ps(s.y1R, y1R);
+    _mm_store_ps(s.y2R, y2R);
+}
+
+#endif // __SSE2__
+#endif // LANES_X86
+
+#ifdef LANES_NEON
+
+static inline float32x4_t divNEON(float32x4_t a, float32x4_t b)
+{
+#if defined(__aarch64__)
+    return vdivq_f32(a, b);
+#else
+    // ARMv7 has no vector division, two Newton steps refine the reciprocal estimate
+    float32x4_t inv = vrecpeq_f32(b);
+    inv = vmulq_f32(inv, vrecpsq_f32(b, inv));
+    inv = vmulq_f32(inv, vrecpsq_f32(b, inv));
+    return vmulq_f32(a, inv);
+#endif
+}
+
+static inline float32x4_t tanhNEON(float32x4_t x)
+{
+    x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(-3.0f)), vdupq_n_f32(3.0f));
+    float32x4_t x2 = vmulq_f32(x, x);
+    float32x4_t num = vmulq_f32(x, vaddq_f32(vdupq_n_f32(27.0f), x2));
+    float32x4_t den = vaddq_f32(vdupq_n_f32(27.0f), vmulq_f32(vdupq_n_f32(9.0f), x2));
+    return divNEON(num, den);
+}
+
+static inline float32x4_t clipNEON(float32x4_t x)
+{
+    uint32x4_t positive = vcgeq_f32(x, vdupq_n_f32(0.0f));
+    float32x4_t t = tanhNEON(vbslq_f32(positive, x, vmulq_f32(vdupq_n_f32(0.5f), x)));
+    return vbslq_f32(positive, t, vmulq_f32(vdupq_n_f32(1.5f), t));
+}
+
+// 4 voices per instruction
+static void processNEON(FilterLaneState &s, const FilterLaneBlock &b)
+{
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t bypass = vdupq_n_f32(15000.0f);
+    const float32x4_t knee = vdupq_n_f32(2500.0f);
+    const float32x4_t kneeScale = vdupq_n_f32(1.0f / 7500.0f);
+    const float32x4_t fbMax = vdupq_n_f32(15.0f);
+    const float32x4_t fbMin = vdupq_n_f32(-15.0f);
+    const float32x4_t omegaT = vdupq_n_f32(static_cast<float>(2.0 * dsp_math::DSP_PI * b.T));
+
+    float32x4_t y1L = vld1q_f32(s.y1L);
+    float32x4_t y2L = vld1q_f32(s.y2L);
+    float32x4_t y1R = vld1q_f32(s.y1R);
+    float32x4_t y2R = vld1q_f32(s.y2R);
+    float32x4_t resonance = vld1q_f32(s.resonance);
+    float32x4_t drive = vld1q_f32(s.drive);
+    uint32x4_t active = vld1q_u32(s.active);
+
+    for (size_t i = 0; i < b.numSamples; ++i)
+    {
+        float32x4_t left = vld1q_f32(b.l + i * 4);
+        float32x4_t right = vld1q_f32(b.r + i * 4);
+        float32x4_t cutoff = vld1q_f32(b.cutoff + i * 4);
+
+        // Lanes without a voice or above the cutoff limit keep their input and state
+        uint32x4_t run = vandq_u32(active, vcleq_f32(cutoff, bypass));
+
+        float32x4_t resoScale = vsubq_f32(one, vmulq_f32(vsubq_f32(cutoff, knee), kneeScale));
+        resoScale = vminq_f32(vmaxq_f32(resoScale, zero), one);
+        float32x4_t feedback = vmulq_f32(resonance, resoScale);
+
+        float32x4_t wcT = vmulq_f32(cutoff, omegaT);
+        float32x4_t alpha = divNEON(wcT, vaddq_f32(one, wcT));
+        alpha = vminq_f32(vmaxq_f32(alpha, zero), one);
+
+        float32x4_t fbL = vminq_f32(vmaxq_f32(vmulq_f32(feedback, vsubq_f32(y2L, left)), fbMin), fbMax);
+        float32x4_t fbR = vminq_f32(vmaxq_f32(vmulq_f32(feedback, vsubq_f32(y2R, right)), fbMin), fbMax);
+
+        float32x4_t n1L = vaddq_f32(y1L, vmulq_f32(alpha, vsubq_f32(vsubq_f32(left, fbL), y1L)));
+        float32x4_t n1R = vaddq_f32(y1R, vmulq_f32(alpha, vsubq_f32(vsubq_f32(right, fbR), y1R)));
+        float32x4_t n2L = vaddq_f32(y2L, vmulq_f32(alpha, vsubq_f32(n1L, y2L)));
+        float32x4_t n2R = vaddq_f32(y2R, vmulq_f32(alpha, vsubq_f32(n1R, y2R)));
+
+        y1L = vbslq_f32(run, n1L, y1L);
+        y1R = vbslq_f32(run, n1R, y1R);
+        y2L = vbslq_f32(run, n2L, y2L);
+        y2R = vbslq_f32(run, n2R, y2R);
+
+        vst1q_f32(b.l + i * 4, vbslq_f32(run, clipNEON(vmulq_f32(n2L, drive)), left));
+        vst1q_f32(b.r + i * 4, vbslq_f32(run, clipNEON(vmulq_f32(n2R, drive)), right));
+    }
+
+    vst1q_f32(s.y1L, y1L);
+    vst1q_f32(s.y2L, y2L);
+    vst1q_f32(s.y1R, y1R);
+    vst1q_f32(s.y2R, y2R);
+}
+
+#endif // LANES_NEON
+
+void FilterLaneKernel::processLP(FilterLaneState &state, const FilterLaneBlock &block)
+{
+    kernel().process(state, block);
+}
+
+size_t FilterLaneKernel::getLanes()
+{
+    return kernel().lanes;
+}
+
+const char *FilterLaneKernel::getName()
+{
+    return kernel().name;
+}
+
+const FilterLaneKernel::Kernel &FilterLaneKernel::kernel()
+{
+    static const Kernel selected = []() -> Kernel
+    {
+#ifdef LANES_X86
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx2"))
+            return {&processAVX2, 8, "avx2"};
+
+#ifdef __SSE2__
+        return {&processSSE2, 4, "sse2"};
+#endif
+#endif
+
+#ifdef LANES_NEON
+        return {&processNEON, 4, "neon"};
+#endif
+
+        return {&processScalar, 4, "scalar"};
+    }();
+
+    return selected;
+}
@@ -8,8 +8,8 @@ static dsp_float clusterAmplitude(int harmonic)
     return (mask > 0.8) ? 0.6 / harmonic : 0.1 / harmonic;
 }
 
-void HarmonicClusterWavetable::createWavetable(DSPBuffer &buffer, dsp_float frequency)
+void HarmonicClusterWavetable::createWavetable(DSPBuffer &buffer, dsp_float frequency, dsp_float sampleRate)
 {
     // Fill one full waveform cycle (0 to 2π) across the buffer
-    WaveformGenerator::generateWavetable(buffer, frequency, clusterAmplitude, 0.5);
+    WaveformGenerator::generateWavetable(buffer, frequency, sampleRate, clusterAmplitude, 0.5);
 }
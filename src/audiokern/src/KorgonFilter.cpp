@@ -4,6 +4,7 @@
 // Constructor with sample rate
 KorgonFilter::KorgonFilter()
 {
+    filterMode = FilterMode::LP;
     registerBlockProcessor(&KorgonFilter::processBlockLP);
 }
 
@@ -173,6 +174,129 @@ void KorgonFilter::processBlockHP(DSPObject *dsp)
     self->processBlockHP();
 }
 
+void KorgonFilter::processBatch(KorgonFilter *const *filters, size_t count)
+{
+    size_t lanes = FilterLaneKernel::getLanes();
+    KorgonFilter *batch[FilterLaneState::maxLanes];
+    size_t numBatched = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        KorgonFilter *filter = filters[i];
+
+        if (filter->filterMode != FilterMode::LP)
+        {
+            filter->process();
+            continue;
+        }
+
+        batch[numBatched++] = filter;
+
+        if (numBatched == lanes)
+        {
+            processLanes(batch, numBatched);
+            numBatched = 0;
+        }
+    }
+
+    if (numBatched > 0)
+    {
+        processLanes(batch, numBatched);
+    }
+}
+
+void KorgonFilter::processLanes(KorgonFilter *const *filters, size_t count)
+{
+    const size_t lanes = FilterLaneKernel::getLanes();
+
+    FilterLaneState state;
+    alignas(64) host_float l[laneChunkSize * FilterLaneState::maxLanes];
+    alignas(64) host_float r[laneChunkSize * FilterLaneState::maxLanes];
+    alignas(64) host_float cutoff[laneChunkSize * FilterLaneState::maxLanes];
+
+    for (size_t v = 0; v < lanes; ++v)
+    {
+        if (v < count)
+        {
+            KorgonFilter *f = filters[v];
+
+            if (!std::isfinite(f->y1L) || !std::isfinite(f->y2L) || !std::isfinite(f->y1R) || !std::isfinite(f->y2R))
+                f->reset();
+
+            state.y1L[v] = f->y1L;
+            state.y2L[v] = f->y2L;
+            state.y1R[v] = f->y1R;
+            state.y2R[v] = f->y2R;
+            state.resonance[v] = f->resonance;
+            state.drive[v] = f->drive;
+            state.active[v] = ~0u;
+        }
+        else
+        {
+            state.y1L[v] = 0.0;
+            state.y2L[v] = 0.0;
+            state.y1R[v] = 0.0;
+            state.y2R[v] = 0.0;
+            state.resonance[v] = 0.0;
+            state.drive[v] = 1.0;
+            state.active[v] = 0u;
+        }
+    }
+
+    // Masked lanes are read but never written back, keep them defined
+    std::fill(l, l + laneChunkSize * lanes, static_cast<host_float>(0.0));
+    std::fill(r, r + laneChunkSize * lanes, static_cast<host_float>(0.0));
+    std::fill(cutoff, cutoff + laneChunkSize * lanes, static_cast<host_float>(0.0));
+
+    FilterLaneBlock block;
+    block.l = l;
+    block.r = r;
+    block.cutoff = cutoff;
+    block.T = filters[0]->T;
+
+    for (size_t start = 0; start < DSP::blockSize; start += laneChunkSize)
+    {
+        size_t numSamples = std::min(laneChunkSize, DSP::blockSize - start);
+
+        // Voice-major: the samples of all lanes at one time are adjacent
+        for (size_t v = 0; v < count; ++v)
+        {
+            const KorgonFilter *f = filters[v];
+
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                l[i * lanes + v] = f->processBus.l[start + i];
+                r[i * lanes + v] = f->processBus.r[start + i];
+                cutoff[i * lanes + v] = f->modulationBus.m[start + i];
+            }
+        }
+
+        block.numSamples = numSamples;
+        FilterLaneKernel::processLP(state, block);
+
+        for (size_t v = 0; v < count; ++v)
+        {
+            KorgonFilter *f = filters[v];
+
+            for (size_t i = 0; i < numSamples; ++i)
+            {
+                f->processBus.l[start + i] = l[i * lanes + v];
+                f->processBus.r[start + i] = r[i * lanes + v];
+            }
+        }
+    }
+
+    for (size_t v = 0; v < count; ++v)
+    {
+        KorgonFilter *f = filters[v];
+
+        f->y1L = state.y1L[v];
+        f->y2L = state.y2L[v];
+        f->y1R = state.y1R[v];
+        f->y2R = state.y2R[v];
+    }
+}
+
 // Optional: reset internal state variables
 void KorgonFilter::reset()
 {
@@ -7,8 +7,8 @@ static dsp_float mirrorAmplitude(int harmonic)
     return 1.0 / (std::abs(harmonic - 10) + 1);
 }
 
-void MirrorWavetable::createWavetable(DSPBuffer &buffer, dsp_float frequency)
+void MirrorWavetable::createWavetable(DSPBuffer &buffer, dsp_float frequency, dsp_float sampleRate)
 {
     // Fill one full waveform cycle (0 to 2π) across the buffer
-    WaveformGenerator::generateWavetable(buffer, frequency, mirrorAmplitude, 0.5);
+    WaveformGenerator::generateWavetable(buffer, frequency, sampleRate, mirrorAmplitude, 0.5);
 }
@@ -12,15 +12,19 @@ void Mixer::initializeObject(size_t count)
     busses.clear();
     busses.resize(busCount);
 
+    inputActive.assign(busCount, true);
+
     for (size_t i = 0; i < busCount; ++i)
     {
         busses[i] = &DSPAudioBus::create("mixbus_" + std::to_string(i) + getName(), DSP::blockSize);
+        declareBusAccess("input" + std::to_string(i), *busses[i], DSPBusAccess::Read);
     }
 }
 
 void Mixer::connectOutputToBus(DSPAudioBus &bus)
 {
     outputBus = bus;
+    declareBusAccess("output", bus, DSPBusAccess::Write);
 }
 
 DSPAudioBus &Mixer::getInputBus(size_t index)
@@ -38,6 +42,9 @@ void Mixer::processBlock()
 
     for (size_t i = 0; i < busCount; ++i)
     {
+        if (!inputActive[i])
+            continue;
+
         DSPAudioBus *inBus = busses[i];
 
         for (size_t l = 0; l < DSP::blockSize; ++l)
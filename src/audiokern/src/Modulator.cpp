@@ -18,6 +18,7 @@ void Modulator::initializeObject(size_t count)
 void Modulator::connectModulationToBus(DSPModulationBus &bus)
 {
     modulationBus = bus;
+    declareBusAccess("modulation", bus, DSPBusAccess::Write);
     onModulationBusConnected(bus);
 }
 
@@ -25,6 +26,7 @@ void Modulator::connectFMToBus(DSPModulationBus &bus)
 {
     fmBus = bus;
     fmEnabled = true;
+    declareBusAccess("fm", bus, DSPBusAccess::Read);
     onFMBusConnected(bus);
 }
 
@@ -1,4 +1,5 @@
 #include "NebularReverb.h"
+#include "DSPGraph.h"
 
 NebularReverb::NebularReverb()
 {
@@ -14,9 +15,6 @@ void NebularReverb::initializeEffect()
     delayNames.clear();
     delayNames.resize(maxDelays);
 
-    delays.clear();
-    delays.resize(maxDelays);
-
     delayBusses.clear();
     delayBusses.resize(maxDelays);
 
@@ -26,8 +24,13 @@ void NebularReverb::initializeEffect()
 
         delayBusses[i] = &DSPAudioBus::create("delaybus_" + std::to_string(i) + getName(), DSP::blockSize);
 
-        delays[i] = new CombDelay();
-        delays[i]->setMaxTime(1000.0);
+        // The delay lines are kept when the DSP is initialized again
+        if (delays.size() == static_cast<size_t>(i))
+        {
+            delays.push_back(std::make_unique<CombDelay>());
+            delays[i]->setMaxTime(1000.0);
+        }
+
         delays[i]->initialize(delayNames[i]);
         delays[i]->setTimeOffset(5.0);
         delays[i]->setOutputBus(*delayBusses[i]);
@@ -108,6 +111,31 @@ void NebularReverb::setTimeRatio(dsp_math::TimeRatio ratio)
     }
 }
 
+void NebularReverb::addToGraph(DSPGraph &graph)
+{
+    graph.addNode(lowPass);
+
+    for (int i = 0; i < maxDelays; ++i)
+    {
+        delayTasks[i] = {this, i};
+
+        size_t node = graph.addTask(delayNames[i], &NebularReverb::processDelayTask, &delayTasks[i]);
+        graph.addAccess(node, inputBus, DSPBusAccess::Read);
+        graph.addAccess(node, *delayBusses[i], DSPBusAccess::Write);
+    }
+
+    size_t mix = graph.addTask("mix" + getName(), &NebularReverb::mixDelaysTask, this);
+
+    for (int i = 0; i < maxDelays; ++i)
+    {
+        graph.addAccess(mix, *delayBusses[i], DSPBusAccess::Read);
+    }
+
+    graph.addAccess(mix, wetBus, DSPBusAccess::Write);
+
+    addWetFaderToGraph(graph);
+}
+
 void NebularReverb::processBlock()
 {
     // Lowpass on input
@@ -116,11 +144,24 @@ void NebularReverb::processBlock()
     // Push input to delay buffers and process
     for (int i = 0; i < density; ++i)
     {
-        CombDelay *d = delays[i];
-        d->push();
-        d->process();
+        processDelay(i);
     }
 
+    mixDelays();
+}
+
+void NebularReverb::processDelay(int index)
+{
+    if (index >= density)
+        return;
+
+    CombDelay *d = delays[index].get();
+    d->push();
+    d->process();
+}
+
+void NebularReverb::mixDelays()
+{
     for (size_t i = 0; i < DSP::blockSize; ++i)
     {
         host_float sumL = 0.0;
@@ -137,6 +178,17 @@ void NebularReverb::processBlock()
     }
 }
 
+void NebularReverb::processDelayTask(void *context)
+{
+    DelayTask *task = static_cast<DelayTask *>(context);
+    task->reverb->processDelay(task->index);
+}
+
+void NebularReverb::mixDelaysTask(void *context)
+{
+    static_cast<NebularReverb *>(context)->mixDelays();
+}
+
 void NebularReverb::processBlock(DSPObject *dsp)
 {
     NebularReverb *self = static_cast<NebularReverb *>(dsp);
@@ -6,14 +6,23 @@ ParamFader::ParamFader()
 }
 
 // Queue a parameter change
-void ParamFader::change(ParamChange fn)
+bool ParamFader::change(const ParamChange &change)
 {
-    changes.push(fn);
-    applyParamChange = true;
+    if (changes.push(change))
+        return true;
+
+    droppedChanges.fetch_add(1, std::memory_order_relaxed);
+    return false;
 }
 
 void ParamFader::processBlock()
 {
+    // Changes queued by the control thread start the next fade
+    if (!applyParamChange && !changes.empty())
+    {
+        applyParamChange = true;
+    }
+
     if (applyParamChange)
     {
         fadeCounter++;
@@ -24,11 +33,12 @@ void ParamFader::processBlock()
         }
         else if (fadeCounter == fadeLength + 1)
         {
-            // execute stored function
-            while (!changes.empty())
+            // Apply the changes queued so far, later ones start another fade
+            ParamChange change;
+
+            while (changes.pop(change))
             {
-                changes.front()();
-                changes.pop();
+                change.apply(change);
             }
         }
         else if (fadeCounter <= fadeLength * 2)
@@ -19,7 +19,8 @@ void RingBlockBuffer::initialize(std::string name)
 
     writeIndexL = writeIndexR = 0;
 
-    setMaxTime(5000.0);
+    // A maximum set before is kept, the ring is resized in place for the current sample rate
+    setMaxTime(maxTime > 0.0 ? maxTime : 5000.0);
     setTime(1.0, 1.0);
 }
 
@@ -7,8 +7,8 @@ static dsp_float sawAmplitude(int harmonic)
     return -1.0 / harmonic;
 }
 
-void SawWavetable::createWavetable(DSPBuffer &buffer, dsp_float frequency)
+void SawWavetable::createWavetable(DSPBuffer &buffer, dsp_float frequency, dsp_float sampleRate)
 {
     // Fill one full waveform cycle (0 to 2π) across the buffer
-    WaveformGenerator::generateWavetable(buffer, frequency, sawAmplitude, 0);
+    WaveformGenerator::generateWavetable(buffer, frequency, sampleRate, sawAmplitude, 0);
 }
@@ -1,6 +1,6 @@
 #include "SineWavetable.h"
 
-void SineWavetable::createWavetable(DSPBuffer &buffer, dsp_float /*frequency*/)
+void SineWavetable::createWavetable(DSPBuffer &buffer, dsp_float /*frequency*/, dsp_float /*sampleRate*/)
 {
     size_t size = buffer.size();
 
@@ -1,5 +1,6 @@
 #include "SoundEffect.h"
 #include "dsp_math.h"
+#include "DSPGraph.h"
 
 SoundEffect::SoundEffect()
 {
@@ -49,6 +50,7 @@ void SoundEffect::setWet(host_float vol)
 void SoundEffect::connectInputToBus(DSPAudioBus &bus)
 {
     inputBus = bus;
+    declareBusAccess("input", bus, DSPBusAccess::Read);
     onInputBusConnected(inputBus);
 
     wetFader.connectInputAToBus(bus);
@@ -57,6 +59,7 @@ void SoundEffect::connectInputToBus(DSPAudioBus &bus)
 void SoundEffect::connectOutputToBus(DSPAudioBus &bus)
 {
     outputBus = bus;
+    declareBusAccess("output", bus, DSPBusAccess::Write);
     onOutputBusConnected(outputBus);
 
     wetFader.connectOutputToBus(bus);
@@ -65,6 +68,7 @@ void SoundEffect::connectOutputToBus(DSPAudioBus &bus)
 void SoundEffect::setOutputBus(DSPAudioBus &bus)
 {
     outputBus = bus;
+    declareBusAccess("output", bus, DSPBusAccess::Write);
     onOutputBusConnected(outputBus);
 
     wetFader.connectOutputToBus(bus);
@@ -73,14 +77,21 @@ void SoundEffect::setOutputBus(DSPAudioBus &bus)
 void SoundEffect::connectModulationToBusA(DSPModulationBus &bus)
 {
     modulationBusA = bus;
+    declareBusAccess("modulationA", bus, DSPBusAccess::Read);
     onModulationBusAConnected(modulationBusA);
 }
 void SoundEffect::connectModulationToBusB(DSPModulationBus &bus)
 {
     modulationBusB = bus;
+    declareBusAccess("modulationB", bus, DSPBusAccess::Read);
     onModulationBusBConnected(modulationBusA);
 }
 
+void SoundEffect::addWetFaderToGraph(DSPGraph &graph)
+{
+    graph.addNode(wetFader);
+}
+
 // TODO: remove this
 void SoundEffect::initializeEffect()
 {
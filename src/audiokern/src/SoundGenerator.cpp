@@ -17,12 +17,14 @@ void SoundGenerator::initializeObject(size_t count)
 void SoundGenerator::connectFMToBus(DSPAudioBus &bus)
 {
     fmBus = bus;
+    declareBusAccess("fm", bus, DSPBusAccess::Read);
     onFMBusConnected(bus);
 }
 
 void SoundGenerator::connectOutputToBus(DSPAudioBus &bus)
 {
     outputBus = bus;
+    declareBusAccess("output", bus, DSPBusAccess::Write);
     onOutputBusConnected(bus);
 }
 
@@ -14,12 +14,14 @@ void SoundProcessor::initializeObject(size_t count)
 void SoundProcessor::connectProcessToBus(DSPAudioBus &bus)
 {
     processBus = bus;
+    declareBusAccess("process", bus, DSPBusAccess::ReadWrite);
     onProcessBusConnected(bus);
 }
 
 void SoundProcessor::connectModulationToBus(DSPModulationBus &bus)
 {
     modulationBus = bus;
+    declareBusAccess("modulation", bus, DSPBusAccess::Read);
     onModulationBusConnected(bus);
 }
 
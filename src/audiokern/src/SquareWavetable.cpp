@@ -10,8 +10,8 @@ static dsp_float squareAmplitude(int harmonic)
         return 0.0;
 }
 
-void SquareWavetable::createWavetable(DSPBuffer &buffer, dsp_float frequency)
+void SquareWavetable::createWavetable(DSPBuffer &buffer, dsp_float frequency, dsp_float sampleRate)
 {
     // Fill one full waveform cycle (0 to 2π) across the buffer
-    WaveformGenerator::generateWavetable(buffer, frequency, squareAmplitude, 0.5);
+    WaveformGenerator::generateWavetable(buffer, frequency, sampleRate, squareAmplitude, 0.5);
 }
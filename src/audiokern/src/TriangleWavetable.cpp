@@ -13,8 +13,8 @@ static dsp_float trianlgeAmplitude(int harmonic)
         return 0.0;
 }
 
-void TriangleWavetable::createWavetable(DSPBuffer &buffer, dsp_float frequency)
+void TriangleWavetable::createWavetable(DSPBuffer &buffer, dsp_float frequency, dsp_float sampleRate)
 {
     // Fill one full waveform cycle (0 to 2π) across the buffer
-    WaveformGenerator::generateWavetable(buffer, frequency, trianlgeAmplitude, 0.5);
+    WaveformGenerator::generateWavetable(buffer, frequency, sampleRate, trianlgeAmplitude, 0.5);
 }
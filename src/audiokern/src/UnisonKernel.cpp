@@ -0,0 +1,412 @@
+#include "UnisonKernel.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(HOST_SINGLE_PRECISION) && (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define UNISON_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(HOST_SINGLE_PRECISION) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define UNISON_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Portable reference, one voice at a time so the phase stays in a register
+template <bool FM>
+static bool renderScalar(UnisonState &s, size_t numVoices, const UnisonBlock &b)
+{
+    bool wrapped = false;
+
+    for (size_t v = 0; v < numVoices; ++v)
+    {
+        host_float phase = s.phase[v];
+        host_float inc = s.increment[v];
+        host_float gainL = s.gainL[v];
+        host_float gainR = s.gainR[v];
+        const host_float *fm = s.fmLeft[v] ? b.fmL : b.fmR;
+
+        for (size_t i = 0; i < b.numSamples; ++i)
+        {
+            host_float p = phase;
+
+            if (FM)
+            {
+                p += b.modIndex * fm[i];
+                p -= std::floor(p);
+            }
+
+            host_float index = p * b.size;
+            uint32_t i0 = static_cast<uint32_t>(index);
+            host_float frac = index - static_cast<host_float>(i0);
+
+            i0 &= b.mask;
+            uint32_t i1 = (i0 + 1) & b.mask;
+
+            host_float t0 = b.table[i0];
+            host_float sample = t0 + frac * (b.table[i1] - t0);
+
+            b.outL[i] += sample * gainL;
+            b.outR[i] += sample * gainR;
+
+            phase += inc;
+
+            if (phase >= 1.0)
+            {
+                phase -= 1.0;
+                wrapped = true;
+            }
+        }
+
+        s.phase[v] = phase;
+    }
+
+    return wrapped;
+}
+
+#ifdef UNISON_X86
+
+// GCC 12 reports the undefined pass-through operands inside the AVX-512 intrinsics
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+// 16 voices per instruction, gathers the table samples
+template <bool FM>
+__attribute__((target("avx512f"))) static bool renderAVX512(UnisonState &s, size_t numVoices, const UnisonBlock &b)
+{
+    const __m512 size = _mm512_set1_ps(b.size);
+    const __m512 one = _mm512_set1_ps(1.0f);
+    const __m512i mask = _mm512_set1_epi32(static_cast<int>(b.mask));
+    const __m512i oneIndex = _mm512_set1_epi32(1);
+
+    __mmask16 wrapped = 0;
+
+    for (size_t v = 0; v < numVoices; v += 16)
+    {
+        __m512 phase = _mm512_load_ps(s.phase + v);
+        __m512 inc = _mm512_load_ps(s.increment + v);
+        __m512 gainL = _mm512_load_ps(s.gainL + v);
+        __m512 gainR = _mm512_load_ps(s.gainR + v);
+        __m512i fmLeft = _mm512_load_si512(s.fmLeft + v);
+        __mmask16 left = _mm512_test_epi32_mask(fmLeft, fmLeft);
+
+        for (size_t i = 0; i < b.numSamples; ++i)
+        {
+            __m512 p = phase;
+
+            if (FM)
+            {
+                __m512 modL = _mm512_set1_ps(b.modIndex * b.fmL[i]);
+                __m512 modR = _mm512_set1_ps(b.modIndex * b.fmR[i]);
+                p = _mm512_add_ps(p, _mm512_mask_blend_ps(left, modR, modL));
+                p = _mm512_sub_ps(p, _mm512_roundscale_ps(p, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC));
+            }
+
+            __m512 index = _mm512_mul_ps(p, size);
+            __m512i i0 = _mm512_cvttps_epi32(index);
+            __m512 frac = _mm512_sub_ps(index, _mm512_cvtepi32_ps(i0));
+
+            i0 = _mm512_and_si512(i0, mask);
+            __m512i i1 = _mm512_and_si512(_mm512_add_epi32(i0, oneIndex), mask);
+
+            __m512 t0 = _mm512_i32gather_ps(i0, b.table, 4);
+            __m512 t1 = _mm512_i32gather_ps(i1, b.table, 4);
+            __m512 sample = _mm512_add_ps(t0, _mm512_mul_ps(frac, _mm512_sub_ps(t1, t0)));
+
+            b.outL[i] += _mm512_reduce_add_ps(_mm512_mul_ps(sample, gainL));
+            b.outR[i] += _mm512_reduce_add_ps(_mm512_mul_ps(sample, gainR));
+
+            phase = _mm512_add_ps(phase, inc);
+            __mmask16 ge = _mm512_cmp_ps_mask(phase, one, _CMP_GE_OQ);
+            phase = _mm512_mask_sub_ps(phase, ge, phase, one);
+            wrapped |= ge;
+        }
+
+        _mm512_store_ps(s.phase + v, phase);
+    }
+
+    return wrapped != 0;
+}
+
+#pragma GCC diagnostic pop
+
+__attribute__((target("avx2"))) static inline float hsum256(__m256 v)
+{
+    __m128 x = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+    x = _mm_add_ss(x, _mm_shuffle_ps(x, x, 1));
+    return _mm_cvtss_f32(x);
+}
+
+// 8 voices per instruction, gathers the table samples
+template <bool FM>
+__attribute__((target("avx2"))) static bool renderAVX2(UnisonState &s, size_t numVoices, const UnisonBlock &b)
+{
+    const __m256 size = _mm256_set1_ps(b.size);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256i mask = _mm256_set1_epi32(static_cast<int>(b.mask));
+    const __m256i oneIndex = _mm256_set1_epi32(1);
+
+    __m256 wrapped = _mm256_setzero_ps();
+
+    for (size_t v = 0; v < numVoices; v += 8)
+    {
+        __m256 phase = _mm256_load_ps(s.phase + v);
+        __m256 inc = _mm256_load_ps(s.increment + v);
+        __m256 gainL = _mm256_load_ps(s.gainL + v);
+        __m256 gainR = _mm256_load_ps(s.gainR + v);
+        __m256 left = _mm256_castsi256_ps(_mm256_load_si256(reinterpret_cast<const __m256i *>(s.fmLeft + v)));
+
+        for (size_t i = 0; i < b.numSamples; ++i)
+        {
+            __m256 p = phase;
+
+            if (FM)
+            {
+                __m256 modL = _mm256_set1_ps(b.modIndex * b.fmL[i]);
+                __m256 modR = _mm256_set1_ps(b.modIndex * b.fmR[i]);
+                p = _mm256_add_ps(p, _mm256_blendv_ps(modR, modL, left));
+                p = _mm256_sub_ps(p, _mm256_floor_ps(p));
+            }
+
+            __m256 index = _mm256_mul_ps(p, size);
+            __m256i i0 = _mm256_cvttps_epi32(index);
+            __m256 frac = _mm256_sub_ps(index, _mm256_cvtepi32_ps(i0));
+
+            i0 = _mm256_and_si256(i0, mask);
+            __m256i i1 = _mm256_and_si256(_mm256_add_epi32(i0, oneIndex), mask);
+
+            __m256 t0 = _mm256_i32gather_ps(b.table, i0, 4);
+            __m256 t1 = _mm256_i32gather_ps(b.table, i1, 4);
+            __m256 sample = _mm256_add_ps(t0, _mm256_mul_ps(frac, _mm256_sub_ps(t1, t0)));
+
+            b.outL[i] += hsum256(_mm256_mul_ps(sample, gainL));
+            b.outR[i] += hsum256(_mm256_mul_ps(sample, gainR));
+
+            phase = _mm256_add_ps(phase, inc);
+            __m256 ge = _mm256_cmp_ps(phase, one, _CMP_GE_OQ);
+            phase = _mm256_sub_ps(phase, _mm256_and_ps(ge, one));
+            wrapped = _mm256_or_ps(wrapped, ge);
+        }
+
+        _mm256_store_ps(s.phase + v, phase);
+    }
+
+    return _mm256_movemask_ps(wrapped) != 0;
+}
+
+#ifdef __SSE2__
+
+static inline float hsum128(__m128 x)
+{
+    x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+    x = _mm_add_ss(x, _mm_shuffle_ps(x, x, 1));
+    return _mm_cvtss_f32(x);
+}
+
+// 4 voices per instruction, SSE2 has no gather so the table is read per lane
+template <bool FM>
+static bool renderSSE2(UnisonState &s, size_t numVoices, const UnisonBlock &b)
+{
+    const __m128 size = _mm_set1_ps(b.size);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128i mask = _mm_set1_epi32(static_cast<int>(b.mask));
+    const __m128i oneIndex = _mm_set1_epi32(1);
+
+    alignas(16) uint32_t idx0[4];
+    alignas(16) uint32_t idx1[4];
+
+    __m128 wrapped = _mm_setzero_ps();
+
+    for (size_t v = 0; v < numVoices; v += 4)
+    {
+        __m128 phase = _mm_load_ps(s.phase + v);
+        __m128 inc = _mm_load_ps(s.increment + v);
+        __m128 gainL = _mm_load_ps(s.gainL + v);
+        __m128 gainR = _mm_load_ps(s.gainR + v);
+        __m128 left = _mm_castsi128_ps(_mm_load_si128(reinterpret_cast<const __m128i *>(s.fmLeft + v)));
+
+        for (size_t i = 0; i < b.numSamples; ++i)
+        {
+            __m128 p = phase;
+
+            if (FM)
+            {
+                __m128 modL = _mm_set1_ps(b.modIndex * b.fmL[i]);
+                __m128 modR = _mm_set1_ps(b.modIndex * b.fmR[i]);
+                p = _mm_add_ps(p, _mm_or_ps(_mm_and_ps(left, modL), _mm_andnot_ps(left, modR)));
+
+                // floor: truncate, then step down where truncation rounded up
+                __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(p));
+                t = _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, p), one));
+                p = _mm_sub_ps(p, t);
+            }
+
+            __m128 index = _mm_mul_ps(p, size);
+            __m128i i0 = _mm_cvttps_epi32(index);
+            __m128 frac = _mm_sub_ps(index, _mm_cvtepi32_ps(i0));
+
+            i0 = _mm_and_si128(i0, mask);
+            _mm_store_si128(reinterpret_cast<__m128i *>(idx0), i0);
+            _mm_store_si128(reinterpret_cast<__m128i *>(idx1), _mm_and_si128(_mm_add_epi32(i0, oneIndex), mask));
+
+            __m128 t0 = _mm_set_ps(b.table[idx0[3]], b.table[idx0[2]], b.table[idx0[1]], b.table[idx0[0]]);
+            __m128 t1 = _mm_set_ps(b.table[idx1[3]], b.table[idx1[2]], b.table[idx1[1]], b.table[idx1[0]]);
+            __m128 sample = _mm_add_ps(t0, _mm_mul_ps(frac, _mm_sub_ps(t1, t0)));
+
+            b.outL[i] += hsum128(_mm_mul_ps(sample, gainL));
+            b.outR[i] += hsum128(_mm_mul_ps(sample, gainR));
+
+            phase = _mm_add_ps(phase, inc);
+            __m128 ge = _mm_cmpge_ps(phase, one);
+            phase = _mm_sub_ps(phase, _mm_and_ps(ge, one));
+            wrapped = _mm_or_ps(wrapped, ge);
+        }
+
+        _mm_store_ps(s.phase + v, phase);
+    }
+
+    return _mm_movemask_ps(wrapped) != 0;
+}
+
+#endif // __SSE2__
+#endif // UNISON_X86
+
+#ifdef UNISON_NEON
+
+static inline float hsumNEON(float32x4_t v)
+{
+#if defined(__aarch64__)
+    return vaddvq_f32(v);
+#else
+    float32x2_t x = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+    x = vpadd_f32(x, x);
+    return vget_lane_f32(x, 0);
+#endif
+}
+
+// 4 voices per instruction, NEON has no gather so the table is read per lane
+template <bool FM>
+static bool renderNEON(UnisonState &s, size_t numVoices, const UnisonBlock &b)
+{
+    const float32x4_t size = vdupq_n_f32(b.size);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const uint32x4_t oneBits = vreinterpretq_u32_f32(one);
+    const uint32x4_t mask = vdupq_n_u32(b.mask);
+    const uint32x4_t oneIndex = vdupq_n_u32(1);
+
+    alignas(16) uint32_t idx0[4];
+    alignas(16) uint32_t idx1[4];
+    alignas(16) float t0s[4];
+    alignas(16) float t1s[4];
+
+    uint32x4_t wrapped = vdupq_n_u32(0);
+
+    for (size_t v = 0; v < numVoices; v += 4)
+    {
+        float32x4_t phase = vld1q_f32(s.phase + v);
+        float32x4_t inc = vld1q_f32(s.increment + v);
+        float32x4_t gainL = vld1q_f32(s.gainL + v);
+        float32x4_t gainR = vld1q_f32(s.gainR + v);
+        uint32x4_t left = vld1q_u32(s.fmLeft + v);
+
+        for (size_t i = 0; i < b.numSamples; ++i)
+        {
+            float32x4_t p = phase;
+
+            if (FM)
+            {
+                float32x4_t modL = vdupq_n_f32(b.modIndex * b.fmL[i]);
+                float32x4_t modR = vdupq_n_f32(b.modIndex * b.fmR[i]);
+                p = vaddq_f32(p, vbslq_f32(left, modL, modR));
+
+                // floor: truncate, then step down where truncation rounded up
+                float32x4_t t = vcvtq_f32_s32(vcvtq_s32_f32(p));
+                t = vsubq_f32(t, vreinterpretq_f32_u32(vandq_u32(vcgtq_f32(t, p), oneBits)));
+                p = vsubq_f32(p, t);
+            }
+
+            float32x4_t index = vmulq_f32(p, size);
+            uint32x4_t i0 = vcvtq_u32_f32(index);
+            float32x4_t frac = vsubq_f32(index, vcvtq_f32_u32(i0));
+
+            i0 = vandq_u32(i0, mask);
+            vst1q_u32(idx0, i0);
+            vst1q_u32(idx1, vandq_u32(vaddq_u32(i0, oneIndex), mask));
+
+            for (int k = 0; k < 4; ++k)
+            {
+                t0s[k] = b.table[idx0[k]];
+                t1s[k] = b.table[idx1[k]];
+            }
+
+            float32x4_t t0 = vld1q_f32(t0s);
+            float32x4_t t1 = vld1q_f32(t1s);
+            float32x4_t sample = vaddq_f32(t0, vmulq_f32(frac, vsubq_f32(t1, t0)));
+
+            b.outL[i] += hsumNEON(vmulq_f32(sample, gainL));
+            b.outR[i] += hsumNEON(vmulq_f32(sample, gainR));
+
+            phase = vaddq_f32(phase, inc);
+            uint32x4_t ge = vcgeq_f32(phase, one);
+            phase = vsubq_f32(phase, vreinterpretq_f32_u32(vandq_u32(ge, oneBits)));
+            wrapped = vorrq_u32(wrapped, ge);
+        }
+
+        vst1q_f32(s.phase + v, phase);
+    }
+
+    uint32x2_t w = vorr_u32(vget_low_u32(wrapped), vget_high_u32(wrapped));
+    return (vget_lane_u32(w, 0) | vget_lane_u32(w, 1)) != 0;
+}
+
+#endif // UNISON_NEON
+
+// Picks the FM or plain variant of a kernel
+template <bool (*Plain)(UnisonState &, size_t, const UnisonBlock &),
+          bool (*Modulated)(UnisonState &, size_t, const UnisonBlock &)>
+static bool renderWith(UnisonState &s, size_t numVoices, const UnisonBlock &b)
+{
+    std::fill(b.outL, b.outL + b.numSamples, static_cast<host_float>(0.0));
+    std::fill(b.outR, b.outR + b.numSamples, static_cast<host_float>(0.0));
+
+    return b.fmL ? Modulated(s, numVoices, b) : Plain(s, numVoices, b);
+}
+
+bool UnisonKernel::render(UnisonState &state, size_t numVoices, const UnisonBlock &block)
+{
+    return kernel().render(state, numVoices, block);
+}
+
+const char *UnisonKernel::getName()
+{
+    return kernel().name;
+}
+
+const UnisonKernel::Kernel &UnisonKernel::kernel()
+{
+    static const Kernel selected = []() -> Kernel
+    {
+#ifdef UNISON_X86
+        __builtin_cpu_init();
+
+        if (__builtin_cpu_supports("avx512f"))
+            return {&renderWith<&renderAVX512<false>, &renderAVX512<true>>, "avx512"};
+
+        if (__builtin_cpu_supports("avx2"))
+            return {&renderWith<&renderAVX2<false>, &renderAVX2<true>>, "avx2"};
+
+#ifdef __SSE2__
+        return {&renderWith<&renderSSE2<false>, &renderSSE2<true>>, "sse2"};
+#endif
+#endif
+
+#ifdef UNISON_NEON
+        return {&renderWith<&renderNEON<false>, &renderNEON<true>>, "neon"};
+#endif
+
+        return {&renderWith<&renderScalar<false>, &renderScalar<true>>, "scalar"};
+    }();
+
+    return selected;
+}
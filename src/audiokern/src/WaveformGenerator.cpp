@@ -2,44 +2,54 @@
 
 void WaveformGenerator::generateWavetable(DSPBuffer &buffer,
                                           dsp_float baseFrequency,
+                                          dsp_float sampleRate,
                                           AmplitudeFunction amplitudeFunc,
                                           dsp_float harmonicBoost)
 {
     size_t size = buffer.size();
 
-    // Check for invalid input (no size, zero freq/sampleRate)
-    if (size == 0 || baseFrequency <= 0.0)
+    // Check for invalid input (no power of two size, zero freq/sampleRate)
+    if (size < 2 || (size & (size - 1)) != 0 || baseFrequency <= 0.0 || sampleRate <= 0.0)
     {
-        DSP::log("WaveformGenerator::generateWavetable failed: invalid buffer size or invalid frequency");
+        DSP::log("WaveformGenerator::generateWavetable failed: invalid buffer size, frequency or sample rate");
         return;
     }
 
     // Nyquist frequency: we only include harmonics below this threshold
-    const dsp_float nyquist = 0.5 * DSP::sampleRate;
+    const dsp_float nyquist = 0.5 * sampleRate;
 
     // Maximum number of harmonics allowed without aliasing
     int harmonics = static_cast<int>(nyquist / baseFrequency * (1 + clamp(harmonicBoost, 0, 1) * 9));
 
-    // Loop over each sample index in the buffer
-    for (size_t i = 0; i < size; ++i)
+    // Build the sine spectrum of one cycle
+    size_t half = size / 2;
+    std::vector<std::complex<double>> spectrum(half + 1);
+
+    for (int n = 1; n <= harmonics; ++n)
     {
-        // Convert index to phase in range [0.0, 1.0)
-        dsp_float phase = static_cast<dsp_float>(i) / static_cast<dsp_float>(size - 1);
+        // Get amplitude for harmonic n
+        double amp = amplitudeFunc(n);
 
-        dsp_float sample = 0.0;
+        // Harmonics beyond the table resolution alias like they do when summed directly:
+        // sin(2 pi n i / size) equals the sine of bin n mod size, mirrored above half
+        size_t k = static_cast<size_t>(n) % size;
 
-        // Sum up all harmonics (from 1st to harmonics)
-        for (int n = 1; n <= harmonics; ++n)
-        {
-            // Get amplitude for harmonic n
-            dsp_float amp = amplitudeFunc(n);
+        if (k == 0 || k == half)
+            continue; // Sampled at its zero crossings only
 
-            // Add sine component for harmonic n at current phase
-            sample += amp * std::sin(dsp_math::DSP_2PI * n * phase);
-        }
+        if (k < half)
+            spectrum[k] += std::complex<double>(0.0, -amp);
+        else
+            spectrum[size - k] += std::complex<double>(0.0, amp);
+    }
 
+    std::vector<double> samples;
+    inverseRealFFT(spectrum, samples);
+
+    for (size_t i = 0; i < size; ++i)
+    {
         // Store computed sample in buffer (converted to DSP format)
-        buffer[i] = DSP::zeroSubnormals(sample);
+        buffer[i] = DSP::zeroSubnormals(static_cast<dsp_float>(samples[i]));
     }
 
     // Nomralisation
@@ -55,3 +65,71 @@ void WaveformGenerator::generateWavetable(DSPBuffer &buffer,
             buffer[i] /= peak;
     }
 }
+
+void WaveformGenerator::inverseRealFFT(const std::vector<std::complex<double>> &spectrum, std::vector<double> &output)
+{
+    size_t size = (spectrum.size() - 1) * 2;
+    size_t half = size / 2;
+
+    // Pack the real signal of size samples into a complex one of half the size:
+    // even samples become the real part, odd samples the imaginary part
+    std::vector<std::complex<double>> packed(half);
+
+    for (size_t k = 0; k < half; ++k)
+    {
+        std::complex<double> x = spectrum[k];
+        std::complex<double> y = std::conj(spectrum[half - k]);
+
+        std::complex<double> even = 0.5 * (x + y);
+        std::complex<double> odd = 0.5 * (x - y) * std::polar(1.0, 2.0 * M_PI * static_cast<double>(k) / static_cast<double>(size));
+
+        packed[k] = even + std::complex<double>(0.0, 1.0) * odd;
+    }
+
+    inverseFFT(packed.data(), half);
+
+    output.resize(size);
+
+    for (size_t n = 0; n < half; ++n)
+    {
+        output[2 * n] = packed[n].real();
+        output[2 * n + 1] = packed[n].imag();
+    }
+}
+
+void WaveformGenerator::inverseFFT(std::complex<double> *data, size_t size)
+{
+    // Bit-reversal permutation
+    for (size_t i = 1, j = 0; i < size; ++i)
+    {
+        size_t bit = size >> 1;
+
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+
+        j ^= bit;
+
+        if (i < j)
+            std::swap(data[i], data[j]);
+    }
+
+    // Radix-2 butterflies, one twiddle factor per position within a span
+    for (size_t span = 2; span <= size; span <<= 1)
+    {
+        size_t step = span / 2;
+
+        for (size_t j = 0; j < step; ++j)
+        {
+            std::complex<double> w = std::polar(1.0, 2.0 * M_PI * static_cast<double>(j) / static_cast<double>(span));
+
+            for (size_t i = j; i < size; i += span)
+            {
+                std::complex<double> u = data[i];
+                std::complex<double> v = data[i + step] * w;
+
+                data[i] = u + v;
+                data[i + step] = u - v;
+            }
+        }
+    }
+}
@@ -0,0 +1,297 @@
+#include "WavetableFile.h"
+#include "DSP.h"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char wavetableMagic[8] = {'A', 'K', 'W', 'T', 'B', 'L', 0, 0};
+
+// Table data starts on cache line boundaries
+static uint64_t alignOffset(uint64_t offset)
+{
+    return (offset + 63) & ~static_cast<uint64_t>(63);
+}
+
+WavetableFile::WavetableFile()
+    : mapping(nullptr), mappingSize(0), mapped(false)
+{
+}
+
+WavetableFile::~WavetableFile()
+{
+    close();
+}
+
+uint64_t WavetableFile::checksum(const uint8_t *data, size_t size)
+{
+    uint64_t hash = 14695981039346656037ull;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+bool WavetableFile::open(const std::string &path, uint32_t sampleRate, uint32_t tableVersion)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header))
+    {
+        ::close(fd);
+        DSP::log("Wavetable file %s is truncated", path.c_str());
+        return false;
+    }
+
+    size_t fileSize = static_cast<size_t>(st.st_size);
+    void *addr = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+
+    // The mapping keeps its own reference to the file
+    ::close(fd);
+
+    if (addr == MAP_FAILED)
+    {
+        DSP::log("Could not map wavetable file %s", path.c_str());
+        return false;
+    }
+
+    mapping = static_cast<const uint8_t *>(addr);
+    mappingSize = fileSize;
+    mapped = true;
+
+    const char *stale = validate(sampleRate, tableVersion, true);
+
+    if (stale)
+    {
+        DSP::log("Wavetable file %s is stale (%s)", path.c_str(), stale);
+        close();
+        return false;
+    }
+
+    // Tables are read in order of frequency as notes come in
+    madvise(const_cast<uint8_t *>(mapping), mappingSize, MADV_WILLNEED);
+
+    return true;
+}
+
+bool WavetableFile::open(const void *data, size_t size, uint32_t sampleRate, uint32_t tableVersion)
+{
+    close();
+
+    mapping = static_cast<const uint8_t *>(data);
+    mappingSize = size;
+
+    const char *stale = validate(sampleRate, tableVersion, false);
+
+    if (stale)
+    {
+        DSP::log("Wavetable image is stale (%s)", stale);
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+const char *WavetableFile::validate(uint32_t sampleRate, uint32_t tableVersion, bool verifyChecksum)
+{
+    if (mappingSize < sizeof(Header))
+        return "truncated";
+
+    Header header;
+    std::memcpy(&header, mapping, sizeof(Header));
+
+    if (std::memcmp(header.magic, wavetableMagic, sizeof(wavetableMagic)) != 0)
+        return "not a wavetable file";
+
+    if (header.version != formatVersion || header.byteOrder != byteOrderMark || header.sampleBytes != sizeof(host_float))
+        return "written by an incompatible build";
+
+    if (header.sampleRate != sampleRate)
+        return "sample rate mismatch";
+
+    if (header.tableVersion != tableVersion)
+        return "outdated table version";
+
+    if (header.numTables == 0 || header.payloadBytes != mappingSize - sizeof(Header) ||
+        header.numTables > header.payloadBytes / sizeof(Entry))
+        return "truncated";
+
+    if (verifyChecksum && checksum(mapping + sizeof(Header), header.payloadBytes) != header.checksum)
+        return "checksum mismatch";
+
+    entries.resize(header.numTables);
+    std::memcpy(entries.data(), mapping + sizeof(Header), header.numTables * sizeof(Entry));
+
+    for (const auto &entry : entries)
+    {
+        if (entry.size == 0 || entry.offset % 64 != 0 || entry.offset > mappingSize ||
+            entry.size > (mappingSize - entry.offset) / sizeof(host_float))
+            return "invalid directory";
+    }
+
+    return nullptr;
+}
+
+void WavetableFile::close()
+{
+    if (mapping && mapped)
+    {
+        munmap(const_cast<uint8_t *>(mapping), mappingSize);
+    }
+
+    mapping = nullptr;
+    mappingSize = 0;
+    mapped = false;
+    entries.clear();
+}
+
+const host_float *WavetableFile::getTable(size_t index) const
+{
+    return reinterpret_cast<const host_float *>(mapping + entries[index].offset);
+}
+
+bool WavetableFile::write(const std::string &path,
+                          uint32_t sampleRate,
+                          uint32_t tableVersion,
+                          const std::vector<host_float> &baseFrequencies,
+                          const std::vector<std::vector<host_float>> &tables)
+{
+    if (tables.empty() || tables.size() != baseFrequencies.size())
+    {
+        DSP::log("Wavetable file %s: no tables to write", path.c_str());
+        return false;
+    }
+
+    // Lay out directory and table data behind the header
+    std::vector<Entry> directory(tables.size());
+    uint64_t offset = alignOffset(sizeof(Header) + tables.size() * sizeof(Entry));
+
+    for (size_t i = 0; i < tables.size(); ++i)
+    {
+        directory[i].baseFrequency = baseFrequencies[i];
+        directory[i].size = tables[i].size();
+        directory[i].offset = offset;
+
+        offset = alignOffset(offset + tables[i].size() * sizeof(host_float));
+    }
+
+    std::vector<uint8_t> image(offset, 0);
+    std::memcpy(image.data() + sizeof(Header), directory.data(), directory.size() * sizeof(Entry));
+
+    for (size_t i = 0; i < tables.size(); ++i)
+    {
+        std::memcpy(image.data() + directory[i].offset, tables[i].data(), tables[i].size() * sizeof(host_float));
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(Header));
+    std::memcpy(header.magic, wavetableMagic, sizeof(wavetableMagic));
+    header.version = formatVersion;
+    header.byteOrder = byteOrderMark;
+    header.sampleBytes = sizeof(host_float);
+    header.sampleRate = sampleRate;
+    header.tableVersion = tableVersion;
+    header.numTables = static_cast<uint32_t>(tables.size());
+    header.payloadBytes = image.size() - sizeof(Header);
+    header.checksum = checksum(image.data() + sizeof(Header), header.payloadBytes);
+    std::memcpy(image.data(), &header, sizeof(Header));
+
+    // Write a private temporary file and rename it over the target
+    std::string tmpPath = path + "." + std::to_string(getpid()) + ".tmp";
+    FILE *file = fopen(tmpPath.c_str(), "wb");
+
+    if (!file)
+    {
+        DSP::log("Could not create wavetable file %s", tmpPath.c_str());
+        return false;
+    }
+
+    bool ok = fwrite(image.data(), 1, image.size(), file) == image.size();
+    ok = (fclose(file) == 0) && ok;
+
+    if (!ok || rename(tmpPath.c_str(), path.c_str()) != 0)
+    {
+        DSP::log("Could not write wavetable file %s", path.c_str());
+        unlink(tmpPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+bool WavetableFile::readLegacy(const std::string &path,
+                               std::vector<host_float> &baseFrequencies,
+                               std::vector<std::vector<host_float>> &tables)
+{
+    std::ifstream inFile(path.c_str());
+
+    if (!inFile.is_open())
+        return false;
+
+    baseFrequencies.clear();
+    tables.clear();
+
+    std::string line;
+
+    while (std::getline(inFile, line))
+    {
+        std::stringstream ss(line);
+        std::string item;
+
+        try
+        {
+            // Read frequency
+            if (!std::getline(ss, item, ','))
+                continue;
+
+            host_float freq = std::stod(item);
+
+            // Read size
+            if (!std::getline(ss, item, ','))
+                continue;
+
+            size_t size = static_cast<size_t>(std::stoul(item));
+
+            std::vector<host_float> table;
+            table.reserve(size);
+
+            // Read data
+            while (table.size() < size && std::getline(ss, item, ','))
+            {
+                table.push_back(static_cast<host_float>(std::stod(item)));
+            }
+
+            if (size == 0 || table.size() != size)
+            {
+                DSP::log("Invalid format in wavetable %s", path.c_str());
+                return false;
+            }
+
+            baseFrequencies.push_back(freq);
+            tables.push_back(std::move(table));
+        }
+        catch (const std::exception &ex)
+        {
+            DSP::log("Error reading wavetable %s (%s)", path.c_str(), ex.what());
+            return false;
+        }
+    }
+
+    return !tables.empty();
+}
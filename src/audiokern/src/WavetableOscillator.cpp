@@ -1,6 +1,7 @@
 #include "WavetableOscillator.h"
 
-std::vector<SharedWavetableSet> WavetableOscillator::sharedWavetables;
+std::deque<SharedWavetableSet> WavetableOscillator::sharedWavetables;
+std::mutex WavetableOscillator::sharedWavetablesMutex;
 
 // Ctor: expects an unique name for the waveform
 // This name is used for managiong wavetable files
@@ -9,24 +10,12 @@ WavetableOscillator::WavetableOscillator(const std::string formName)
     // set the waveform name
     waveformName = formName;
 
-    // Define the base frequencies at which a new wavetable is used
-    // These roughly correspond to octave steps starting from 20 Hz
-    baseFrequencies = {20.0, 40.0, 160.0, 640.0, 2560.0};
-
-    // Define the corresponding table size for each frequency range
-    // Higher frequencies require higher resolution to avoid interpolation artifacts
-    tableSizes = {1024, 2048, 4096, 8192, 16384};
-
-    // Initialize wavetable buffers
-    wavetableCalcBuffers.reserve(tableSizes.size());
-    wavetableSampleBuffers.reserve(tableSizes.size());
+    // The mipmap levels depend on the sample rate, see generate()
 }
 
-// Destructor releases memory for wavetables
+// The tables belong to the shared cache
 WavetableOscillator::~WavetableOscillator()
 {
-    wavetableCalcBuffers.clear();
-    wavetableSampleBuffers.clear();
 }
 
 void WavetableOscillator::initializeGenerator()
@@ -38,9 +27,23 @@ void WavetableOscillator::initializeGenerator()
     resetPhase();
     setAnalogDrift(0.0);
 
-    lastFrequency = -1.0;
+    selectedLevel = noLevel;
+
+    fadeL.initialize("fadeL" + getName(), DSP::blockSize);
+    fadeR.initialize("fadeR" + getName(), DSP::blockSize);
 
-    acquireSharedWavetable();
+    setWavetable(acquireSharedWavetable());
+}
+
+void WavetableOscillator::setWavetable(const SharedWavetableSet *set)
+{
+    wavetable = set;
+
+    // Levels of different sets are not related, do not crossfade into the new one
+    selectedLevel = noLevel;
+
+    // One level per octave above the lowest base frequency
+    levelScale = (!set || set->baseFrequencies.empty()) ? 0.0 : DSP::sampleRate / set->baseFrequencies.front();
 }
 
 // Gets the current frequency
@@ -67,8 +70,8 @@ void WavetableOscillator::setModIndex(host_float index)
 
 void WavetableOscillator::setNumVoices(int count)
 {
-    // Clamp to [1, 9] and resize
-    numVoices = clamp(count, 1, 9);
+    // Clamp to [1, maxVoices] and resize
+    numVoices = clamp(count, 1, maxVoices);
     voices.resize(numVoices);
 
     // to avoid vtable lookup in DSPObject
@@ -77,11 +80,15 @@ void WavetableOscillator::setNumVoices(int count)
     else
         registerBlockProcessor(&WavetableOscillator::processBlockVoices);
 
-    for (int i = 0; i < numVoices; ++i)
+    for (int i = 0; i < maxVoices; ++i)
     {
-        // Randomize phase [0.0, 1.0)
-        voices[i].phase = static_cast<host_float>(rand()) / RAND_MAX;
+        // Randomize phase [0.0, 1.0), unused lanes stay silent at 0
+        unison.phase[i] = i < numVoices ? static_cast<host_float>(phaseRand.nextRandomSample()) : 0.0;
+        unison.increment[i] = 0.0;
+    }
 
+    for (int i = 0; i < numVoices; ++i)
+    {
         // Stereo panning - from -1.0 (left) to +1.0 (right)
         host_float pan = (numVoices > 1)
                             ? static_cast<host_float>(i) / (numVoices - 1) * 2.0 - 1.0
@@ -98,6 +105,29 @@ void WavetableOscillator::setNumVoices(int count)
     updateDetune(); // ensure detune_ratios match after resizing
 
     voiceGain = getVocieGain(numVoices);
+
+    updateUnison();
+}
+
+void WavetableOscillator::updateUnison()
+{
+    for (int i = 0; i < maxVoices; ++i)
+    {
+        if (i < numVoices)
+        {
+            const WavetableVoice &v = voices[i];
+
+            unison.gainL[i] = v.amp_ratio * v.gainL * voiceGain;
+            unison.gainR[i] = v.amp_ratio * v.gainR * voiceGain;
+            unison.fmLeft[i] = v.gainL > v.gainR ? ~0u : 0u;
+        }
+        else
+        {
+            unison.gainL[i] = 0.0;
+            unison.gainR[i] = 0.0;
+            unison.fmLeft[i] = 0u;
+        }
+    }
 }
 
 void WavetableOscillator::updateDetune()
@@ -117,20 +147,37 @@ void WavetableOscillator::setDetune(host_float value)
     updateDetune();
 }
 
-void WavetableOscillator::selectTable(double frequency)
+size_t WavetableOscillator::selectLevel(host_float increment) const
+{
+    // Octaves above the lowest level, the exponent of the float is the level
+    host_float octaves = increment * levelScale;
+
+    if (!(octaves >= 1.0))
+        return 0;
+
+    return std::min(static_cast<size_t>(std::ilogb(octaves)), wavetable->buffers.size() - 1);
+}
+
+void WavetableOscillator::setLevelCrossfade(bool enabled)
+{
+    levelCrossfade = enabled;
+}
+
+void WavetableOscillator::crossfadeLevels()
 {
-    for (size_t i = baseFrequencies.size(); i-- > 0;)
+    host_float *outL = outputBus.l.data();
+    host_float *outR = outputBus.r.data();
+    const host_float *prevL = fadeL.data();
+    const host_float *prevR = fadeR.data();
+    host_float step = 1.0 / static_cast<host_float>(DSP::blockSize);
+
+    for (size_t i = 0; i < DSP::blockSize; ++i)
     {
-        if (frequency >= baseFrequencies[i])
-        {
-            selectedWaveTable = wavetableSampleBuffers[i];
-            selectedWaveTableSize = selectedWaveTable->size();
-        }
-    }
+        host_float t = static_cast<host_float>(i + 1) * step;
 
-    // Fallback
-    selectedWaveTable = wavetableSampleBuffers.front();
-    selectedWaveTableSize = selectedWaveTable->size();
+        outL[i] = prevL[i] + t * (outL[i] - prevL[i]);
+        outR[i] = prevR[i] + t * (outR[i] - prevR[i]);
+    }
 }
 
 // Returns true if the oscillator's phase wrapped during the last getSample() call
@@ -160,14 +207,37 @@ void WavetableOscillator::setAnalogDrift(host_float d)
 // Next sample block generation one voice
 void WavetableOscillator::processBlockVoice()
 {
-    // Select wavetable once per sample block
-    if (frequency != lastFrequency)
+    phaseIncrement = (frequency + drift) / DSP::sampleRate;
+
+    // Select the mipmap level once per sample block
+    size_t level = selectLevel(phaseIncrement);
+
+    if (levelCrossfade && selectedLevel != noLevel && level != selectedLevel)
     {
-        selectTable(frequency);
-        lastFrequency = frequency;
+        // Render the block from the previous level as well, from the same phase
+        host_float phase = currentPhase;
+        bool wasWrapped = wrapped;
+
+        renderVoice(*wavetable->buffers[selectedLevel], fadeL.data(), fadeR.data());
+
+        currentPhase = phase;
+        wrapped = wasWrapped;
+
+        renderVoice(*wavetable->buffers[level], outputBus.l.data(), outputBus.r.data());
+        crossfadeLevels();
+    }
+    else
+    {
+        renderVoice(*wavetable->buffers[level], outputBus.l.data(), outputBus.r.data());
     }
 
-    phaseIncrement = (frequency + drift) / DSP::sampleRate;
+    selectedLevel = level;
+}
+
+void WavetableOscillator::renderVoice(const DSPSampleBuffer &table, host_float *outL, host_float *outR)
+{
+    const size_t tableSize = table.size();
+    const size_t mask = tableSize - 1;
 
     if (generatorRole == GeneratorRole::Normal)
     {
@@ -187,19 +257,21 @@ void WavetableOscillator::processBlockVoice()
             modPhaseL -= std::floor(modPhaseL);
             modPhaseR -= std::floor(modPhaseR);
 
-            host_float indexL = modPhaseL * selectedWaveTableSize;
-            host_float indexR = modPhaseR * selectedWaveTableSize;
+            host_float indexL = modPhaseL * tableSize;
+            host_float indexR = modPhaseR * tableSize;
 
             size_t i0L = static_cast<size_t>(indexL);
-            size_t i1L = (i0L + 1) % selectedWaveTableSize;
             host_float fracL = indexL - i0L;
+            i0L &= mask;
+            size_t i1L = (i0L + 1) & mask;
 
             size_t i0R = static_cast<size_t>(indexR);
-            size_t i1R = (i0R + 1) % selectedWaveTableSize;
             host_float fracR = indexR - i0R;
+            i0R &= mask;
+            size_t i1R = (i0R + 1) & mask;
 
-            outputBus.l[i] = (1.0 - fracL) * (*selectedWaveTable)[i0L] + fracL * (*selectedWaveTable)[i1L];
-            outputBus.r[i] = (1.0 - fracR) * (*selectedWaveTable)[i0R] + fracR * (*selectedWaveTable)[i1R];
+            outL[i] = (1.0 - fracL) * table[i0L] + fracL * table[i1L];
+            outR[i] = (1.0 - fracR) * table[i0R] + fracR * table[i1R];
         }
     }
     else
@@ -223,122 +295,79 @@ void WavetableOscillator::processBlockVoice()
             modPhaseL -= std::floor(modPhaseL);
             modPhaseR -= std::floor(modPhaseR);
 
-            host_float indexL = modPhaseL * selectedWaveTableSize;
-            host_float indexR = modPhaseR * selectedWaveTableSize;
+            host_float indexL = modPhaseL * tableSize;
+            host_float indexR = modPhaseR * tableSize;
 
             size_t i0L = static_cast<size_t>(indexL);
-            size_t i1L = (i0L + 1) % selectedWaveTableSize;
             host_float fracL = indexL - i0L;
+            i0L &= mask;
+            size_t i1L = (i0L + 1) & mask;
 
             size_t i0R = static_cast<size_t>(indexR);
-            size_t i1R = (i0R + 1) % selectedWaveTableSize;
             host_float fracR = indexR - i0R;
+            i0R &= mask;
+            size_t i1R = (i0R + 1) & mask;
 
-            outputBus.l[i] = (1.0 - fracL) * (*selectedWaveTable)[i0L] + fracL * (*selectedWaveTable)[i1L];
-            outputBus.r[i] = (1.0 - fracR) * (*selectedWaveTable)[i0R] + fracR * (*selectedWaveTable)[i1R];
+            outL[i] = (1.0 - fracL) * table[i0L] + fracL * table[i1L];
+            outR[i] = (1.0 - fracR) * table[i0R] + fracR * table[i1R];
         }
     }
 }
 
 void WavetableOscillator::processBlockVoices()
 {
-    // Select wavetable once per sample block
-    if (frequency != lastFrequency)
-    {
-        selectTable(frequency);
-        lastFrequency = frequency;
-    }
-
-    if (generatorRole == GeneratorRole::Normal)
-    {
-        for (size_t i = 0; i < DSP::blockSize; ++i)
-        {
-            host_float sumL = 0.0;
-            host_float sumR = 0.0;
-
-            for (auto &v : voices)
-            {
-                host_float voiceFreq = (frequency + drift) * (1.0 + v.detune_ratio);
-
-                // Phase modulation
-                host_float phase = v.phase;
-                phase -= std::floor(phase); // Wrap to [0, 1)
-
-                host_float index = phase * selectedWaveTableSize;
-                size_t i0 = static_cast<size_t>(index);
-                size_t i1 = (i0 + 1) % selectedWaveTableSize;
-                host_float frac = index - i0;
-
-                // Interpolation
-                host_float sample = (1.0 - frac) * (*selectedWaveTable)[i0] + frac * (*selectedWaveTable)[i1];
+    // Increments only change per block
+    host_float baseIncrement = (frequency + drift) / DSP::sampleRate;
 
-                // Sum weighted
-                sumL += sample * v.amp_ratio * v.gainL;
-                sumR += sample * v.amp_ratio * v.gainR;
+    // Select the mipmap level once per sample block
+    size_t level = selectLevel(baseIncrement);
+    const DSPSampleBuffer &table = *wavetable->buffers[level];
 
-                // Advance phase
-                host_float inc = voiceFreq / DSP::sampleRate;
-                v.phase += inc;
-
-                if (v.phase >= 1.0)
-                {
-                    v.phase -= 1.0;
-                    wrapped = true;
-                }
-            }
-
-            outputBus.l[i] = sumL * voiceGain;
-            outputBus.r[i] = sumR * voiceGain;
-        }
-    }
-    else
+    for (int v = 0; v < numVoices; ++v)
     {
-        for (size_t i = 0; i < DSP::blockSize; ++i)
-        {
-            host_float modLeft = fmBus.l[i];
-            host_float modRight = fmBus.r[i];
-
-            host_float sumL = 0.0;
-            host_float sumR = 0.0;
-
-            for (auto &v : voices)
-            {
-                host_float voiceFreq = (frequency + drift) * (1.0 + v.detune_ratio);
-
-                // Modulation
-                host_float modSignal = (v.gainL > v.gainR) ? modLeft : modRight;
-
-                // Phase modulation
-                host_float modulatedPhase = v.phase + modulationIndex * modSignal;
-                modulatedPhase -= std::floor(modulatedPhase); // Wrap to [0, 1)
-
-                host_float index = modulatedPhase * selectedWaveTableSize;
-                size_t i0 = static_cast<size_t>(index);
-                size_t i1 = (i0 + 1) % selectedWaveTableSize;
-                host_float frac = index - i0;
+        unison.increment[v] = baseIncrement * (1.0 + voices[v].detune_ratio);
+    }
 
-                // Interpolation
-                host_float sample = (1.0 - frac) * (*selectedWaveTable)[i0] + frac * (*selectedWaveTable)[i1];
+    UnisonBlock block;
+    block.table = table.data();
+    block.mask = static_cast<uint32_t>(table.size() - 1);
+    block.size = static_cast<host_float>(table.size());
+    block.fmL = generatorRole == GeneratorRole::Normal ? nullptr : fmBus.l.data();
+    block.fmR = generatorRole == GeneratorRole::Normal ? nullptr : fmBus.r.data();
+    block.modIndex = modulationIndex;
+    block.outL = outputBus.l.data();
+    block.outR = outputBus.r.data();
+    block.numSamples = DSP::blockSize;
 
-                // Sum weighted
-                sumL += sample * v.amp_ratio * v.gainL;
-                sumR += sample * v.amp_ratio * v.gainR;
+    bool fade = levelCrossfade && selectedLevel != noLevel && level != selectedLevel;
 
-                // Advance phase
-                host_float inc = voiceFreq / DSP::sampleRate;
-                v.phase += inc;
+    if (fade)
+    {
+        // Render the block from the previous level as well, on a copy of the phases
+        const DSPSampleBuffer &previous = *wavetable->buffers[selectedLevel];
+        UnisonState state = unison;
+        UnisonBlock fadeBlock = block;
+
+        fadeBlock.table = previous.data();
+        fadeBlock.mask = static_cast<uint32_t>(previous.size() - 1);
+        fadeBlock.size = static_cast<host_float>(previous.size());
+        fadeBlock.outL = fadeL.data();
+        fadeBlock.outR = fadeR.data();
+
+        UnisonKernel::render(state, numVoices, fadeBlock);
+    }
 
-                if (v.phase >= 1.0)
-                {
-                    v.phase -= 1.0;
-                    wrapped = true;
-                }
-            }
+    if (UnisonKernel::render(unison, numVoices, block))
+    {
+        wrapped = true;
+    }
 
-            outputBus.l[i] = sumL * voiceGain;
-            outputBus.r[i] = sumR * voiceGain;
-        }
+    if (fade)
+    {
+        crossfadeLevels();
     }
+
+    selectedLevel = level;
 }
 
 // Next sample block generation one voice
@@ -378,189 +407,175 @@ static std::string absolutePath(const std::string &relativePath)
     }
 }
 
-void WavetableOscillator::acquireSharedWavetable()
+static std::string tableFileName(const std::string &waveformName)
+{
+    return "tables/" + waveformName + "_" + std::to_string(static_cast<int>(DSP::sampleRate));
+}
+
+const SharedWavetableSet *WavetableOscillator::acquireSharedWavetable()
 {
 #if DEBUG
     DSP::log("Loading wavetable for %s", waveformName.c_str());
 #endif
 
-    // Step 1: Already in cache?
+    std::lock_guard<std::mutex> lock(sharedWavetablesMutex);
+
+    uint32_t rate = static_cast<uint32_t>(DSP::sampleRate);
+
+    // Step 1: Already in cache? Tables of another sample rate alias or lack the top octave
     for (const auto &entry : sharedWavetables)
     {
-        if (entry.name == waveformName)
+        if (entry.name == waveformName && entry.sampleRate == rate)
         {
-            baseFrequencies = entry.baseFrequencies;
-            tableSizes = entry.tableSizes;
-            wavetableSampleBuffers = entry.buffers;
-
-            return;
+            return &entry;
         }
     }
 
-    // Step 2: Try to load
-    if (!load())
+    std::string fileName = tableFileName(waveformName);
+    std::shared_ptr<WavetableFile> file = std::make_shared<WavetableFile>();
+
+    // Step 2: Tables linked into the library for common rates
+    const EmbeddedWavetable *embedded = EmbeddedWavetables::find(waveformName, rate);
+
+    if (embedded && file->open(embedded->begin, static_cast<size_t>(embedded->end - embedded->begin), rate, tableVersion))
     {
 #if DEBUG
-        DSP::log("Wavetable for %s does not exist: generating...", waveformName.c_str());
+        DSP::log("Using embedded wavetable for %s", waveformName.c_str());
 #endif
+    }
+    // Step 3: Try to map the binary table file
+    else if (!load(*file))
+    {
+        std::vector<host_float> frequencies;
+        std::vector<std::vector<host_float>> tables;
 
-        wavetableCalcBuffers.clear();
+        // Step 4: Generate the tables
+#if DEBUG
+        DSP::log("Wavetable for %s does not exist: generating...", waveformName.c_str());
+#endif
+        generate(frequencies, tables);
 
-        // Prepare base frequencies and table sizes
-        baseFrequencies = {20.0, 40.0, 160.0, 640.0, 2560.0};
-        tableSizes = {1024, 2048, 4096, 8192, 16384};
+        createDir();
+        WavetableFile::write(fileName + ".akwt", rate, tableVersion, frequencies, tables);
 
-        for (size_t i = 0; i < tableSizes.size(); ++i)
+        if (!load(*file))
         {
-            size_t size = tableSizes[i];
-            host_float freq = baseFrequencies[i];
-
-            DSPBuffer *buffer = new DSPBuffer();
-            buffer->create(size);
-            createWavetable(*buffer, freq);
-            wavetableCalcBuffers.push_back(buffer);
+            DSP::log("Failed to load wavetable for %s after creation", waveformName.c_str());
+            return nullptr;
         }
-
-#if DEBUG
-        DSP::log("Wavetable for %s generated: saving...", waveformName.c_str());
-#endif
-        save();
-    }
-
-    // Step 3: Load final result
-    if (!load())
-    {
-        DSP::log("Failed to load wavetable for %s after creation", waveformName.c_str());
-        return;
     }
 
-    // Step 4: Register in shared set
+    // Step 5: Point the sample buffers into the mapping
     SharedWavetableSet newEntry;
     newEntry.name = waveformName;
-    newEntry.baseFrequencies = baseFrequencies;
-    newEntry.tableSizes = tableSizes;
-    newEntry.buffers = wavetableSampleBuffers;
+    newEntry.sampleRate = rate;
+    newEntry.file = file;
 
+    for (size_t i = 0; i < file->getNumTables(); ++i)
+    {
+        DSPSampleBuffer *buffer = new DSPSampleBuffer();
+        buffer->assign("buffer" + waveformName, const_cast<host_float *>(file->getTable(i)), file->getTableSize(i));
+
+        newEntry.baseFrequencies.push_back(file->getBaseFrequency(i));
+        newEntry.tableSizes.push_back(file->getTableSize(i));
+        newEntry.buffers.push_back(buffer);
+    }
+
+    // Step 6: Register in shared set
     sharedWavetables.push_back(newEntry);
 #if DEBUG
     DSP::log("Wavetable for %s cached globally", waveformName.c_str());
 #endif
+
+    return &sharedWavetables.back();
 }
 
-bool WavetableOscillator::load()
+bool WavetableOscillator::load(WavetableFile &file) const
 {
-    std::string fileName = "tables/" + waveformName + "_" + std::to_string(static_cast<int>(DSP::sampleRate)) + ".wave";
+    std::string fileName = tableFileName(waveformName) + ".akwt";
 #if DEBUG
     DSP::log("Try loading wavetable %s", absolutePath(fileName).c_str());
 #endif
 
-    std::ifstream inFile(fileName.c_str());
-    if (!inFile.is_open())
+    if (!file.open(fileName, static_cast<uint32_t>(DSP::sampleRate), tableVersion))
         return false;
 
-#if DEBUG
-    DSP::log("Found wavetable %s", absolutePath(fileName).c_str());
-#endif
-
-    wavetableSampleBuffers.clear();
-    baseFrequencies.clear();
-    tableSizes.clear();
-
-    std::string line;
-    while (std::getline(inFile, line))
+    // Table lookups wrap with a bit mask
+    for (size_t i = 0; i < file.getNumTables(); ++i)
     {
-        std::stringstream ss(line);
-        std::string item;
-
-        try
-        {
-            // Read frequency
-            if (!std::getline(ss, item, ','))
-                continue;
-
-            host_float freq = std::stod(item);
-
-            // Read size
-            if (!std::getline(ss, item, ','))
-                continue;
-
-            size_t size = static_cast<size_t>(std::stoul(item));
-
-            DSPSampleBuffer *buffer = new DSPSampleBuffer();
-
-            buffer->initialize("buffer" + getName(), size);
-
-            // Read data
-            size_t sampleCount = 0;
-
-            while (std::getline(ss, item, ',') && sampleCount < size)
-            {
-                (*buffer)[sampleCount++] = static_cast<host_float>(std::stod(item));
-            }
-
-            if (sampleCount != size)
-            {
-                DSP::log("Invalid format in wavetable %s", absolutePath(fileName).c_str());
-                return false;
-            }
+        size_t size = file.getTableSize(i);
 
-            baseFrequencies.push_back(freq);
-            tableSizes.push_back(size);
-            wavetableSampleBuffers.push_back(buffer);
-        }
-        catch (const std::exception &ex)
+        if ((size & (size - 1)) != 0)
         {
-            DSP::log("Error generating wave forms from wavetable %s (%s)", absolutePath(fileName), ex.what());
-            return false;
-        }
-        catch (...)
-        {
-            DSP::log("Error reading wavetable %s", absolutePath(fileName).c_str());
+            DSP::log("Table size %zu in wavetable %s is not a power of two", size, absolutePath(fileName).c_str());
+            file.close();
             return false;
         }
     }
+
 #if DEBUG
     DSP::log("Wavetable %s loaded", absolutePath(fileName).c_str());
 #endif
 
-    return !wavetableSampleBuffers.empty();
+    return true;
 }
 
-void WavetableOscillator::save() const
+void WavetableOscillator::generate(std::vector<host_float> &frequencies, std::vector<std::vector<host_float>> &tables)
 {
-    createDir();
+    DSPThreadPool pool;
+    pool.initialize(std::max(1u, std::thread::hardware_concurrency()));
 
-    std::string fileName = "tables/" + waveformName + "_" + std::to_string(static_cast<int>(DSP::sampleRate)) + ".wave";
-    std::ofstream outFile(fileName.c_str());
+    generate(frequencies, tables, pool);
+    pool.wait();
+}
+
+void WavetableOscillator::generate(std::vector<host_float> &frequencies, std::vector<std::vector<host_float>> &tables, DSPThreadPool &pool)
+{
+    // One level per octave up to Nyquist, each level is band-limited for the top of its
+    // octave and sized for about four samples per cycle of its highest harmonic
+    // The pool threads have no engine bound, the tasks get the rate of the caller
+    dsp_float rate = DSP::sampleRate;
+    host_float nyquist = 0.5 * rate;
+
+    baseFrequencies.clear();
+    tableSizes.clear();
 
-    if (!outFile.is_open())
+    for (host_float freq = lowestFrequency; freq < nyquist; freq *= 2.0)
     {
-        DSP::log("Wavetable %s does not exist", absolutePath(fileName).c_str());
-        return;
+        host_float harmonics = nyquist / (2.0 * freq);
+        size_t size = minTableSize;
+
+        while (size < 4.0 * harmonics && size < maxTableSize)
+            size <<= 1;
+
+        baseFrequencies.push_back(freq);
+        tableSizes.push_back(size);
     }
 
-    try
+    frequencies = baseFrequencies;
+    tables.assign(tableSizes.size(), std::vector<host_float>());
+
+    // Levels are independent, each task fills its own table
+    for (size_t i = 0; i < tableSizes.size(); ++i)
     {
-        for (size_t i = 0; i < wavetableCalcBuffers.size(); ++i)
-        {
-            const DSPBuffer &buffer = *wavetableCalcBuffers[i];
-            outFile << baseFrequencies[i] << "," << buffer.size();
+        std::vector<host_float> *table = &tables[i];
+        size_t size = tableSizes[i];
+        host_float freq = std::min(static_cast<host_float>(2.0 * baseFrequencies[i]), nyquist);
 
-            for (size_t j = 0; j < buffer.size(); ++j)
+        pool.execute(
+            [this, table, size, freq, rate]()
             {
-                outFile << "," << buffer[j];
-            }
+                DSPBuffer buffer;
+                buffer.create(size);
+                createWavetable(buffer, freq, rate);
 
-            outFile << "\n";
-        }
-    }
-    catch (const std::exception &ex)
-    {
-        DSP::log("Error writing wave form to wavetable %s (%s)", absolutePath(fileName).c_str(), ex.what());
-    }
-    catch (...)
-    {
-        DSP::log("Error writung wave form to wavetable %s", absolutePath(fileName).c_str());
+                table->resize(size);
+
+                for (size_t j = 0; j < size; ++j)
+                {
+                    (*table)[j] = static_cast<host_float>(buffer[j]);
+                }
+            });
     }
 }
 
@@ -0,0 +1,155 @@
+// wtgen.cpp - Build-time wavetable generator for libaudiokern
+//
+// Generates the tables of every wavetable oscillator for the given sample
+// rates on all cores and writes, into the output directory:
+//
+//     <name>_<rate>.akwt             one binary table set per waveform and rate
+//     EmbeddedWavetableData.S        the sets as read-only data (.incbin)
+//     EmbeddedWavetableDirectory.cpp the EmbeddedWavetables directory
+//
+// Usage: wtgen <outdir> <rate>...
+//
+// Assemble the data with the output directory on the assembler include path
+// (-Wa,-I<outdir>) and archive both objects into the library.
+
+#include "DSP.h"
+#include "DSPThreadPool.h"
+#include "EmbeddedWavetables.h"
+#include "WavetableFile.h"
+#include "BitWavetable.h"
+#include "FibonacciWavetable.h"
+#include "HarmonicClusterWavetable.h"
+#include "MirrorWavetable.h"
+#include "ModuloWavetable.h"
+#include "SawWavetable.h"
+#include "SineWavetable.h"
+#include "SquareWavetable.h"
+#include "TriangleWavetable.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The generator is linked against the library objects without a directory of its own
+const EmbeddedWavetable EmbeddedWavetables::entries[] = {{"", 0, nullptr, nullptr}};
+const size_t EmbeddedWavetables::numEntries = 0;
+
+static void generatorLogger(const std::string &msg)
+{
+    std::fprintf(stderr, "%s\n", msg.c_str());
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::fprintf(stderr, "usage: %s <outdir> <rate>...\n", argv[0]);
+        return 1;
+    }
+
+    DSP::registerLogger(&generatorLogger);
+
+    std::string outDir = argv[1];
+
+    std::vector<std::unique_ptr<WavetableOscillator>> oscillators;
+    oscillators.emplace_back(new BitWavetable());
+    oscillators.emplace_back(new FibonacciWavetable());
+    oscillators.emplace_back(new HarmonicClusterWavetable());
+    oscillators.emplace_back(new MirrorWavetable());
+    oscillators.emplace_back(new ModuloWavetable());
+    oscillators.emplace_back(new SawWavetable());
+    oscillators.emplace_back(new SineWavetable());
+    oscillators.emplace_back(new SquareWavetable());
+    oscillators.emplace_back(new TriangleWavetable());
+
+    DSPThreadPool pool;
+    pool.initialize(std::max(1u, std::thread::hardware_concurrency()));
+
+    std::string data = "// Generated by wtgen, do not edit\n";
+    std::string directory = "// Generated by wtgen, do not edit\n\n#include \"EmbeddedWavetables.h\"\n\n";
+    std::string entries;
+    size_t numEntries = 0;
+
+    data += "\t.section .rodata\n";
+
+    for (int i = 2; i < argc; ++i)
+    {
+        uint32_t rate = static_cast<uint32_t>(std::strtoul(argv[i], nullptr, 10));
+
+        if (rate == 0)
+        {
+            std::fprintf(stderr, "wtgen: invalid sample rate %s\n", argv[i]);
+            return 1;
+        }
+
+        DSP::sampleRate = rate;
+
+        // All levels of all waveforms at once, generate() hands the rate to the tasks
+        std::vector<std::vector<host_float>> frequencies(oscillators.size());
+        std::vector<std::vector<std::vector<host_float>>> tables(oscillators.size());
+
+        for (size_t j = 0; j < oscillators.size(); ++j)
+        {
+            oscillators[j]->generate(frequencies[j], tables[j], pool);
+        }
+
+        pool.wait();
+
+        for (size_t j = 0; j < oscillators.size(); ++j)
+        {
+            WavetableOscillator *osc = oscillators[j].get();
+
+            std::string id = osc->getWaveformName() + "_" + std::to_string(rate);
+            std::string fileName = id + ".akwt";
+
+            if (!WavetableFile::write(outDir + "/" + fileName, rate, WavetableOscillator::tableVersion, frequencies[j], tables[j]))
+                return 1;
+
+            // Table data inside the image is aligned relative to its start
+            data += "\t.balign 64\n";
+            data += "\t.global akwt_" + id + "\n";
+            data += "\t.hidden akwt_" + id + "\n";
+            data += "akwt_" + id + ":\n";
+            data += "\t.incbin \"" + fileName + "\"\n";
+            data += "\t.global akwt_" + id + "_end\n";
+            data += "\t.hidden akwt_" + id + "_end\n";
+            data += "akwt_" + id + "_end:\n";
+
+            directory += "extern \"C\" const uint8_t akwt_" + id + "[];\n";
+            directory += "extern \"C\" const uint8_t akwt_" + id + "_end[];\n";
+
+            entries += "    {\"" + osc->getWaveformName() + "\", " + std::to_string(rate) + ", akwt_" + id + ", akwt_" + id + "_end},\n";
+            ++numEntries;
+
+            std::printf("wtgen: %s\n", fileName.c_str());
+        }
+    }
+
+    // No executable stack for the data object
+    data += "\t.section .note.GNU-stack,\"\",%progbits\n";
+
+    directory += "\nconst EmbeddedWavetable EmbeddedWavetables::entries[] = {\n" + entries + "};\n\n";
+    directory += "const size_t EmbeddedWavetables::numEntries = " + std::to_string(numEntries) + ";\n";
+
+    FILE *file = std::fopen((outDir + "/EmbeddedWavetableData.S").c_str(), "w");
+
+    if (!file || std::fputs(data.c_str(), file) < 0 || std::fclose(file) != 0)
+    {
+        std::fprintf(stderr, "wtgen: cannot write EmbeddedWavetableData.S\n");
+        return 1;
+    }
+
+    file = std::fopen((outDir + "/EmbeddedWavetableDirectory.cpp").c_str(), "w");
+
+    if (!file || std::fputs(directory.c_str(), file) < 0 || std::fclose(file) != 0)
+    {
+        std::fprintf(stderr, "wtgen: cannot write EmbeddedWavetableDirectory.cpp\n");
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,667 @@
+// jpbench.cpp - Headless offline renderer and throughput benchmark for JPSynth
+//
+// Drives the JPSynth DSP graph without Pure Data: the synth is bound to plain
+// in-memory output buffers, a scripted note/parameter timeline is rendered
+// block by block and every call to JPSynth::process() is timed.
+//
+// Usage: jpbench [-r rate] [-b blocksize] [-s seconds] [-f script] [-C dir] [-o out.raw] [-n instances] [-v voices] [-S] [-L] [-d] [-p] [-q]
+//
+// Timeline script format (one event per line, '#' starts a comment):
+//
+//     <time_ms> <command> [args...]
+//
+//     0     carrier 1
+//     0     note 60 1
+//     1500  cutoff 800
+//     2000  note 60 0
+//
+// Events are applied at the sample of their time stamp.
+//
+// The blocks after the last event are reported separately as the tail, where
+// reverb, delay and filter states decay. Run with and without -d to compare
+// the tail with subnormal floats flushed to zero (the default) and kept.
+
+#include "DSP.h"
+#include "DSPBusManager.h"
+#include "DSPEngine.h"
+#include "DSPProfiler.h"
+#include "JPSynth.h"
+#include "FilterLaneKernel.h"
+#include "UnisonKernel.h"
+#include "dsp_types.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+/**
+ * @brief A single timeline event, applied before rendering the block that contains it.
+ */
+struct BenchEvent
+{
+    double timeMs;                 ///< Event time in milliseconds
+    std::string command;           ///< Command name (see applyEvent)
+    std::vector<host_float> args;  ///< Numeric arguments
+    int line;                      ///< Script line for diagnostics
+};
+
+/**
+ * @brief Command line options.
+ */
+struct BenchOptions
+{
+    dsp_float sampleRate = 48000.0;
+    size_t blockSize = 64;
+    double seconds = 10.0;
+    std::string scriptFile;
+    std::string workDir;
+    std::string outFile;
+    bool quiet = false;
+    bool profile = false;
+    size_t threads = 0;
+    size_t instances = 1;
+    size_t polyphony = JPSynth::defaultPolyphony;
+    bool stealTail = false;
+    bool voiceBatching = true;
+    bool keepDenormals = false;
+};
+
+/**
+ * @brief One synthesizer in an engine of its own, rendered by its own thread.
+ */
+struct BenchInstance
+{
+    DSPEngine engine;
+    JPSynth synth{engine};
+    std::vector<double> blockNs; ///< Render time per block
+    double peak = 0.0;
+    double sumSquares = 0.0;
+};
+
+// Built-in timeline: a sustained chord with filter, oscillator and effect
+// changes so most of the graph is exercised
+static const char *defaultTimeline =
+    "0     carrier 1\n"
+    "0     modulator 4\n"
+    "0     oscmix 0.5\n"
+    "0     modidx 0.2\n"
+    "0     nov 5\n"
+    "0     detune 0.3\n"
+    "0     cutoff 2500\n"
+    "0     reso 0.3\n"
+    "0     ampadsr 10 200 0.8 500 0.5 0.5\n"
+    "0     filteradsr 5 300 0.5 400 0.5 0.5\n"
+    "0     revroom 0.6\n"
+    "0     revwet 0.3\n"
+    "0     delaytime 250 375\n"
+    "0     delayfb 0.4 0.4\n"
+    "0     delaywet 0.2\n"
+    "0     wet 1\n"
+    "0     note 48 1\n"
+    "0     note 55 0.9\n"
+    "0     note 60 0.8\n"
+    "0     note 64 0.8\n"
+    "0     note 67 0.7\n"
+    "0     note 71 0.7\n"
+    "1000  cutoff 800\n"
+    "2000  carrier 2\n"
+    "2500  note 48 0\n"
+    "2500  note 55 0\n"
+    "2500  note 60 0\n"
+    "2500  note 64 0\n"
+    "2500  note 67 0\n"
+    "2500  note 71 0\n"
+    "3000  note 50 1\n"
+    "3000  note 57 1\n"
+    "3000  note 62 1\n"
+    "3000  note 65 1\n"
+    "3000  note 69 1\n"
+    "3000  note 72 1\n"
+    "4000  modidx 0.6\n"
+    "5000  sync 1\n"
+    "6000  cutoff 5000\n"
+    "7000  note 50 0\n"
+    "7000  note 57 0\n"
+    "7000  note 62 0\n"
+    "7000  note 65 0\n"
+    "7000  note 69 0\n"
+    "7000  note 72 0\n";
+
+static void benchLogger(const std::string &msg)
+{
+    std::fprintf(stderr, "%s\n", msg.c_str());
+}
+
+static void silentLogger(const std::string &)
+{
+}
+
+static void usage(const char *prog)
+{
+    std::fprintf(stderr,
+                 "usage: %s [-r rate] [-b blocksize] [-s seconds] [-f script] [-C dir] [-o out.raw] [-t threads] [-n instances] [-v voices] [-S] [-L] [-d] [-p] [-q]\n"
+                 "  -r  sample rate in Hz (default 48000)\n"
+                 "  -b  host block size in samples, any length (default 64)\n"
+                 "  -s  seconds to render (default 10)\n"
+                 "  -f  timeline script, uses the built-in timeline if omitted\n"
+                 "  -C  working directory containing tables/\n"
+                 "  -o  write interleaved stereo float32 output to file\n"
+                 "  -t  rendering threads including the caller, 0 = automatic (default 0)\n"
+                 "  -n  independent synth instances rendered in parallel, one thread each (default 1)\n"
+                 "  -v  polyphony, 1 to %zu (default %zu)\n"
+                 "  -S  fade stolen voices out as a short tail instead of retriggering them\n"
+                 "  -L  render each voice as one node instead of batching the filters in SIMD lanes\n"
+                 "  -d  keep subnormal floats instead of flushing them to zero (FTZ/DAZ)\n"
+                 "  -p  profile every DSP object and print the report\n"
+                 "  -q  suppress DSP log output\n",
+                 prog, JPSynth::maxPolyphony, JPSynth::defaultPolyphony);
+}
+
+static bool parseOptions(int argc, char **argv, BenchOptions &opts)
+{
+    int c;
+
+    while ((c = getopt(argc, argv, "r:b:s:f:C:o:t:n:v:SLdpqh")) != -1)
+    {
+        switch (c)
+        {
+        case 'r':
+            opts.sampleRate = std::atof(optarg);
+            break;
+        case 'b':
+            opts.blockSize = static_cast<size_t>(std::atol(optarg));
+            break;
+        case 's':
+            opts.seconds = std::atof(optarg);
+            break;
+        case 'f':
+            opts.scriptFile = optarg;
+            break;
+        case 'C':
+            opts.workDir = optarg;
+            break;
+        case 'o':
+            opts.outFile = optarg;
+            break;
+        case 't':
+            opts.threads = static_cast<size_t>(std::atol(optarg));
+            break;
+        case 'n':
+            opts.instances = static_cast<size_t>(std::atol(optarg));
+            break;
+        case 'v':
+            opts.polyphony = static_cast<size_t>(std::atol(optarg));
+            break;
+        case 'S':
+            opts.stealTail = true;
+            break;
+        case 'L':
+            opts.voiceBatching = false;
+            break;
+        case 'd':
+            opts.keepDenormals = true;
+            break;
+        case 'p':
+            opts.profile = true;
+            break;
+        case 'q':
+            opts.quiet = true;
+            break;
+        default:
+            return false;
+        }
+    }
+
+    if (opts.sampleRate <= 0.0 || opts.blockSize == 0 || opts.seconds <= 0.0 || opts.instances == 0)
+    {
+        std::fprintf(stderr, "jpbench: rate, block size, duration and instances must be positive\n");
+        return false;
+    }
+
+    return true;
+}
+
+// Commands of the timeline and the number of arguments they expect
+static const struct
+{
+    const char *name;
+    size_t numArgs;
+} benchCommands[] = {
+    {"note", 2}, {"carrier", 1}, {"modulator", 1}, {"oscmix", 1}, {"noisemix", 1},
+    {"modidx", 1}, {"detune", 1}, {"pitch", 1}, {"bend", 1}, {"nov", 1},
+    {"sync", 1}, {"cutoff", 1}, {"reso", 1}, {"drive", 1}, {"ampadsr", 6},
+    {"filteradsr", 6}, {"revroom", 1}, {"revspace", 1}, {"revdamp", 1}, {"revdensity", 1},
+    {"revwet", 1}, {"delaytime", 2}, {"delayfb", 2}, {"delaywet", 1}, {"distwet", 1},
+    {"distdrive", 1}, {"wet", 1}};
+
+// Matches the command first, then checks its arguments, one message per bad line
+static bool checkEvent(const BenchEvent &ev)
+{
+    for (const auto &command : benchCommands)
+    {
+        if (ev.command != command.name)
+            continue;
+
+        if (ev.args.size() < command.numArgs)
+        {
+            std::fprintf(stderr, "jpbench: line %d: '%s' expects %zu argument(s)\n",
+                         ev.line, ev.command.c_str(), command.numArgs);
+            return false;
+        }
+
+        return true;
+    }
+
+    std::fprintf(stderr, "jpbench: line %d: unknown command '%s'\n", ev.line, ev.command.c_str());
+    return false;
+}
+
+static bool parseTimeline(std::istream &in, std::vector<BenchEvent> &events)
+{
+    std::string line;
+    int lineNo = 0;
+
+    while (std::getline(in, line))
+    {
+        ++lineNo;
+
+        size_t hash = line.find('#');
+        if (hash != std::string::npos)
+            line.erase(hash);
+
+        std::istringstream ss(line);
+        BenchEvent ev;
+
+        if (!(ss >> ev.timeMs))
+            continue;
+
+        if (!(ss >> ev.command))
+        {
+            std::fprintf(stderr, "jpbench: line %d: missing command\n", lineNo);
+            return false;
+        }
+
+        host_float v;
+        while (ss >> v)
+            ev.args.push_back(v);
+
+        ev.line = lineNo;
+
+        // A broken script fails the run before anything is rendered
+        if (!checkEvent(ev))
+            return false;
+
+        events.push_back(ev);
+    }
+
+    std::stable_sort(events.begin(), events.end(),
+                     [](const BenchEvent &a, const BenchEvent &b)
+                     { return a.timeMs < b.timeMs; });
+
+    return true;
+}
+
+static ADSRParams toADSR(const BenchEvent &ev)
+{
+    ADSRParams adsr;
+
+    adsr.attackTime = ev.args[0];
+    adsr.decayTime = ev.args[1];
+    adsr.sustainLevel = ev.args[2];
+    adsr.releaseTime = ev.args[3];
+    adsr.attackShape = ev.args[4];
+    adsr.releaseShape = ev.args[5];
+
+    return adsr;
+}
+
+// Applies one timeline event checked by checkEvent(), the numbering of oscillator types follows jpsynth~
+static void applyEvent(JPSynth &synth, const BenchEvent &ev)
+{
+    const std::string &cmd = ev.command;
+    const std::vector<host_float> &a = ev.args;
+
+    if (cmd == "note")
+    {
+        synth.noteIn(static_cast<int>(a[0]), a[1]);
+    }
+    else if (cmd == "carrier")
+    {
+        static const CarrierOscillatiorType types[] = {
+            CarrierOscillatiorType::Saw, CarrierOscillatiorType::Square,
+            CarrierOscillatiorType::Triangle, CarrierOscillatiorType::Sine,
+            CarrierOscillatiorType::Cluster, CarrierOscillatiorType::Fibonacci,
+            CarrierOscillatiorType::Mirror, CarrierOscillatiorType::Modulo};
+
+        int idx = static_cast<int>(a[0]) - 1;
+        synth.setCarrierOscillatorType(idx >= 0 && idx < 8 ? types[idx] : CarrierOscillatiorType::Saw);
+    }
+    else if (cmd == "modulator")
+    {
+        static const ModulatorOscillatorType types[] = {
+            ModulatorOscillatorType::Saw, ModulatorOscillatorType::Square,
+            ModulatorOscillatorType::Triangle, ModulatorOscillatorType::Sine,
+            ModulatorOscillatorType::Cluster, ModulatorOscillatorType::Fibonacci,
+            ModulatorOscillatorType::Mirror, ModulatorOscillatorType::Modulo,
+            ModulatorOscillatorType::Bit};
+
+        int idx = static_cast<int>(a[0]) - 1;
+        synth.setModulatorOscillatorType(idx >= 0 && idx < 9 ? types[idx] : ModulatorOscillatorType::Sine);
+    }
+    else if (cmd == "oscmix")
+        synth.setOscillatorMix(a[0]);
+    else if (cmd == "noisemix")
+        synth.setNoiseMix(a[0]);
+    else if (cmd == "modidx")
+        synth.setModulation(a[0]);
+    else if (cmd == "detune")
+        synth.setDetune(a[0]);
+    else if (cmd == "pitch")
+        synth.setPitchOffset(a[0]);
+    else if (cmd == "bend")
+        synth.setPitchBend(a[0]);
+    else if (cmd == "nov")
+        synth.setNumVoices(static_cast<int>(a[0]));
+    else if (cmd == "sync")
+        synth.setSyncEnabled(a[0] != 0);
+    else if (cmd == "cutoff")
+        synth.setFilterCutoff(a[0]);
+    else if (cmd == "reso")
+        synth.setFilterResonance(a[0]);
+    else if (cmd == "drive")
+        synth.setFilterDrive(a[0]);
+    else if (cmd == "ampadsr")
+        synth.setAmpADSR(toADSR(ev));
+    else if (cmd == "filteradsr")
+        synth.setFilterADSR(toADSR(ev));
+    else if (cmd == "revroom")
+        synth.setReverbRoom(a[0]);
+    else if (cmd == "revspace")
+        synth.setReverbSpace(a[0]);
+    else if (cmd == "revdamp")
+        synth.setReverbDamping(a[0]);
+    else if (cmd == "revdensity")
+        synth.setReverbDensity(a[0]);
+    else if (cmd == "revwet")
+        synth.setReverbWet(a[0]);
+    else if (cmd == "delaytime")
+        synth.setDelayTime(a[0], a[1]);
+    else if (cmd == "delayfb")
+        synth.setDelayFeedback(a[0], a[1]);
+    else if (cmd == "delaywet")
+        synth.setDelayWet(a[0]);
+    else if (cmd == "distwet")
+        synth.setDistWet(a[0]);
+    else if (cmd == "distdrive")
+        synth.setDistDrive(a[0]);
+    else if (cmd == "wet")
+        synth.setWet(a[0]);
+}
+
+// Renders the timeline with one instance, writes the output if out is given
+static void render(BenchInstance &instance, const std::vector<BenchEvent> &events, const BenchOptions &opts, size_t numBlocks, FILE *out)
+{
+    using clock = std::chrono::steady_clock;
+
+    JPSynth &synth = instance.synth;
+
+    // Output buffers stand in for the host signal vectors
+    std::vector<host_float> outL(opts.blockSize, 0.0);
+    std::vector<host_float> outR(opts.blockSize, 0.0);
+
+    instance.blockNs.assign(numBlocks, 0.0);
+
+    std::vector<float> interleaved(out ? opts.blockSize * 2 : 0);
+
+    size_t nextEvent = 0;
+
+    for (size_t block = 0; block < numBlocks; ++block)
+    {
+        double blockStartMs = 1000.0 * static_cast<double>(block * opts.blockSize) / opts.sampleRate;
+        double blockEndMs = 1000.0 * static_cast<double>((block + 1) * opts.blockSize) / opts.sampleRate;
+
+        // Events take effect at their sample inside the block
+        while (nextEvent < events.size() && events[nextEvent].timeMs < blockEndMs)
+        {
+            double offset = std::round((events[nextEvent].timeMs - blockStartMs) * opts.sampleRate / 1000.0);
+
+            synth.setEventOffset(static_cast<uint32_t>(std::clamp(offset, 0.0, static_cast<double>(opts.blockSize - 1))));
+            applyEvent(synth, events[nextEvent++]);
+        }
+
+        synth.setEventOffset(0);
+
+        clock::time_point t0 = clock::now();
+        synth.process(outL.data(), outR.data(), opts.blockSize);
+        clock::time_point t1 = clock::now();
+
+        instance.blockNs[block] = std::chrono::duration<double, std::nano>(t1 - t0).count();
+
+        for (size_t i = 0; i < opts.blockSize; ++i)
+        {
+            double l = outL[i];
+            double r = outR[i];
+
+            instance.peak = std::max(instance.peak, std::max(std::fabs(l), std::fabs(r)));
+            instance.sumSquares += l * l + r * r;
+        }
+
+        if (out)
+        {
+            for (size_t i = 0; i < opts.blockSize; ++i)
+            {
+                interleaved[2 * i] = static_cast<float>(outL[i]);
+                interleaved[2 * i + 1] = static_cast<float>(outR[i]);
+            }
+
+            std::fwrite(interleaved.data(), sizeof(float), interleaved.size(), out);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    BenchOptions opts;
+
+    if (!parseOptions(argc, argv, opts))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    if (!opts.workDir.empty() && chdir(opts.workDir.c_str()) != 0)
+    {
+        std::fprintf(stderr, "jpbench: cannot change to directory %s\n", opts.workDir.c_str());
+        return 1;
+    }
+
+    // Timeline
+    std::vector<BenchEvent> events;
+
+    if (opts.scriptFile.empty())
+    {
+        std::istringstream in(defaultTimeline);
+        parseTimeline(in, events);
+    }
+    else
+    {
+        std::ifstream in(opts.scriptFile);
+
+        if (!in.is_open())
+        {
+            std::fprintf(stderr, "jpbench: cannot open script %s\n", opts.scriptFile.c_str());
+            return 1;
+        }
+
+        if (!parseTimeline(in, events))
+            return 1;
+    }
+
+    DSP::registerLogger(opts.quiet ? &silentLogger : &benchLogger);
+
+    using clock = std::chrono::steady_clock;
+
+    clock::time_point initStart = clock::now();
+
+    std::vector<std::unique_ptr<BenchInstance>> instances;
+
+    for (size_t i = 0; i < opts.instances; ++i)
+    {
+        instances.emplace_back(new BenchInstance());
+        BenchInstance &instance = *instances.back();
+
+        instance.engine.setFlushDenormals(!opts.keepDenormals);
+
+        // The host block size is free, the synth renders fixed sub-blocks
+        {
+            DSPEngine::Scope scope(instance.engine);
+            DSP::initializeAudio(opts.sampleRate, DSP::subBlockSize);
+        }
+
+        instance.synth.setThreadCount(opts.threads);
+        instance.synth.setPolyphony(opts.polyphony);
+        instance.synth.setVoiceBatching(opts.voiceBatching);
+        instance.synth.initialize();
+        instance.synth.setVoiceStealMode(opts.stealTail ? VoiceStealMode::Tail : VoiceStealMode::Retrigger);
+    }
+
+    double initMs = std::chrono::duration<double, std::milli>(clock::now() - initStart).count();
+
+    size_t totalSamples = static_cast<size_t>(opts.seconds * opts.sampleRate);
+    size_t numBlocks = (totalSamples + opts.blockSize - 1) / opts.blockSize;
+
+    FILE *out = nullptr;
+
+    if (!opts.outFile.empty())
+    {
+        out = std::fopen(opts.outFile.c_str(), "wb");
+
+        if (!out)
+        {
+            std::fprintf(stderr, "jpbench: cannot open output %s\n", opts.outFile.c_str());
+            return 1;
+        }
+    }
+
+    if (opts.profile)
+    {
+        DSPProfiler::enable(true);
+
+        // Figures are kept per engine, start every instance from zero
+        for (const auto &instance : instances)
+        {
+            DSPEngine::Scope scope(instance->engine);
+            DSPProfiler::reset();
+        }
+    }
+
+    // Further instances render on threads of their own, the first one on this thread
+    std::vector<std::thread> threads;
+
+    for (size_t i = 1; i < instances.size(); ++i)
+    {
+        BenchInstance *instance = instances[i].get();
+
+        threads.emplace_back(
+            [instance, &events, &opts, numBlocks]()
+            {
+                render(*instance, events, opts, numBlocks, nullptr);
+            });
+    }
+
+    render(*instances[0], events, opts, numBlocks, out);
+
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+
+    if (out)
+        std::fclose(out);
+
+    // Statistics of the first instance
+    const std::vector<double> &blockNs = instances[0]->blockNs;
+    double peak = instances[0]->peak;
+    double sumSquares = instances[0]->sumSquares;
+    double totalNs = 0.0;
+    for (double ns : blockNs)
+        totalNs += ns;
+
+    std::vector<double> sorted(blockNs);
+    std::sort(sorted.begin(), sorted.end());
+
+    double renderedSamples = static_cast<double>(numBlocks * opts.blockSize);
+    double audioNs = 1e9 * renderedSamples / opts.sampleRate;
+    double blockBudgetNs = 1e9 * static_cast<double>(opts.blockSize) / opts.sampleRate;
+    size_t p99Index = std::min(sorted.size() - 1, static_cast<size_t>(0.99 * static_cast<double>(sorted.size())));
+    size_t overruns = static_cast<size_t>(std::count_if(blockNs.begin(), blockNs.end(),
+                                                        [blockBudgetNs](double ns)
+                                                        { return ns > blockBudgetNs; }));
+
+    std::printf("jpbench: %.0f Hz, block %zu, %zu blocks (%.2f s audio)\n",
+                opts.sampleRate, opts.blockSize, numBlocks, renderedSamples / opts.sampleRate);
+    std::printf("  instances        %10zu\n", instances.size());
+    std::printf("  voices           %10zu\n", instances[0]->synth.getPolyphony());
+    std::printf("  voice stealing   %10s\n", opts.stealTail ? "tail" : "retrigger");
+    std::printf("  init             %10.2f ms\n", initMs);
+    std::printf("  unison kernel    %10s\n", UnisonKernel::getName());
+    std::printf("  filter lanes     %10s\n", opts.voiceBatching ? FilterLaneKernel::getName() : "off");
+    std::printf("  render           %10.2f ms\n", totalNs / 1e6);
+    std::printf("  per sample       %10.2f ns\n", totalNs / renderedSamples);
+    std::printf("  real-time factor %10.4f (%.1fx faster than real time)\n", totalNs / audioNs, audioNs / totalNs);
+    std::printf("  block budget     %10.0f ns\n", blockBudgetNs);
+    std::printf("  block min        %10.0f ns\n", sorted.front());
+    std::printf("  block avg        %10.0f ns\n", totalNs / static_cast<double>(numBlocks));
+    std::printf("  block p99        %10.0f ns\n", sorted[p99Index]);
+    std::printf("  block max        %10.0f ns\n", sorted.back());
+    std::printf("  overruns         %10zu\n", overruns);
+
+    // Blocks that start after the last event, only the decay of the sound is left
+    double lastEventMs = events.empty() ? 0.0 : events.back().timeMs;
+    size_t tailStart = static_cast<size_t>(std::ceil(lastEventMs * opts.sampleRate / 1000.0 / static_cast<double>(opts.blockSize)));
+
+    std::printf("  denormals        %10s\n", opts.keepDenormals ? "kept" : "flushed");
+
+    if (tailStart < numBlocks)
+    {
+        double tailNs = 0.0;
+        for (size_t block = tailStart; block < numBlocks; ++block)
+            tailNs += blockNs[block];
+
+        double tailAvgNs = tailNs / static_cast<double>(numBlocks - tailStart);
+        double headAvgNs = tailStart > 0 ? (totalNs - tailNs) / static_cast<double>(tailStart) : tailAvgNs;
+
+        std::printf("  tail avg         %10.0f ns (after %.0f ms, %.2fx the blocks before)\n",
+                    tailAvgNs, lastEventMs, tailAvgNs / headAvgNs);
+    }
+
+    std::printf("  output peak      %10.4f\n", peak);
+    std::printf("  output rms       %10.4f\n", std::sqrt(sumSquares / (2.0 * renderedSamples)));
+
+    if (opts.profile)
+    {
+        // The report goes through DSP::log, so it is printed even with -q
+        DSP::registerLogger(&benchLogger);
+
+        for (size_t i = 0; i < instances.size(); ++i)
+        {
+            if (instances.size() > 1)
+                DSP::log("Instance %zu:", i + 1);
+
+            DSPEngine::Scope scope(instances[i]->engine);
+            DSPProfiler::log(40);
+        }
+    }
+
+    return 0;
+}
@@ -1,6 +1,8 @@
 #pragma once
 
-#include "DSPThreadPool.h"
+#include "DSPDispatcher.h"
+#include "DSPEngine.h"
+#include "DSPGraph.h"
 #include "JPVoice.h"
 #include "DSPSampleBuffer.h"
 #include "Mixer.h"
@@ -16,6 +18,9 @@
 #include "AnalogDrift.h"
 #include "Panner.h"
 #include "Distortion.h"
+#include "DSPSpscRing.h"
+#include <atomic>
+#include <cstdint>
 
 /**
  * @brief Lightweight structure representing a single active synth voice.
@@ -60,6 +65,88 @@ struct LFOParams
     LFOTarget target;     ///< LFO target paramter
 };
 
+/**
+ * @brief Note or parameter change passed from the control thread to the audio thread.
+ *
+ * Every setter of JPSynth has its own event type. Within one block only the
+ * last event of a parameter type is applied, note events are all applied.
+ */
+enum class JPEventType : uint8_t
+{
+    None, ///< Superseded by a later event of the same type
+    Note,
+    OscillatorMix,
+    NoiseMix,
+    PitchOffset,
+    FineTune,
+    Detune,
+    CarrierOscillatorType,
+    ModulatorOscillatorType,
+    NoiseType,
+    Modulation,
+    PitchBend,
+    NumVoices,
+    SyncEnabled,
+    FeedbackCarrier,
+    FeedbackModulator,
+    FilterCutoff,
+    FilterResonance,
+    FilterDrive,
+    FilterMode,
+    FilterFollow,
+    FilterADSR,
+    AmpADSR,
+    LinkADSR,
+    ADSROneshot,
+    LFO1,
+    LFO2,
+    ReverbSpace,
+    ReverbRoom,
+    ReverbDamping,
+    ReverbDensity,
+    ReverbTimeRatio,
+    ReverbWet,
+    DelayTime,
+    DelayFeedback,
+    DelayTimeRatio,
+    DelayWet,
+    DistWet,
+    DistDrive,
+    DistGain,
+    DistTone,
+    DistType,
+    Wet,
+    AnalogDrift,
+    Polyphony,
+    VoiceStealMode,
+    Count ///< Number of event types
+};
+
+/**
+ * @brief A timestamped event record, copied through a lock-free queue.
+ */
+struct JPEvent
+{
+    /** @brief Arguments of a note event. */
+    struct NoteArgs
+    {
+        int note;            ///< MIDI note
+        host_float velocity; ///< Velocity, 0 releases the note
+    };
+
+    JPEventType type; ///< What the event changes
+    uint32_t offset;  ///< Sample offset in the block, 0 applies the event at the block start
+
+    union
+    {
+        host_float value[2]; ///< One or two numeric values
+        int number;          ///< Integer, boolean or enum value
+        NoteArgs note;       ///< Note events
+        ADSRParams adsr;     ///< Envelope events
+        LFOParams lfo;       ///< LFO events
+    };
+};
+
 /**
  * @brief Central class representing a complete polyphonic synthesizer.
  *
@@ -67,24 +154,47 @@ struct LFOParams
  * including oscillator configuration, modulation, envelopes, filtering, delay,
  * reverb, analog drift simulation and multithreaded voice rendering.
  *
- * The class is implemented as a singleton and provides a high-level API for real-time use.
+ * Each synthesizer renders in its own DSPEngine and provides a high-level API for
+ * real-time use. Synthesizers in different engines are independent and can be
+ * processed on different threads at the same time.
+ *
+ * Notes and parameter changes are posted as events into a wait-free single-producer
+ * single-consumer queue, so one control thread (GUI, Pd messages, MIDI) may call the
+ * setters while the audio thread renders. process() drains the queue before the block
+ * is rendered and applies only the last update of each parameter per sample offset,
+ * a fast knob sweep posted at one offset costs one update. initialize() and setThreadCount() are not queued.
+ *
+ * The engine renders fixed blocks of DSP::blockSize samples, normally DSP::subBlockSize,
+ * into its own output bus. process() accepts host buffers of any length and copies the
+ * rendered blocks out, samples left over are delivered by the next call.
+ *
+ * Events carry a sample offset in the host buffer they are applied in, see setEventOffset().
+ * The voices render a block in parts that end at the event offsets, so notes and
+ * voice parameters take effect at their sample regardless of the block size. Each
+ * part is rendered in place at its position in the voice outputs. The effect chain
+ * processes whole blocks, its parameters change at the start of the block.
  */
 class JPSynth
 {
 public:
-    /** @brief Returns the singleton instance. */
-    static JPSynth &instance();
+    /**
+     * @brief Constructs a synthesizer that renders in the given engine.
+     *
+     * initialize(), setThreadCount() and process() make the engine current
+     * on the calling thread.
+     *
+     * @param engine Engine owning the buses and objects of the synthesizer
+     */
+    explicit JPSynth(DSPEngine &engine);
 
     /**
      * @brief Initializes the synthesizer.
      *
      * Sets up voice structures, routing and connects to output buses.
-     * Must be called once after the DSP engine is initialized.
-     *
-     * @param outL Pointer to output buffer left
-     * @param outR Pointer to output buffer right
+     * Must be called once after the engine is initialized with DSP::initializeAudio(),
+     * the block size of the engine is the internal block size, e.g. DSP::subBlockSize.
      */
-    void initialize(host_float *outL, host_float *outR);
+    void initialize();
 
     /** @brief Triggers a note-on event with given velocity. */
     void noteIn(int note, host_float velocity);
@@ -158,6 +268,14 @@ public:
     /** @brief Enables one-shot mode for all envelopes (ignores note off). */
     void setADSROneshot(bool enable);
 
+    /**
+     * @brief Sets how a voice that still sounds is taken over by a new note.
+     *
+     * VoiceStealMode::Tail starts the new note at once and fades the old one out
+     * as a short tail, so small voice pools can be played densely without clicks.
+     */
+    void setVoiceStealMode(VoiceStealMode mode);
+
     /** @brief Sets the LFO 1 parameters. */
     void setLFO1(LFOParams params);
 
@@ -215,17 +333,131 @@ public:
     /** @brief Sets the analog feeling (amound and damping) */
     void setAnalogDrift(host_float amount, host_float damping);
 
-    /** @brief Renders the full audio block from all voices and effect units. */
-    void process();
+    /**
+     * @brief Sets the number of threads rendering a block, 0 picks one per two CPU cores.
+     *
+     * Starts and joins threads, must not be called while a block is processed.
+     * Takes effect immediately if the synth is already initialized.
+     */
+    void setThreadCount(size_t count);
+
+    /**
+     * @brief Runs the filters of up to 8 voices in the SIMD lanes of one kernel.
+     *
+     * Each voice is then rendered as two graph nodes around a filter node shared
+     * by a batch of voices, see JPVoice::processFilters(). Enabled by default.
+     * Not queued, takes effect at the next initialize().
+     */
+    void setVoiceBatching(bool enable);
+
+    /**
+     * @brief Sets the number of voices that can play at once, up to maxPolyphony.
+     *
+     * The synth owns maxPolyphony voices in one contiguous pool, initialize() sets
+     * up their buses, oscillators and filters. The polyphony only limits how many
+     * of them are allocated to notes, so it can change while the synth plays without
+     * reallocating anything. Held notes above the new count are released. Only
+     * sounding voices are rendered and mixed, unused voices cost next to nothing.
+     *
+     * @param count Number of voices, clamped to [1, maxPolyphony]
+     */
+    void setPolyphony(size_t count);
+
+    /** @brief Returns the number of voices set by setPolyphony(). */
+    size_t getPolyphony() const { return polyphony; }
+
+    /**
+     * @brief Sets the sample offset of the events posted from now on.
+     *
+     * The offset is relative to the start of the host buffer the events are applied in,
+     * i.e. the next call of process() that renders a block. Offsets beyond the buffer
+     * are applied at its last sample. The first samples of the buffer may still come
+     * from the block rendered by the previous call, events with offsets into them are
+     * applied at the start of the first new block instead, so they are not sample
+     * accurate. Called by the thread that posts the events.
+     *
+     * @param offset Sample offset, 0 applies events at the block start
+     */
+    void setEventOffset(uint32_t offset);
+
+    /**
+     * @brief Fills host buffers of any length from all voices and effect units.
+     *
+     * Renders as many internal blocks as needed, samples of the last block that
+     * do not fit are kept for the next call.
+     *
+     * @param outL Output buffer left
+     * @param outR Output buffer right
+     * @param numSamples Length of the host buffers
+     */
+    void process(host_float *outL, host_float *outR, size_t numSamples);
+
+    /** @brief Returns the number of events lost because the queue was full. */
+    size_t getDroppedEvents() const { return droppedEvents.load(std::memory_order_relaxed); }
+
+    /** @brief Returns the number of events superseded by a later one at the same offset. */
+    size_t getCoalescedEvents() const { return coalescedEvents; }
+
+    /// Number of events the queue holds between two blocks
+    static constexpr size_t maxEvents = 256;
+
+    /// Voices of a synth unless set by setPolyphony()
+    static constexpr size_t defaultPolyphony = 6;
+
+    /// Largest supported polyphony
+    static constexpr size_t maxPolyphony = 64;
 
 private:
-    void processVoiceBlock(); ///< Internal voice rendering
-    void createVoices();      ///< Initializes voices
+    void postEvent(const JPEvent &event);                              ///< Queues an event, control thread
+    void postValue(JPEventType type, host_float a, host_float b = 0.0); ///< Queues a numeric event
+    void postNumber(JPEventType type, int number);                     ///< Queues an integer, bool or enum event
+    void drainEvents(size_t start, size_t numSamples);                 ///< Drains, coalesces and sorts the queue, audio thread
+    void applyEvent(const JPEvent &event);                             ///< Applies one event, audio thread
+    void applyNote(int note, host_float velocity);                     ///< Note on or off
+    void applyPolyphony(size_t count);                                 ///< Releases and parks voices above count
+    void applyFilterCutoff(host_float f);                              ///< Filter cutoff of all voices
+    void applyLFO1(const LFOParams &params);                           ///< LFO 1 settings and target
+
+    void renderBlock();                          ///< Renders one internal block into the host bus
+    void prepareVoices();                        ///< Sets the per block voice state and skips idle voices
+    void enableVoices(size_t start);             ///< Renders voices started by an event from its offset on
+    void renderVoices(size_t start, size_t end); ///< Renders a part of the block for all sounding voices
+    void createVoices();   ///< Initializes voices
+    void buildGraph();     ///< Adds the voices and the effect chain to the processing graph
+    void startThreads();   ///< (Re)starts the dispatcher threads
+
+    static void copyVoicesTask(void *context);   ///< Feeds the last voice mix into the wet chain, graph task
+    static void voicesAmpModTask(void *context); ///< Applies the amplification modulation, graph task
+    static void filterVoicesTask(void *context); ///< Runs the filters of the enabled voices of a batch, graph task
+
+    void setVoiceEnabled(size_t index, bool enabled); ///< Enables the graph nodes of a voice
 
+    /**
+     * @brief Voices whose filters run in one node, see setVoiceBatching().
+     */
+    struct VoiceBatch
+    {
+        JPSynth *synth; ///< Owner
+        size_t first;   ///< First voice index
+        size_t count;   ///< Number of voices
+        size_t node;    ///< Filter node in the voice graph
+    };
+
+    DSPEngine &engine;        ///< Engine the synthesizer renders in
     SynthVoice *currentVoice; ///< Active voice pointer
 
-    VoiceAllocator<SynthVoice> allocator; ///< Voice manager
-    DSPThreadPool voiceThreads;           ///< Thread pool for parallel voice processing
+    std::unique_ptr<SynthVoice[]> voicePool; ///< maxPolyphony voices, allocated once
+    VoiceAllocator<SynthVoice> allocator;    ///< Voice manager
+    DSPDispatcher dispatcher;             ///< Threads executing the processing graph
+    DSPGraph voiceGraph;                  ///< Voices, rendered in parts between events
+    DSPGraph graph;                       ///< Mixdown and effect chain ordered by their bus dependencies
+    std::vector<size_t> voiceNodes;       ///< Voice graph node index per voice, the source node if batched
+    std::vector<size_t> voiceOutputNodes; ///< Output node per voice if batched
+    std::vector<VoiceBatch> voiceBatches; ///< Filter batches, empty if not batched
+    size_t voiceBatchSize = 1;            ///< Voices per batch
+    std::vector<bool> voiceEnabled;       ///< Voice is rendered in the current block
+    size_t threadCount = 0;               ///< Requested threads, 0 = automatic
+    bool voiceBatching = true;            ///< Batch the voice filters, see setVoiceBatching()
     Mixer voiceMixer;                     ///< Dry voice mixdown
     CrossFader wetFader;                  ///< Dry/wet fader
 
@@ -251,10 +483,11 @@ private:
     TuningSystem filterCutoffTuning; ///< Tuning for filter cutoff
     MidiProcessor midi;              ///< Internal MIDI handler
 
-    const size_t voiceCount = 6;         ///< Maximum voice count
+    size_t polyphony = defaultPolyphony;  ///< Voices allocated to notes, set by the control thread
     const std::string name = "_JPSynth"; ///< Synth name for routing
 
-    DSPAudioBus hostBus;         ///< Final output bus (host)
+    DSPAudioBus hostBus;         ///< Final output bus, copied to the host buffers
+    size_t hostReadPosition = 0; ///< Next sample of hostBus to deliver, DSP::blockSize if all are delivered
     DSPAudioBus wetBus;          ///< Internal wet signal bus
     DSPAudioBus voicesOutputBus; ///< Pre-effect voice sum
 
@@ -284,4 +517,14 @@ private:
 
     void modVibrato(host_float); ///< Frequency modulation
     void modOscmix(host_float);  ///< Oscillator mix modulation
+
+    DSPSpscRing<JPEvent, maxEvents> events;                  ///< Events posted by the control thread
+    JPEvent blockEvents[maxEvents];                          ///< Events drained for the current host buffer
+    size_t numEvents = 0;                                    ///< Number of drained events
+    size_t nextEvent = 0;                                    ///< Next drained event to apply
+    size_t eventBlockStart = 0;                              ///< Offset of the current block relative to the drained events
+    size_t lastEvent[static_cast<size_t>(JPEventType::Count)] = {}; ///< Position + 1 of the last event per type, 0 if none
+    std::atomic<size_t> droppedEvents{0};                    ///< Events lost to a full queue
+    uint32_t eventOffset = 0;                                ///< Offset stamped on posted events, control thread
+    size_t coalescedEvents = 0;                              ///< Superseded events, audio thread
 };
@@ -20,6 +20,7 @@
 #include "ADSR.h"
 #include "clamp.h"
 #include <cmath>
+#include <vector>
 #include "DSPSampleBuffer.h"
 
 struct ADSRParams
@@ -37,18 +38,27 @@ struct ADSRParams
 class JPVoice : public SoundGenerator
 {
 public:
-    // Constructor: requires two Oscillator pointers and the global sample rateSample
+    // Constructor
     JPVoice();
 
-    // Destructor: deletes both oscillator instances
+    // Destructor
     ~JPVoice();
 
-    // Start ADSRs
+    // Start ADSRs, a sounding voice is handled according to the steal mode
     void playNote();
 
     // Stop  ADSRs
     void stopNote();
 
+    /**
+     * @brief True if the voice needs to be rendered.
+     *
+     * A voice is active from note on until its amp envelope is idle, and
+     * while a parameter change is still being faded in. Only sounding voices
+     * fade changes, a parked voice of the pool stays inactive.
+     */
+    bool isActive() const { return active || paramFader.isPending(); }
+
     // Sets the modulation index for frequency modulation.
     // This controls the intensity of the frequency modulation effect.
     void setModIndex(host_float index);
@@ -71,10 +81,10 @@ public:
     // Sets the volume level of the noise generator
     void setNoiseMix(host_float mix);
 
-    // Assigns the carrier oscillator
+    // Assigns the carrier waveform, the carrier keeps its phase and unison voices
     void setCarrierOscillatorType(CarrierOscillatiorType oscillatorType);
 
-    // Assigns the modulator oscillator
+    // Assigns the modulator waveform
     void setModulatorOscillatorType(ModulatorOscillatorType oscillatorType);
 
     // Changes the current noise type (white or pink)
@@ -110,6 +120,16 @@ public:
     // Link the ADSRs
     void linkADSR(bool isEnabled);
 
+    /**
+     * @brief Sets how playNote() treats a voice that still sounds.
+     *
+     * With VoiceStealMode::Tail the last output of the voice is played backwards
+     * and faded out over tailTimeMS while the new note starts without the startup
+     * ramp of the envelopes. The tail is read from a short history of the output,
+     * so it costs no oscillator or filter processing.
+     */
+    void setStealMode(VoiceStealMode mode);
+
     // Set adrss to one shot mode
     void setADSROneshot(bool isEnabled);
 
@@ -125,20 +145,103 @@ public:
     // Next sample block generation
     void processBlock();
 
+    /**
+     * @brief Adds the voice as one node that owns its oscillator, noise and envelope buses.
+     *
+     * The buses are overwritten every block, so they can share storage with
+     * the buses of other nodes, see DSPGraph::BusAliasing.
+     *
+     * @param graph The graph to add to
+     */
+    void addToGraph(DSPGraph &graph) override;
+
+    /**
+     * @brief Adds the part of the voice before its filter as a node.
+     *
+     * The source node renders the oscillators, the noise and the filter envelope.
+     * The filter is left to a node added by the caller that runs processFilters()
+     * for several voices at once, its bus accesses are declared with
+     * addFilterAccess(). addOutputToGraph() has to follow that node.
+     *
+     * @param graph The graph to add to
+     * @return Node index of the source part
+     */
+    size_t addSourceToGraph(DSPGraph &graph);
+
+    /**
+     * @brief Adds the part of the voice after its filter as a node.
+     *
+     * The output node applies parameter fades and the amp envelope.
+     *
+     * @param graph The graph to add to
+     * @return Node index of the output part
+     */
+    size_t addOutputToGraph(DSPGraph &graph);
+
+    /**
+     * @brief Declares the buses the filter of the voice accesses for a node of the caller.
+     * @param graph The graph
+     * @param node Node running processFilters() for this voice
+     */
+    void addFilterAccess(DSPGraph &graph, size_t node);
+
+    /**
+     * @brief Runs the filters of several voices between their source and output nodes.
+     *
+     * The lowpass filters are processed in SIMD lanes, see KorgonFilter::processBatch().
+     *
+     * @param voices Voices whose source part has been rendered
+     * @param count Number of voices, at most JPVoice::maxBatch
+     */
+    static void processFilters(JPVoice *const *voices, size_t count);
+
+    /// Maximum number of voices per processFilters() call
+    static constexpr size_t maxBatch = FilterLaneState::maxLanes;
+
+    /**
+     * @brief Sets where the next rendered samples start in the block.
+     *
+     * A block can be rendered in parts to apply events at their sample offset.
+     * The part has DSP::blockSize samples, the voice renders it at the start of
+     * its own buses and writes it to the output bus at the given offset.
+     *
+     * @param offset Sample offset in the output bus, 0 for whole blocks
+     */
+    void setRenderOffset(size_t offset);
+
 protected:
     // Initializes the DSP object
     void initializeGenerator() override;
 
-    void onOutputBusConnected(DSPAudioBus &bus) override;
-
 private:
     // Next sample block generation
     static void processBlock(DSPObject *dsp);
 
-    WavetableOscillator *carrier;      // Carrier oscillator (may be modulated)
-    WavetableOscillator *modulator;    // Modulator oscillator (for FM or sync)
-    WavetableOscillator *carrierTmp;   // Carrier oscillator for oscillator change
-    WavetableOscillator *modulatorTmp; // Modulator oscillator for oscillator change
+    // Oscillators, noise, mix and filter envelope into the voice bus
+    void renderSource();
+
+    // Parameter fades, amp envelope, output and stolen note tail
+    void renderOutput();
+
+    // Graph tasks of the two parts
+    static void renderSourceTask(void *context);
+    static void renderOutputTask(void *context);
+
+    // Fades a change in while the voice sounds, a silent voice applies it at once
+    void changeParam(const ParamFader::ParamChange &change);
+
+    // Parameter changes applied by the fader while the voice is silent
+    static void applyNumVoices(const ParamFader::ParamChange &change);
+    static void applyCarrier(const ParamFader::ParamChange &change);
+    static void applyModulator(const ParamFader::ParamChange &change);
+
+    // Number of selectable waveforms
+    static constexpr size_t numCarrierTypes = static_cast<size_t>(CarrierOscillatiorType::Modulo) + 1;
+    static constexpr size_t numModulatorTypes = static_cast<size_t>(ModulatorOscillatorType::Bit) + 1;
+
+    // Shared table set per waveform, the oscillators switch between them
+    const SharedWavetableSet *carrierTables[numCarrierTypes];
+    const SharedWavetableSet *modulatorTables[numModulatorTypes];
 
     host_float carrierFrequency = 0.0;   // Current frequency carrier
     host_float modulatorFrequency = 0.0; // Current frequency modulator
@@ -155,25 +258,10 @@ private:
     host_float detune = 0.0;     // Detune factor supersaw oszillator
     host_float pulseWidth = 0.5; // Pulse width square oscillator
 
-    // Oscillators
+    // Oscillators, the waveform is switched by swapping the table set
     NoiseGenerator noise;
-    SineWavetable sineCarrier;
-    SineWavetable sineModulator;
-    SawWavetable sawCarrier;
-    SawWavetable sawModulator;
-    SquareWavetable squareCarrier;
-    SquareWavetable squareModulator;
-    TriangleWavetable trianlgeCarrier;
-    TriangleWavetable triangleModulator;
-    HarmonicClusterWavetable clusterCarrier;
-    HarmonicClusterWavetable clusterModulator;
-    FibonacciWavetable fibonacciCarrier;
-    FibonacciWavetable fibonacciModulator;
-    MirrorWavetable mirrorCarrier;
-    MirrorWavetable mirrorModulator;
-    ModuloWavetable moduloCarrier;
-    ModuloWavetable moduloModulator;
-    BitWavetable bitModulator;
+    SawWavetable carrier;     // Carrier oscillator (may be modulated)
+    SineWavetable modulator;  // Modulator oscillator (for FM or sync)
 
     host_float oscDrift;
 
@@ -184,12 +272,14 @@ private:
     DSPModulationBus filterCutoffBus;
     DSPModulationBus filterCutoffModulationBus;
     DSPModulationBus outputAmplificationBus;
+    DSPAudioBus voiceAudioBus;
 
     std::string carrierAudioBusName;
     std::string modulatorAudioBusName;
     std::string noiseAudioBusName;
     std::string filterCutoffBusName;
     std::string outputAmplificationBusName;
+    std::string voiceAudioBusName;
 
     // Multi mode filter
     KorgonFilter filter;
@@ -224,4 +314,23 @@ private:
 
     // Parameter change fader
     ParamFader paramFader;
+
+    // Fade-out tail of a stolen note
+    void renderTail();
+
+    static constexpr size_t historySize = 256;    // Output history, a power of two
+    static constexpr host_float tailTimeMS = 3.0; // Length of the tail, at most historySize / 2 samples
+
+    VoiceStealMode stealMode = VoiceStealMode::Retrigger;
+    std::vector<host_float> historyL, historyR; // Last historySize output samples
+    size_t historyPos = 0;                      // Next history sample to write
+    size_t tailStart = 0;                       // History position the tail is read backwards from
+    size_t tailPos = 0;                         // Tail samples rendered
+    size_t tailSamples = 0;                     // Tail length in samples
+
+    // Voice is sounding, cleared when the amp envelope becomes idle
+    bool active = false;
+
+    // Position of the rendered samples in the output bus
+    size_t renderOffset = 0;
 };
@@ -1,4 +1,5 @@
 #include "JPSynth.h"
+#include <algorithm>
 
 std::string getRandomSynthQuote()
 {
@@ -55,21 +56,27 @@ std::string getRandomSynthQuote()
     return quotes[index];
 }
 
-JPSynth &JPSynth::instance()
+JPSynth::JPSynth(DSPEngine &engine)
+    : engine(engine), currentVoice(nullptr), voicePool(std::make_unique<SynthVoice[]>(maxPolyphony)), lfo1Target(LFOTarget::None), lfo2Target(LFOTarget::None),
+      lfo1TargetType(LFOTargetType::ModulationBus), lfo2TargetType(LFOTargetType::ModulationBus),
+      filterFollowEnabled(false), currentCutoff(0.0)
 {
-    static JPSynth instance;
-    return instance;
 }
 
-void JPSynth::initialize(host_float *outL, host_float *outR)
+void JPSynth::initialize()
 {
+    DSPEngine::Scope scope(engine);
+
     if (!DSP::isInitialized())
     {
         DSP::log("DSP not initialized. Do DSP::initializeAudio first.");
         throw("DSP not initialized. Do DSP::initializeAudio first.");
     }
 
-    hostBus = DSPBusManager::registerAudioBus(outputBusName, outL, outR);
+    hostBus = DSPBusManager::registerAudioBus(outputBusName);
+    hostReadPosition = DSP::blockSize;
+    numEvents = 0;
+    nextEvent = 0;
     wetBus = DSPBusManager::registerAudioBus(wetBusName);
     voicesOutputBus = DSPBusManager::registerAudioBus(voicesOutputBusName);
 
@@ -85,12 +92,12 @@ void JPSynth::initialize(host_float *outL, host_float *outR)
     modPanningBus.fill(0.5);
 
     // Initialization
-    voiceThreads.initialize(cpu_count() / 2);
+    startThreads();
     carrierTuning.initialize();
     modulatorTuning.initialize();
     filterCutoffTuning.initialize();
     midi.initialize();
-    voiceMixer.initialize("voiceMixer" + name, voiceCount);
+    voiceMixer.initialize("voiceMixer" + name, maxPolyphony);
     butterworth.initialize("butterworth" + name);
     lfo1.initialize("lfo1" + name);
     lfo2.initialize("lfo2" + name);
@@ -108,7 +115,7 @@ void JPSynth::initialize(host_float *outL, host_float *outR)
 
     // Patching
     // Voice outputs to mixer input
-    for (size_t i = 0; i < voiceCount; ++i)
+    for (size_t i = 0; i < maxPolyphony; ++i)
     {
         SynthVoice *voice = allocator.getVoice(i);
         voice->jpvoice.connectOutputToBus(voiceMixer.getInputBus(i));
@@ -133,6 +140,11 @@ void JPSynth::initialize(host_float *outL, host_float *outR)
 
     lfo1.connectModulationToBus(modFilterCutoffBus);
 
+    // Dependencies are derived by DSP::finalizeAudio
+    buildGraph();
+    DSP::registerGraph(voiceGraph);
+    DSP::registerGraph(graph);
+
     // Finalize initialization
     DSP::finalizeAudio();
 
@@ -174,277 +186,157 @@ void JPSynth::createVoices()
 {
     allocator.clear();
 
-    for (size_t i = 0; i < voiceCount; ++i)
+    // The pool is set up in full, the polyphony only limits the allocation
+    for (size_t i = 0; i < maxPolyphony; ++i)
     {
-        std::unique_ptr<SynthVoice> voice = std::make_unique<SynthVoice>();
+        SynthVoice &voice = voicePool[i];
 
-        voice->jpvoice.initialize("jpvoice_" + std::to_string(i) + name);
-        voice->jpvoice.setFilterCutoffModulationBus(modFilterCutoffBus);
+        voice.jpvoice.initialize("jpvoice_" + std::to_string(i) + name);
+        voice.jpvoice.setFilterCutoffModulationBus(modFilterCutoffBus);
 
-        // Transfer ownership to allocator
-        allocator.add(std::move(voice));
+        allocator.add(&voice);
     }
+
+    allocator.setActiveCount(polyphony);
 }
 
 void JPSynth::noteIn(int note, host_float velocity)
 {
-    if (velocity > 0)
-    {
-        currentVoice = allocator.allocate(note);
-        currentVoice->note = note;
-        currentVoice->jpvoice.setCarrierFrequency(carrierTuning.frequency(note));
-        currentVoice->jpvoice.setModulatorFrequency(modulatorTuning.frequency(note));
-        currentVoice->jpvoice.setAmpGain(midi.normalizeVelocityRMS(velocity));
-
-        if (filterFollowEnabled)
-        {
-            currentVoice->jpvoice.setFilterCutoff(filterCutoffTuning.frequency(note + 36));
-        }
-
-        currentVoice->jpvoice.playNote();
-    }
-    else
-    {
-        currentVoice = allocator.select(note);
-
-        // May have already been reallocated
-        if (!currentVoice)
-            return;
+    JPEvent event{};
+    event.type = JPEventType::Note;
+    event.note = {note, velocity};
 
-        currentVoice->jpvoice.stopNote();
-        allocator.setReclaimable(note);
-    }
+    postEvent(event);
 }
 
 void JPSynth::setOscillatorMix(host_float mix)
 {
-    allocator.forEachVoice(
-        [&](auto &v)
-        {
-            v.jpvoice.setOscillatorMix(mix);
-        });
+    postValue(JPEventType::OscillatorMix, mix);
 }
 
 void JPSynth::setNoiseMix(host_float mix)
 {
-    allocator.forEachVoice(
-        [&](auto &v)
-        {
-            v.jpvoice.setNoiseMix(mix);
-        });
+    postValue(JPEventType::NoiseMix, mix);
 }
 
 void JPSynth::setPitchOffset(host_float offset)
 {
-    int val = clamp(offset, -24, 24);
-
-    modulatorTuning.setHalftoneOffset(val);
-
-    allocator.forEachVoice(
-        [&](auto &v)
-        {
-            v.jpvoice.setModulatorFrequency(modulatorTuning.frequency(v.note));
-        });
+    postValue(JPEventType::PitchOffset, offset);
 }
 
 void JPSynth::setFineTune(host_float fine)
 {
-    int val = clamp(fine, -2400.0, 2400.0);
-
-    modulatorTuning.setFinetune(val);
-
-    allocator.forEachVoice(
-        [&](auto &v)
-        {
-            v.jpvoice.setModulatorFrequency(modulatorTuning.frequency(v.note));
-        });
+    postValue(JPEventType::FineTune, fine);
 }
 
 void JPSynth::setDetune(host_float detune)
 {
-    allocator.forEachVoice(
-        [&](auto &v)
-        {
-            v.jpvoice.setDetune(detune);
-        });
+    postValue(JPEventType::Detune, detune);
 }
 
 void JPSynth::setCarrierOscillatorType(CarrierOscillatiorType carrierType)
 {
-    allocator.forEachVoice(
-        [&](auto &v)
-        {
-            v.jpvoice.setCarrierOscillatorType(carrierType);
-        });
+    postNumber(JPEventType::CarrierOscillatorType, static_cast<int>(carrierType));
 }
 
 void JPSynth::setModulatorOscillatorType(ModulatorOscillatorType modulatorType)
 {
-    allocator.forEachVoice(
-        [&](auto &v)
-        {
-            v.jpvoice.setModulatorOscillatorType(modulatorType);
-        });
+    postNumber(JPEventType::ModulatorOscillatorType, static_cast<int>(modulatorType));
 }
 
 void JPSynth::setNoiseType(NoiseType noiseType)
 {
-    allocator.forEachVoice(
-        [&](auto &v)
-        {
-            v.jpvoice.setNoiseType(noiseType);
-        });
+    postNumber(JPEventType::NoiseType, static_cast<int>(noiseType));
 }
 
 void JPSynth::setModulation(host_float idx)
 {
-    host_float index = midi.normalizeModulation(idx) * 20;
-
-    allocator.forEachVoice(
-        [&](auto &v)
-        {
-            v.jpvoice.setModIndex(index);
-        });
+    postValue(JPEventType::Modulation, idx);
 }
 
 void JPSynth::setPitchBend(host_float bend)
 {
-    dsp_float b = midi.normalizePitchBend(bend) * 1200.0;
-
-    carrierTuning.setFinetune(b);
-    modulatorTuning.setFinetune(b);
-
-    allocator.forEachVoice(
-        [&](auto &v)
-        {
-            v.jpvoice.setCarrierFrequency(carrierTuning.frequency(v.note));
-            v.jpvoice.setModulatorFrequency(modulatorTuning.frequency(v.note));
-        });
+    postValue(JPEventType::PitchBend, bend);
 }
 
 void JPSynth::setNumVoices(int numVoices)
 {
-    allocator.forEachVoice(
-        [&](auto &v)
-        {
-            v.jpvoice.setNumVoices(numVoices);
-        });
+    postNumber(JPEventType::NumVoices, numVoices);
 }
 
 void JPSynth::setSyncEnabled(bool enable)
 {
-    allocator.forEachVoice(
-        [&](auto &v)
-        {
-            v.jpvoice.setSyncEnabled(enable);
-        });
+    postNumber(JPEventType::SyncEnabled, enable);
 }
 
 void JPSynth::setFeedbackCarrier(host_float fb)
 {
-    allocator.forEachVoice(
-        [&](auto &v)
-        {
-            v.jpvoice.setFeedbackCarrier(fb);
-        });
+    postValue(JPEventType::FeedbackCarrier, fb);
 }
 
 void JPSynth::setFeedbackModulator(host_float fb)
 {
-    allocator.forEachVoice(
-        [&](auto &v)
-        {
-            v.jpvoice.setFeedbackModulator(fb);
-        });
+    postValue(JPEventType::FeedbackModulator, fb);
 }
 
 void JPSynth::setFilterCutoff(host_float f)
 {
-    currentCutoff = f;
-
-    if (filterFollowEnabled)
-        return;
-
-    allocator.forEachVoice(
-        [&](auto &v)
-        {
-            v.jpvoice.setFilterCutoff(f);
-        });
+    postValue(JPEventType::FilterCutoff, f);
 }
 
 void JPSynth::setFilterResonance(host_float r)
 {
-    allocator.forEachVoice(
-        [&](auto &v)
-        {
-            v.jpvoice.setFilterResonance(r);
-        });
+    postValue(JPEventType::FilterResonance, r);
 }
 
 void JPSynth::setFilterDrive(host_float d)
 {
-    allocator.forEachVoice(
-        [&](auto &v)
-        {
-            v.jpvoice.setFilterDrive(d);
-        });
+    postValue(JPEventType::FilterDrive, d);
 }
 
 // Sets the filter mode
 void JPSynth::setFilterMode(FilterMode mode)
 {
-    allocator.forEachVoice(
-        [&](auto &v)
-        {
-            v.jpvoice.setFilterMode(mode);
-        });
+    postNumber(JPEventType::FilterMode, static_cast<int>(mode));
 }
 
 void JPSynth::setFilterFollow(bool enabled)
 {
-    filterFollowEnabled = enabled;
-
-    if (filterFollowEnabled)
-        currentVoice->jpvoice.setFilterCutoff(filterCutoffTuning.frequency(currentVoice->note + 24));
-    else
-        setFilterCutoff(currentCutoff);
+    postNumber(JPEventType::FilterFollow, enabled);
 }
 
 void JPSynth::setFilterADSR(ADSRParams adsr)
 {
-    allocator.forEachVoice(
-        [&](auto &v)
-        {
-            v.jpvoice.setFilterADSR(adsr);
-        });
+    JPEvent event{};
+    event.type = JPEventType::FilterADSR;
+    event.adsr = adsr;
+
+    postEvent(event);
 }
 
 // Sets the amplification envelope parameters
 void JPSynth::setAmpADSR(ADSRParams adsr)
 {
-    allocator.forEachVoice(
-        [&](auto &v)
-        {
-            v.jpvoice.setAmpADSR(adsr);
-        });
+    JPEvent event{};
+    event.type = JPEventType::AmpADSR;
+    event.adsr = adsr;
+
+    postEvent(event);
 }
 
 void JPSynth::linkADSR(bool enable)
 {
-    allocator.forEachVoice(
-        [&](auto &v)
-        {
-            v.jpvoice.linkADSR(enable);
-        });
+    postNumber(JPEventType::LinkADSR, enable);
 }
 
 void JPSynth::setADSROneshot(bool enable)
 {
-    allocator.forEachVoice(
-        [&](auto &v)
-        {
-            v.jpvoice.setADSROneshot(enable);
-        });
+    postNumber(JPEventType::ADSROneshot, enable);
+}
+
+void JPSynth::setVoiceStealMode(VoiceStealMode mode)
+{
+    postNumber(JPEventType::VoiceStealMode, static_cast<int>(mode));
 }
 
 inline void JPSynth::modVibrato(host_float mod)
@@ -470,226 +362,961 @@ inline void JPSynth::modOscmix(host_float mod)
 
 void JPSynth::setLFO1(LFOParams params)
 {
-    lfo1.setFrequency(params.frequency);
-    lfo1.setType(params.type);
-
-    if (lfo1Target != LFOTarget::Panning)
-        lfo1.setOffset(clamp(params.offset, 0.0, 1.0));
-
-    lfo1.setDepth(clamp(params.depth, 0.0, 1.0));
-    lfo1.setShape(params.shape);
-    lfo1.setPulseWidth(params.pw);
-    lfo1.setSmooth(params.smooth);
-
-    if (lfo1Target != params.target)
-    {
-        lfo1.connectModulationToBus(lfo1DefaultBus);
-
-        modFilterCutoffBus.fill(1.0);
-        modAmpBus.fill(1.0);
-        modPanningBus.fill(0.5);
-        modVibrato(0.0);
-        modOscmix(0.0);
-
-        // lfo2.setGain(1.0);
-
-        lfo1Target = params.target;
+    JPEvent event{};
+    event.type = JPEventType::LFO1;
+    event.lfo = params;
 
-        switch (params.target)
-        {
-        case LFOTarget::None:
-            lfo1TargetType = LFOTargetType::ModulationBus;
-            lfo1.connectModulationToBus(lfo1DefaultBus);
-            break;
-        case LFOTarget::Cutoff:
-            lfo1TargetType = LFOTargetType::ModulationBus;
-            lfo1.connectModulationToBus(modFilterCutoffBus);
-            break;
-        case LFOTarget::Tremolo:
-            lfo1TargetType = LFOTargetType::ModulationBus;
-            lfo1.connectModulationToBus(modAmpBus);
-            break;
-        case LFOTarget::Vibrato:
-            lfo1TargetType = LFOTargetType::Parameter;
-            lfo1Func = &JPSynth::modVibrato;
-            break;
-        case LFOTarget::Panning:
-            lfo1TargetType = LFOTargetType::ModulationBus;
-            lfo1.setOffset(0);
-            lfo1.connectModulationToBus(modPanningBus);
-            break;
-        case LFOTarget::OscMix:
-            lfo1TargetType = LFOTargetType::Parameter;
-            lfo1Func = &JPSynth::modOscmix;
-            break;
-        default:
-            lfo1.connectModulationToBus(lfo1DefaultBus);
-            break;
-        }
-    }
+    postEvent(event);
 }
 
 void JPSynth::setLFO2(LFOParams params)
 {
-    lfo2.setFrequency(params.frequency);
-    lfo2.setType(params.type);
-    lfo2.setOffset(clamp(params.offset, 0.0, 1.0));
-    lfo2.setDepth(clamp(params.depth, 0.0, 1.0));
-    lfo2.setShape(params.shape);
-    lfo2.setPulseWidth(params.pw);
-    lfo2.setSmooth(params.smooth);
+    JPEvent event{};
+    event.type = JPEventType::LFO2;
+    event.lfo = params;
+
+    postEvent(event);
 }
 
 void JPSynth::setReverbSpace(host_float space)
 {
-    reverb.setSpace(space);
+    postValue(JPEventType::ReverbSpace, space);
 }
 
 void JPSynth::setReverbRoom(host_float room)
 {
-    reverb.setRoomSize(room);
+    postValue(JPEventType::ReverbRoom, room);
 }
 
 void JPSynth::setReverbDamping(host_float damping)
 {
-    reverb.setDamping(damping);
+    postValue(JPEventType::ReverbDamping, damping);
 }
 
 void JPSynth::setReverbDensity(host_float density)
 {
-    reverb.setDensity(density);
+    postValue(JPEventType::ReverbDensity, density);
 }
 
 void JPSynth::setReverbTimeRatio(dsp_math::TimeRatio ratio)
 {
-    reverb.setTimeRatio(ratio);
+    postNumber(JPEventType::ReverbTimeRatio, static_cast<int>(ratio));
 }
 
 void JPSynth::setReverbWet(host_float vol)
 {
-    reverb.setWet(vol);
+    postValue(JPEventType::ReverbWet, vol);
 }
 
 void JPSynth::setDelayTime(host_float timeMSL, host_float timeMSR)
 {
-    delay.setTime(timeMSL, timeMSR);
+    postValue(JPEventType::DelayTime, timeMSL, timeMSR);
 }
 
 void JPSynth::setDelayFeedback(host_float fbL, host_float fbR)
 {
-    delay.setFeedback(fbL, fbR);
+    postValue(JPEventType::DelayFeedback, fbL, fbR);
 }
 
 void JPSynth::setDelayTimeRatio(dsp_math::TimeRatio ratio)
 {
-    delay.setTimeRatio(ratio);
+    postNumber(JPEventType::DelayTimeRatio, static_cast<int>(ratio));
 }
 
 void JPSynth::setDelayWet(host_float vol)
 {
-    delay.setWet(vol);
+    postValue(JPEventType::DelayWet, vol);
 }
 
 void JPSynth::setDistWet(host_float vol)
 {
-    dist.setWet(vol);
+    postValue(JPEventType::DistWet, vol);
 }
 
 void JPSynth::setDistDrive(host_float drive)
 {
-    dist.setDrive(drive);
+    postValue(JPEventType::DistDrive, drive);
 }
 
 void JPSynth::setDistGain(host_float gain)
 {
-    dist.setOutputGain(gain);
+    postValue(JPEventType::DistGain, gain);
 }
 
 void JPSynth::setDistType(Distortion::DistortionType type)
 {
-    dist.setDistortionType(type);
+    postNumber(JPEventType::DistType, static_cast<int>(type));
 }
 
 void JPSynth::setDistTone(host_float tone)
 {
-    dist.setTone(tone);
+    postValue(JPEventType::DistTone, tone);
 }
 
 void JPSynth::setWet(host_float wet)
 {
-    wetFader.setMix(wet);
+    postValue(JPEventType::Wet, wet);
 }
 
 void JPSynth::setAnalogDrift(host_float amount, host_float damping)
 {
-    analogDrift.setAmount(clamp(amount, 0.0, 1.0));
-    analogDrift.setDamping(damping);
+    postValue(JPEventType::AnalogDrift, amount, damping);
 }
 
-void JPSynth::process()
+// ----------- Event transport -----------
+
+void JPSynth::setEventOffset(uint32_t offset)
 {
-    DSP::nextBlock();
+    eventOffset = offset;
+}
 
-    if (lfo1Target != LFOTarget::None)
-    {
-        lfo1.process();
+// Called by the control thread, never allocates or blocks
+void JPSynth::postEvent(const JPEvent &event)
+{
+    JPEvent stamped = event;
+    stamped.offset = eventOffset;
 
-        if (lfo1TargetType == LFOTargetType::Parameter)
-            (this->*lfo1Func)(lfo1DefaultBus.m[DSP::blockSize / 2]);
-    }
+    if (!events.push(stamped))
+        droppedEvents.fetch_add(1, std::memory_order_relaxed);
+}
 
-    if (lfo2Target != LFOTarget::None)
-    {
-        lfo2.process();
-    }
+void JPSynth::postValue(JPEventType type, host_float a, host_float b)
+{
+    JPEvent event{};
+    event.type = type;
+    event.value[0] = a;
+    event.value[1] = b;
 
-    processVoiceBlock();
+    postEvent(event);
+}
 
-    voicesOutputBus.copyTo(wetBus);
+void JPSynth::postNumber(JPEventType type, int number)
+{
+    JPEvent event{};
+    event.type = type;
+    event.number = number;
 
-    voiceMixer.process();
+    postEvent(event);
+}
 
-    // voices output amplification modulation
-    voicesOutputBus.multiplyWidth(modAmpBus);
+// Called by the audio thread before the first block of a host buffer is rendered at sample start
+void JPSynth::drainEvents(size_t start, size_t numSamples)
+{
+    size_t count = 0;
+    JPEvent event;
 
-    // effects
-    butterworth.process();    
-    dist.process();
-    delay.process();
-    reverb.process();
+    // The queue holds at most maxEvents, events posted meanwhile wait for the next host buffer
+    while (count < maxEvents && events.pop(event))
+    {
+        // Offsets count from the first block rendered. Samples before start were delivered
+        // from the previous render already, events pointing there are clamped to the start
+        // of the first block and are not sample accurate, several of them lose their spacing.
+        event.offset = static_cast<uint32_t>(std::clamp<size_t>(event.offset, start, numSamples - 1) - start);
+
+        // A parameter event supersedes the earlier one of its type at the same offset, notes are all kept.
+        // Earlier values at other offsets of the block still apply between the two offsets.
+        if (event.type != JPEventType::Note)
+        {
+            size_t &last = lastEvent[static_cast<size_t>(event.type)];
 
-    // dry/wet mix
-    wetFader.process();
+            if (last != 0 && blockEvents[last - 1].offset == event.offset)
+            {
+                blockEvents[last - 1].type = JPEventType::None;
+                ++coalescedEvents;
+            }
 
-    // panning modulation from LFO
-    panner.process();
+            last = count + 1;
+        }
 
-#if DEBUG
-    try
-    {
-        DSPBusManager::validate();
+        blockEvents[count++] = event;
     }
-    catch (const std::runtime_error &e)
+
+    // Superseded events are removed, the others are ordered by offset and keep their order per offset
+    numEvents = 0;
+    nextEvent = 0;
+    eventBlockStart = 0;
+
+    for (size_t i = 0; i < count; ++i)
     {
-        DSP::log("DSP signal bus validation failed: %s", e.what());
-        throw;
+        if (blockEvents[i].type == JPEventType::None)
+            continue;
+
+        lastEvent[static_cast<size_t>(blockEvents[i].type)] = 0;
+
+        JPEvent current = blockEvents[i];
+        size_t j = numEvents++;
+
+        while (j > 0 && blockEvents[j - 1].offset > current.offset)
+        {
+            blockEvents[j] = blockEvents[j - 1];
+            --j;
+        }
+
+        blockEvents[j] = current;
     }
-#endif
 }
 
-void JPSynth::processVoiceBlock()
+void JPSynth::applyEvent(const JPEvent &event)
 {
-    host_float drift = analogDrift.getDrift();
+    host_float value = event.value[0];
+    int number = event.number;
+
+    switch (event.type)
+    {
+    case JPEventType::None:
+    case JPEventType::Count:
+        break;
+
+    case JPEventType::Note:
+        applyNote(event.note.note, event.note.velocity);
+        break;
+
+    case JPEventType::OscillatorMix:
+        allocator.forEachVoice(
+            [&](auto &v)
+            {
+                v.jpvoice.setOscillatorMix(value);
+            });
+        break;
+
+    case JPEventType::NoiseMix:
+        allocator.forEachVoice(
+            [&](auto &v)
+            {
+                v.jpvoice.setNoiseMix(value);
+            });
+        break;
 
-    for (auto *voice : allocator.getVoices())
+    case JPEventType::PitchOffset:
     {
-        voiceThreads.execute(
-            [voice, drift]()
+        int val = clamp(value, -24, 24);
+
+        modulatorTuning.setHalftoneOffset(val);
+
+        allocator.forEachVoice(
+            [&](auto &v)
             {
-                voice->jpvoice.setAnalogDrift(drift);
-                voice->jpvoice.process();
+                v.jpvoice.setModulatorFrequency(modulatorTuning.frequency(v.note));
             });
+        break;
     }
 
-    voiceThreads.wait();
-}
\ No newline at end of file
+    case JPEventType::FineTune:
+    {
+        int val = clamp(value, -2400.0, 2400.0);
+
+        modulatorTuning.setFinetune(val);
+
+        allocator.forEachVoice(
+            [&](auto &v)
+            {
+                v.jpvoice.setModulatorFrequency(modulatorTuning.frequency(v.note));
+            });
+        break;
+    }
+
+    case JPEventType::Detune:
+        allocator.forEachVoice(
+            [&](auto &v)
+            {
+                v.jpvoice.setDetune(value);
+            });
+        break;
+
+    case JPEventType::CarrierOscillatorType:
+        allocator.forEachVoice(
+            [&](auto &v)
+            {
+                v.jpvoice.setCarrierOscillatorType(static_cast<CarrierOscillatiorType>(number));
+            });
+        break;
+
+    case JPEventType::ModulatorOscillatorType:
+        allocator.forEachVoice(
+            [&](auto &v)
+            {
+                v.jpvoice.setModulatorOscillatorType(static_cast<ModulatorOscillatorType>(number));
+            });
+        break;
+
+    case JPEventType::NoiseType:
+        allocator.forEachVoice(
+            [&](auto &v)
+            {
+                v.jpvoice.setNoiseType(static_cast<NoiseType>(number));
+            });
+        break;
+
+    case JPEventType::Modulation:
+    {
+        host_float index = midi.normalizeModulation(value) * 20;
+
+        allocator.forEachVoice(
+            [&](auto &v)
+            {
+                v.jpvoice.setModIndex(index);
+            });
+        break;
+    }
+
+    case JPEventType::PitchBend:
+    {
+        dsp_float b = midi.normalizePitchBend(value) * 1200.0;
+
+        carrierTuning.setFinetune(b);
+        modulatorTuning.setFinetune(b);
+
+        allocator.forEachVoice(
+            [&](auto &v)
+            {
+                v.jpvoice.setCarrierFrequency(carrierTuning.frequency(v.note));
+                v.jpvoice.setModulatorFrequency(modulatorTuning.frequency(v.note));
+            });
+        break;
+    }
+
+    case JPEventType::NumVoices:
+        allocator.forEachVoice(
+            [&](auto &v)
+            {
+                v.jpvoice.setNumVoices(number);
+            });
+        break;
+
+    case JPEventType::SyncEnabled:
+        allocator.forEachVoice(
+            [&](auto &v)
+            {
+                v.jpvoice.setSyncEnabled(number != 0);
+            });
+        break;
+
+    case JPEventType::FeedbackCarrier:
+        allocator.forEachVoice(
+            [&](auto &v)
+            {
+                v.jpvoice.setFeedbackCarrier(value);
+            });
+        break;
+
+    case JPEventType::FeedbackModulator:
+        allocator.forEachVoice(
+            [&](auto &v)
+            {
+                v.jpvoice.setFeedbackModulator(value);
+            });
+        break;
+
+    case JPEventType::FilterCutoff:
+        applyFilterCutoff(value);
+        break;
+
+    case JPEventType::FilterResonance:
+        allocator.forEachVoice(
+            [&](auto &v)
+            {
+                v.jpvoice.setFilterResonance(value);
+            });
+        break;
+
+    case JPEventType::FilterDrive:
+        allocator.forEachVoice(
+            [&](auto &v)
+            {
+                v.jpvoice.setFilterDrive(value);
+            });
+        break;
+
+    case JPEventType::FilterMode:
+        allocator.forEachVoice(
+            [&](auto &v)
+            {
+                v.jpvoice.setFilterMode(static_cast<FilterMode>(number));
+            });
+        break;
+
+    case JPEventType::FilterFollow:
+        filterFollowEnabled = number != 0;
+
+        if (filterFollowEnabled)
+            currentVoice->jpvoice.setFilterCutoff(filterCutoffTuning.frequency(currentVoice->note + 24));
+        else
+            applyFilterCutoff(currentCutoff);
+        break;
+
+    case JPEventType::FilterADSR:
+    {
+        ADSRParams adsr = event.adsr;
+
+        allocator.forEachVoice(
+            [&](auto &v)
+            {
+                v.jpvoice.setFilterADSR(adsr);
+            });
+        break;
+    }
+
+    case JPEventType::AmpADSR:
+    {
+        ADSRParams adsr = event.adsr;
+
+        allocator.forEachVoice(
+            [&](auto &v)
+            {
+                v.jpvoice.setAmpADSR(adsr);
+            });
+        break;
+    }
+
+    case JPEventType::LinkADSR:
+        allocator.forEachVoice(
+            [&](auto &v)
+            {
+                v.jpvoice.linkADSR(number != 0);
+            });
+        break;
+
+    case JPEventType::ADSROneshot:
+        allocator.forEachVoice(
+            [&](auto &v)
+            {
+                v.jpvoice.setADSROneshot(number != 0);
+            });
+        break;
+
+    case JPEventType::LFO1:
+        applyLFO1(event.lfo);
+        break;
+
+    case JPEventType::LFO2:
+        lfo2.setFrequency(event.lfo.frequency);
+        lfo2.setType(event.lfo.type);
+        lfo2.setOffset(clamp(event.lfo.offset, 0.0, 1.0));
+        lfo2.setDepth(clamp(event.lfo.depth, 0.0, 1.0));
+        lfo2.setShape(event.lfo.shape);
+        lfo2.setPulseWidth(event.lfo.pw);
+        lfo2.setSmooth(event.lfo.smooth);
+        break;
+
+    case JPEventType::ReverbSpace:
+        reverb.setSpace(value);
+        break;
+
+    case JPEventType::ReverbRoom:
+        reverb.setRoomSize(value);
+        break;
+
+    case JPEventType::ReverbDamping:
+        reverb.setDamping(value);
+        break;
+
+    case JPEventType::ReverbDensity:
+        reverb.setDensity(value);
+        break;
+
+    case JPEventType::ReverbTimeRatio:
+        reverb.setTimeRatio(static_cast<dsp_math::TimeRatio>(number));
+        break;
+
+    case JPEventType::ReverbWet:
+        reverb.setWet(value);
+        break;
+
+    case JPEventType::DelayTime:
+        delay.setTime(event.value[0], event.value[1]);
+        break;
+
+    case JPEventType::DelayFeedback:
+        delay.setFeedback(event.value[0], event.value[1]);
+        break;
+
+    case JPEventType::DelayTimeRatio:
+        delay.setTimeRatio(static_cast<dsp_math::TimeRatio>(number));
+        break;
+
+    case JPEventType::DelayWet:
+        delay.setWet(value);
+        break;
+
+    case JPEventType::DistWet:
+        dist.setWet(value);
+        break;
+
+    case JPEventType::DistDrive:
+        dist.setDrive(value);
+        break;
+
+    case JPEventType::DistGain:
+        dist.setOutputGain(value);
+        break;
+
+    case JPEventType::DistTone:
+        dist.setTone(value);
+        break;
+
+    case JPEventType::DistType:
+        dist.setDistortionType(static_cast<Distortion::DistortionType>(number));
+        break;
+
+    case JPEventType::Wet:
+        wetFader.setMix(value);
+        break;
+
+    case JPEventType::AnalogDrift:
+        analogDrift.setAmount(clamp(event.value[0], 0.0, 1.0));
+        analogDrift.setDamping(event.value[1]);
+        break;
+
+    case JPEventType::Polyphony:
+        applyPolyphony(static_cast<size_t>(number));
+        break;
+
+    case JPEventType::VoiceStealMode:
+        allocator.forEachVoice(
+            [&](auto &v)
+            {
+                v.jpvoice.setStealMode(static_cast<VoiceStealMode>(number));
+            });
+        break;
+    }
+}
+
+void JPSynth::applyNote(int note, host_float velocity)
+{
+    if (velocity > 0)
+    {
+        currentVoice = allocator.allocate(note);
+        currentVoice->note = note;
+        currentVoice->jpvoice.setCarrierFrequency(carrierTuning.frequency(note));
+        currentVoice->jpvoice.setModulatorFrequency(modulatorTuning.frequency(note));
+        currentVoice->jpvoice.setAmpGain(midi.normalizeVelocityRMS(velocity));
+
+        if (filterFollowEnabled)
+        {
+            currentVoice->jpvoice.setFilterCutoff(filterCutoffTuning.frequency(note + 36));
+        }
+
+        currentVoice->jpvoice.playNote();
+    }
+    else
+    {
+        currentVoice = allocator.select(note);
+
+        // May have already been reallocated
+        if (!currentVoice)
+            return;
+
+        currentVoice->jpvoice.stopNote();
+        allocator.setReclaimable(note);
+    }
+}
+
+void JPSynth::applyPolyphony(size_t count)
+{
+    // Voices above the count fade out, their note-off finds no voice
+    for (size_t i = count; i < allocator.getActiveCount(); ++i)
+    {
+        if (allocator.getNote(static_cast<int>(i)) != -1)
+            allocator.getVoice(i)->jpvoice.stopNote();
+    }
+
+    allocator.setActiveCount(count);
+}
+
+void JPSynth::applyFilterCutoff(host_float f)
+{
+    currentCutoff = f;
+
+    if (filterFollowEnabled)
+        return;
+
+    allocator.forEachVoice(
+        [&](auto &v)
+        {
+            v.jpvoice.setFilterCutoff(f);
+        });
+}
+
+void JPSynth::applyLFO1(const LFOParams &params)
+{
+    lfo1.setFrequency(params.frequency);
+    lfo1.setType(params.type);
+
+    if (lfo1Target != LFOTarget::Panning)
+        lfo1.setOffset(clamp(params.offset, 0.0, 1.0));
+
+    lfo1.setDepth(clamp(params.depth, 0.0, 1.0));
+    lfo1.setShape(params.shape);
+    lfo1.setPulseWidth(params.pw);
+    lfo1.setSmooth(params.smooth);
+
+    if (lfo1Target != params.target)
+    {
+        lfo1.connectModulationToBus(lfo1DefaultBus);
+
+        modFilterCutoffBus.fill(1.0);
+        modAmpBus.fill(1.0);
+        modPanningBus.fill(0.5);
+        modVibrato(0.0);
+        modOscmix(0.0);
+
+        // lfo2.setGain(1.0);
+
+        lfo1Target = params.target;
+
+        switch (params.target)
+        {
+        case LFOTarget::None:
+            lfo1TargetType = LFOTargetType::ModulationBus;
+            lfo1.connectModulationToBus(lfo1DefaultBus);
+            break;
+        case LFOTarget::Cutoff:
+            lfo1TargetType = LFOTargetType::ModulationBus;
+            lfo1.connectModulationToBus(modFilterCutoffBus);
+            break;
+        case LFOTarget::Tremolo:
+            lfo1TargetType = LFOTargetType::ModulationBus;
+            lfo1.connectModulationToBus(modAmpBus);
+            break;
+        case LFOTarget::Vibrato:
+            lfo1TargetType = LFOTargetType::Parameter;
+            lfo1Func = &JPSynth::modVibrato;
+            break;
+        case LFOTarget::Panning:
+            lfo1TargetType = LFOTargetType::ModulationBus;
+            lfo1.setOffset(0);
+            lfo1.connectModulationToBus(modPanningBus);
+            break;
+        case LFOTarget::OscMix:
+            lfo1TargetType = LFOTargetType::Parameter;
+            lfo1Func = &JPSynth::modOscmix;
+            break;
+        default:
+            lfo1.connectModulationToBus(lfo1DefaultBus);
+            break;
+        }
+    }
+}
+
+void JPSynth::process(host_float *outL, host_float *outR, size_t numSamples)
+{
+    DSPEngine::Scope scope(engine);
+
+    bool drained = false;
+    size_t done = 0;
+
+    while (done < numSamples)
+    {
+        if (hostReadPosition == DSP::blockSize)
+        {
+            // Notes and parameter changes posted since the last host buffer
+            if (!drained)
+            {
+                drainEvents(done, numSamples);
+                drained = true;
+            }
+
+            renderBlock();
+            hostReadPosition = 0;
+        }
+
+        size_t count = std::min(numSamples - done, DSP::blockSize - hostReadPosition);
+
+        const host_float *l = hostBus.l.data() + hostReadPosition;
+        const host_float *r = hostBus.r.data() + hostReadPosition;
+
+        std::copy(l, l + count, outL + done);
+        std::copy(r, r + count, outR + done);
+
+        hostReadPosition += count;
+        done += count;
+    }
+}
+
+void JPSynth::renderBlock()
+{
+    DSP::nextBlock();
+
+    size_t blockEnd = eventBlockStart + DSP::blockSize;
+
+    // Events at the block start are applied before the modulation sources run
+    while (nextEvent < numEvents && blockEvents[nextEvent].offset <= eventBlockStart)
+    {
+        applyEvent(blockEvents[nextEvent++]);
+    }
+
+    if (lfo1Target != LFOTarget::None)
+    {
+        lfo1.process();
+
+        if (lfo1TargetType == LFOTargetType::Parameter)
+            (this->*lfo1Func)(lfo1DefaultBus.m[DSP::blockSize / 2]);
+    }
+
+    if (lfo2Target != LFOTarget::None)
+    {
+        lfo2.process();
+    }
+
+    prepareVoices();
+
+    // The voices are rendered up to the next event, which takes effect at its sample
+    size_t start = 0;
+
+    while (nextEvent < numEvents && blockEvents[nextEvent].offset < blockEnd)
+    {
+        size_t offset = blockEvents[nextEvent].offset - eventBlockStart;
+
+        renderVoices(start, offset);
+        start = offset;
+
+        while (nextEvent < numEvents && blockEvents[nextEvent].offset == offset + eventBlockStart)
+        {
+            applyEvent(blockEvents[nextEvent++]);
+        }
+
+        enableVoices(start);
+    }
+
+    renderVoices(start, DSP::blockSize);
+    eventBlockStart = blockEnd;
+
+    for (size_t i = 0; i < maxPolyphony; ++i)
+    {
+        voiceMixer.setInputActive(i, voiceEnabled[i]);
+    }
+
+    // Mixdown and effect chain, see buildGraph
+    graph.process(dispatcher);
+
+#if DEBUG
+    try
+    {
+        DSPBusManager::validate();
+    }
+    catch (const std::runtime_error &e)
+    {
+        DSP::log("DSP signal bus validation failed: %s", e.what());
+        throw;
+    }
+#endif
+}
+
+void JPSynth::buildGraph()
+{
+    voiceGraph.clear();
+    graph.clear();
+    voiceNodes.assign(maxPolyphony, 0);
+    voiceOutputNodes.assign(maxPolyphony, 0);
+    voiceEnabled.assign(maxPolyphony, false);
+    voiceBatches.clear();
+
+    if (voiceBatching)
+    {
+        // Batches as wide as the filter kernel, the tasks point into the vector
+        voiceBatchSize = std::min(FilterLaneKernel::getLanes(), JPVoice::maxBatch);
+        voiceBatches.resize((maxPolyphony + voiceBatchSize - 1) / voiceBatchSize);
+
+        for (size_t b = 0; b < voiceBatches.size(); ++b)
+        {
+            VoiceBatch &batch = voiceBatches[b];
+            batch.synth = this;
+            batch.first = b * voiceBatchSize;
+            batch.count = std::min(voiceBatchSize, maxPolyphony - batch.first);
+
+            // Sources of the batch, the shared filter node, then the outputs
+            for (size_t i = batch.first; i < batch.first + batch.count; ++i)
+            {
+                voiceNodes[i] = allocator.getVoice(i)->jpvoice.addSourceToGraph(voiceGraph);
+            }
+
+            batch.node = voiceGraph.addTask("filterVoices" + name, &JPSynth::filterVoicesTask, &batch);
+
+            for (size_t i = batch.first; i < batch.first + batch.count; ++i)
+            {
+                allocator.getVoice(i)->jpvoice.addFilterAccess(voiceGraph, batch.node);
+            }
+
+            for (size_t i = batch.first; i < batch.first + batch.count; ++i)
+            {
+                voiceOutputNodes[i] = allocator.getVoice(i)->jpvoice.addOutputToGraph(voiceGraph);
+            }
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < maxPolyphony; ++i)
+        {
+            // A voice is one node, its buses are declared by the voice
+            voiceGraph.add(allocator.getVoice(i)->jpvoice);
+            voiceNodes[i] = voiceGraph.size() - 1;
+        }
+    }
+
+    for (size_t i = 0; i < maxPolyphony; ++i)
+    {
+        // The mixer reads the voice output after all parts of the block are rendered
+        voiceGraph.pinBus(voiceMixer.getInputBus(i));
+    }
+
+    // The wet chain is fed with the mix of the previous block
+    size_t copy = graph.addTask("copyVoices" + name, &JPSynth::copyVoicesTask, this);
+    graph.addAccess(copy, voicesOutputBus, DSPBusAccess::Read);
+    graph.addAccess(copy, wetBus, DSPBusAccess::Write);
+
+    graph.add(voiceMixer);
+
+    // voices output amplification modulation
+    size_t ampMod = graph.addTask("voicesAmpMod" + name, &JPSynth::voicesAmpModTask, this);
+    graph.addAccess(ampMod, modAmpBus, DSPBusAccess::Read);
+    graph.addAccess(ampMod, voicesOutputBus, DSPBusAccess::ReadWrite);
+
+    // effects
+    graph.add(butterworth);
+    graph.add(dist);
+    graph.add(delay);
+    graph.add(reverb);
+
+    // dry/wet mix
+    graph.add(wetFader);
+
+    // panning modulation from LFO
+    graph.add(panner);
+
+    // The host buffers are filled from the output after the block, also by later calls
+    graph.pinBus(hostBus);
+}
+
+void JPSynth::startThreads()
+{
+    // The audio thread takes part as well, so it counts as one of the threads
+    size_t threads = threadCount > 0 ? threadCount : static_cast<size_t>(cpu_count() / 2);
+
+    dispatcher.initialize(clamp(threads, static_cast<size_t>(1), maxPolyphony) - 1);
+
+    // Rendering on one thread, the voices can share their buses
+    DSPGraph::BusAliasing aliasing = dispatcher.getNumWorkers() == 0 ? DSPGraph::BusAliasing::Serial
+                                                                     : DSPGraph::BusAliasing::Parallel;
+    voiceGraph.setBusAliasing(aliasing);
+    graph.setBusAliasing(aliasing);
+}
+
+void JPSynth::setThreadCount(size_t count)
+{
+    threadCount = count;
+
+    DSPEngine::Scope scope(engine);
+
+    if (DSP::isInitialized())
+    {
+        startThreads();
+    }
+}
+
+void JPSynth::setVoiceBatching(bool enable)
+{
+    voiceBatching = enable;
+}
+
+void JPSynth::setPolyphony(size_t count)
+{
+    polyphony = clamp(count, static_cast<size_t>(1), maxPolyphony);
+    postNumber(JPEventType::Polyphony, static_cast<int>(polyphony));
+}
+
+void JPSynth::prepareVoices()
+{
+    host_float drift = analogDrift.getDrift();
+
+    // Only sounding voices are rendered and mixed
+    for (size_t i = 0; i < maxPolyphony; ++i)
+    {
+        JPVoice &voice = allocator.getVoice(i)->jpvoice;
+
+        voice.setAnalogDrift(drift);
+        setVoiceEnabled(i, false);
+    }
+
+    for (const VoiceBatch &batch : voiceBatches)
+    {
+        voiceGraph.setNodeEnabled(batch.node, false);
+    }
+
+    enableVoices(0);
+}
+
+void JPSynth::enableVoices(size_t start)
+{
+    // A voice stays enabled for the rest of the block, the part before its start is silent
+    for (size_t i = 0; i < maxPolyphony; ++i)
+    {
+        if (voiceEnabled[i] || !allocator.getVoice(i)->jpvoice.isActive())
+            continue;
+
+        DSPAudioBus &output = voiceMixer.getInputBus(i);
+
+        std::fill(output.l.data(), output.l.data() + start, static_cast<host_float>(0.0));
+        std::fill(output.r.data(), output.r.data() + start, static_cast<host_float>(0.0));
+
+        setVoiceEnabled(i, true);
+    }
+}
+
+void JPSynth::setVoiceEnabled(size_t index, bool enabled)
+{
+    voiceEnabled[index] = enabled;
+    voiceGraph.setNodeEnabled(voiceNodes[index], enabled);
+
+    if (!voiceBatches.empty())
+    {
+        voiceGraph.setNodeEnabled(voiceOutputNodes[index], enabled);
+
+        // A batch runs if any of its voices does
+        if (enabled)
+            voiceGraph.setNodeEnabled(voiceBatches[index / voiceBatchSize].node, true);
+    }
+}
+
+void JPSynth::renderVoices(size_t start, size_t end)
+{
+    size_t blockSize = DSP::blockSize;
+
+    for (size_t i = 0; i < maxPolyphony; ++i)
+    {
+        allocator.getVoice(i)->jpvoice.setRenderOffset(start);
+    }
+
+    // The part is rendered as a block of its own length
+    DSP::blockSize = end - start;
+    voiceGraph.process(dispatcher);
+    DSP::blockSize = blockSize;
+}
+
+void JPSynth::copyVoicesTask(void *context)
+{
+    JPSynth *synth = static_cast<JPSynth *>(context);
+    synth->voicesOutputBus.copyTo(synth->wetBus);
+}
+
+void JPSynth::filterVoicesTask(void *context)
+{
+    VoiceBatch *batch = static_cast<VoiceBatch *>(context);
+    JPSynth *synth = batch->synth;
+    JPVoice *voices[JPVoice::maxBatch];
+    size_t count = 0;
+
+    // Disabled voices are packed out, the kernel masks the lanes left over
+    for (size_t i = batch->first; i < batch->first + batch->count; ++i)
+    {
+        if (synth->voiceEnabled[i])
+            voices[count++] = &synth->allocator.getVoice(i)->jpvoice;
+    }
+
+    JPVoice::processFilters(voices, count);
+}
+
+void JPSynth::voicesAmpModTask(void *context)
+{
+    JPSynth *synth = static_cast<JPSynth *>(context);
+    synth->voicesOutputBus.multiplyWidth(synth->modAmpBus);
+}
@@ -1,17 +1,13 @@
 #include "JPVoice.h"
+#include "DSPGraph.h"
 
-// Constructor: initializes the voice with two oscillator instances.
-// These oscillators are externally allocated and represent the carrier (carrier) and modulator (modulator).
+// Constructor: the voice owns one carrier and one modulator oscillator
 JPVoice::JPVoice()
 {
-    carrier = &sawCarrier;
-    modulator = &sineModulator;
-
     registerBlockProcessor(JPVoice::processBlock);
 }
 
-// Destructor: cleans up oscillator instances.
-// It is assumed that carrier and modulator were allocated using 'new' and are not shared elsewhere.
+// Destructor: the wavetables belong to the shared cache
 JPVoice::~JPVoice()
 {
 }
@@ -24,64 +20,45 @@ void JPVoice::initializeGenerator()
     feedbackAmountCarrier = 0.0;
     feedbackAmountModulator = 0.0;
 
+    // The tail reads backwards while the new note writes forwards, they must not meet
+    historyL.assign(historySize, 0.0);
+    historyR.assign(historySize, 0.0);
+    historyPos = 0;
+    tailSamples = clamp(static_cast<size_t>(tailTimeMS * DSP::sampleRate / 1000.0), static_cast<size_t>(1), historySize / 2);
+    tailPos = tailSamples;
+
     // create unique bus names
     carrierAudioBusName = "carrierBus" + getName();
     modulatorAudioBusName = "modulatorBus" + getName();
     noiseAudioBusName = "noiseBus" + getName();
     filterCutoffBusName = "filterCutoffBus" + getName();
     outputAmplificationBusName = "outputAmp" + getName();
+    voiceAudioBusName = "voiceBus" + getName();
+
+    // Table sets of every waveform, loaded once and shared by all voices
+    carrierTables[static_cast<size_t>(CarrierOscillatiorType::Saw)] = WavetableOscillator::acquireWavetable<SawWavetable>();
+    carrierTables[static_cast<size_t>(CarrierOscillatiorType::Square)] = WavetableOscillator::acquireWavetable<SquareWavetable>();
+    carrierTables[static_cast<size_t>(CarrierOscillatiorType::Triangle)] = WavetableOscillator::acquireWavetable<TriangleWavetable>();
+    carrierTables[static_cast<size_t>(CarrierOscillatiorType::Sine)] = WavetableOscillator::acquireWavetable<SineWavetable>();
+    carrierTables[static_cast<size_t>(CarrierOscillatiorType::Cluster)] = WavetableOscillator::acquireWavetable<HarmonicClusterWavetable>();
+    carrierTables[static_cast<size_t>(CarrierOscillatiorType::Fibonacci)] = WavetableOscillator::acquireWavetable<FibonacciWavetable>();
+    carrierTables[static_cast<size_t>(CarrierOscillatiorType::Mirror)] = WavetableOscillator::acquireWavetable<MirrorWavetable>();
+    carrierTables[static_cast<size_t>(CarrierOscillatiorType::Modulo)] = WavetableOscillator::acquireWavetable<ModuloWavetable>();
+
+    // The modulator shares the sets of the carrier waveforms
+    for (size_t i = 0; i < numCarrierTypes; ++i)
+    {
+        modulatorTables[i] = carrierTables[i];
+    }
 
-    // Waveform oscillators
-    sawCarrier.initialize("sawCarrier" + getName());
-    sawCarrier.setRole(GeneratorRole::Carrier);
-
-    sawModulator.initialize("sawModulator" + getName());
-    sawModulator.setRole(GeneratorRole::Normal);
-
-    sineCarrier.initialize("sineCarrier" + getName());
-    sineCarrier.setRole(GeneratorRole::Carrier);
-
-    sineModulator.initialize("sineModulator" + getName());
-    sineModulator.setRole(GeneratorRole::Normal);
-
-    squareCarrier.initialize("squareCarrier" + getName());
-    squareCarrier.setRole(GeneratorRole::Carrier);
-
-    squareModulator.initialize("squareModulator" + getName());
-    squareModulator.setRole(GeneratorRole::Normal);
-
-    trianlgeCarrier.initialize("trianlgeCarrier" + getName());
-    trianlgeCarrier.setRole(GeneratorRole::Carrier);
-
-    triangleModulator.initialize("triangleModulator" + getName());
-    triangleModulator.setRole(GeneratorRole::Normal);
-
-    clusterCarrier.initialize("clusterCarrier" + getName());
-    clusterCarrier.setRole(GeneratorRole::Carrier);
-
-    clusterModulator.initialize("clusterModulator" + getName());
-    clusterModulator.setRole(GeneratorRole::Normal);
-
-    fibonacciCarrier.initialize("fibonacciCarrier" + getName());
-    fibonacciCarrier.setRole(GeneratorRole::Carrier);
-
-    fibonacciModulator.initialize("fibonacciModulator" + getName());
-    fibonacciModulator.setRole(GeneratorRole::Normal);
-
-    mirrorCarrier.initialize("mirrorCarrier" + getName());
-    mirrorCarrier.setRole(GeneratorRole::Carrier);
-
-    mirrorModulator.initialize("mirrorModulator" + getName());
-    mirrorModulator.setRole(GeneratorRole::Normal);
-
-    moduloCarrier.initialize("moduloCarrier" + getName());
-    moduloCarrier.setRole(GeneratorRole::Carrier);
+    modulatorTables[static_cast<size_t>(ModulatorOscillatorType::Bit)] = WavetableOscillator::acquireWavetable<BitWavetable>();
 
-    moduloModulator.initialize("moduloModulator" + getName());
-    moduloModulator.setRole(GeneratorRole::Normal);
+    // Waveform oscillators
+    carrier.initialize("carrier" + getName());
+    carrier.setRole(GeneratorRole::Carrier);
 
-    bitModulator.initialize("bitModulator" + getName());
-    bitModulator.setRole(GeneratorRole::Normal);
+    modulator.initialize("modulator" + getName());
+    modulator.setRole(GeneratorRole::Normal);
 
     filter.initialize("filter" + getName());
     filterAdsr.initialize("filterAdsr" + getName());
@@ -95,15 +72,18 @@ void JPVoice::initializeGenerator()
     noiseAudioBus = DSPBusManager::registerAudioBus(noiseAudioBusName);                        // noise generator output bus
     filterCutoffBus = DSPBusManager::registerModulationBus(filterCutoffBusName);               // filter cutoff modulation bus (from filterADSR)
     outputAmplificationBus = DSPBusManager::registerModulationBus(outputAmplificationBusName); // output amplification output bus
+    voiceAudioBus = DSPBusManager::registerAudioBus(voiceAudioBusName);                        // oscillator mix before amplification
 
     // Patching
-    carrier->connectOutputToBus(carrierAudioBus);           // carrier output
-    carrier->connectFMToBus(modulatorAudioBus);             // FM from modulator
-    modulator->connectOutputToBus(modulatorAudioBus);       // modulator output
+    carrier.connectOutputToBus(carrierAudioBus);            // carrier output
+    carrier.connectFMToBus(modulatorAudioBus);              // FM from modulator
+    modulator.connectOutputToBus(modulatorAudioBus);        // modulator output
     noise.connectOutputToBus(noiseAudioBus);                // noise output
     filter.connectModulationToBus(filterCutoffBus);         // cutoff modulation set by filterADSR
     filterAdsr.connectModulationToBus(filterCutoffBus);     // filter adsr on filter cutoff modulation
     ampAdsr.connectModulationToBus(outputAmplificationBus); // voice output amplification
+    filter.connectProcessToBus(voiceAudioBus);              // output filtering
+    paramFader.connectProcessToBus(voiceAudioBus);          // fade output on parameter change
 
     filterAdsr.setGain(15000.0);
     ampAdsr.setGain(1.0);
@@ -132,17 +112,26 @@ void JPVoice::initializeGenerator()
     setModIndex(0.0);
 }
 
-void JPVoice::onOutputBusConnected(DSPAudioBus &bus)
-{
-    filter.connectProcessToBus(bus);     // output filtering
-    paramFader.connectProcessToBus(bus); // fade output on parameter change
-}
-
 // Start ADSRs
 void JPVoice::playNote()
 {
-    filterAdsr.triggerStart();
-    ampAdsr.triggerStart();
+    if (active && stealMode == VoiceStealMode::Tail)
+    {
+        tailStart = historyPos;
+        tailPos = 0;
+
+        // The filter state belongs to the old note
+        filter.reset();
+        filterAdsr.triggerRestart();
+        ampAdsr.triggerRestart();
+    }
+    else
+    {
+        filterAdsr.triggerStart();
+        ampAdsr.triggerStart();
+    }
+
+    active = true;
 }
 
 // Stop  ADSRs
@@ -157,7 +146,7 @@ void JPVoice::stopNote()
 void JPVoice::setModIndex(host_float index)
 {
     modulationIndex = index;
-    carrier->setModIndex(modulationIndex);
+    carrier.setModIndex(modulationIndex);
 }
 
 // Enables or disables oscillator synchronization.
@@ -170,14 +159,14 @@ void JPVoice::setSyncEnabled(bool enabled)
 // Sets the current frequency for the carrier
 void JPVoice::setCarrierFrequency(host_float f)
 {
-    carrier->setFrequency(f);
+    carrier.setFrequency(f);
     carrierFrequency = f;
 }
 
 // Sets the current frequency for the modulator
 void JPVoice::setModulatorFrequency(host_float f)
 {
-    modulator->setFrequency(f);
+    modulator.setFrequency(f);
     modulatorFrequency = f;
 }
 
@@ -185,7 +174,21 @@ void JPVoice::setModulatorFrequency(host_float f)
 void JPVoice::setDetune(host_float value)
 {
     detune = value;
-    carrier->setDetune(detune);
+    carrier.setDetune(detune);
+}
+
+// A silent voice has nothing to fade, the change is applied in place so
+// parked voices of the pool are not rendered for the length of the fade
+void JPVoice::changeParam(const ParamFader::ParamChange &change)
+{
+    if (active)
+    {
+        paramFader.change(change);
+    }
+    else
+    {
+        change.apply(change);
+    }
 }
 
 // Sets the number of voices
@@ -195,11 +198,13 @@ void JPVoice::setNumVoices(int count)
         return;
 
     numVoices = count;
-    paramFader.change(
-        [=]()
-        {
-            carrier->setNumVoices(numVoices);
-        });
+    changeParam({applyNumVoices, this, nullptr, {0.0, 0.0}, count});
+}
+
+void JPVoice::applyNumVoices(const ParamFader::ParamChange &change)
+{
+    JPVoice *self = static_cast<JPVoice *>(change.target);
+    self->carrier.setNumVoices(change.count);
 }
 
 // Sets the volume level of the oscillators
@@ -214,118 +219,50 @@ void JPVoice::setNoiseMix(host_float mix)
     noisemix = clamp(mix, 0.0, 1.0);
 }
 
-// Assigns the carrier oscillator
+// Assigns the carrier waveform
 void JPVoice::setCarrierOscillatorType(CarrierOscillatiorType oscillatorType)
 {
-    switch (oscillatorType)
-    {
-    case CarrierOscillatiorType::Saw:
-        carrierTmp = &sawCarrier;
-        break;
-    case CarrierOscillatiorType::Square:
-        carrierTmp = &squareCarrier;
-        break;
-    case CarrierOscillatiorType::Triangle:
-        carrierTmp = &trianlgeCarrier;
-        break;
-    case CarrierOscillatiorType::Sine:
-        carrierTmp = &sineCarrier;
-        break;
-    case CarrierOscillatiorType::Cluster:
-        carrierTmp = &clusterCarrier;
-        break;
-    case CarrierOscillatiorType::Fibonacci:
-        carrierTmp = &fibonacciCarrier;
-        break;
-    case CarrierOscillatiorType::Mirror:
-        carrierTmp = &mirrorCarrier;
-        break;
-    case CarrierOscillatiorType::Modulo:
-        carrierTmp = &moduloCarrier;
-        break;
-    default:
-        carrierTmp = &sawCarrier;
-        break;
-    }
+    size_t type = static_cast<size_t>(oscillatorType);
+    const SharedWavetableSet *set = carrierTables[type < numCarrierTypes ? type : static_cast<size_t>(CarrierOscillatiorType::Saw)];
 
-    if (carrierTmp == carrier)
+    if (set == carrier.getWavetable())
     {
         return;
     }
 
-    carrierTmp->setFrequency(carrierFrequency);
-    carrierTmp->setModIndex(modulationIndex);
-    carrierTmp->setDetune(detune);
-    carrierTmp->setNumVoices(numVoices);
-    carrierTmp->setAnalogDrift(oscDrift);
+    changeParam({applyCarrier, this, const_cast<SharedWavetableSet *>(set), {0.0, 0.0}, 0});
+}
 
-    paramFader.change(
-        [=]()
-        {
-            carrier = carrierTmp;
+void JPVoice::applyCarrier(const ParamFader::ParamChange &change)
+{
+    JPVoice *self = static_cast<JPVoice *>(change.target);
 
-            carrier->connectOutputToBus(carrierAudioBus);
-            carrier->connectFMToBus(modulatorAudioBus);
+    self->carrier.setWavetable(static_cast<const SharedWavetableSet *>(change.object));
 
-            filter.reset();
-        });
+    self->filter.reset();
 }
 
-// Assigns the modulation oscillator
+// Assigns the modulator waveform
 void JPVoice::setModulatorOscillatorType(ModulatorOscillatorType oscillatorType)
 {
-    switch (oscillatorType)
-    {
-    case ModulatorOscillatorType::Saw:
-        modulatorTmp = &sawModulator;
-        break;
-    case ModulatorOscillatorType::Square:
-        modulatorTmp = &squareModulator;
-        break;
-    case ModulatorOscillatorType::Triangle:
-        modulatorTmp = &triangleModulator;
-        break;
-    case ModulatorOscillatorType::Sine:
-        modulatorTmp = &sineModulator;
-        break;
-    case ModulatorOscillatorType::Cluster:
-        modulatorTmp = &clusterModulator;
-        break;
-    case ModulatorOscillatorType::Fibonacci:
-        modulatorTmp = &fibonacciModulator;
-        break;
-    case ModulatorOscillatorType::Mirror:
-        modulatorTmp = &mirrorModulator;
-        break;
-    case ModulatorOscillatorType::Modulo:
-        modulatorTmp = &moduloModulator;
-        break;
-    case ModulatorOscillatorType::Bit:
-        modulatorTmp = &bitModulator;
-        break;
-    default:
-        modulatorTmp = &sineModulator;
-        break;
-    }
+    size_t type = static_cast<size_t>(oscillatorType);
+    const SharedWavetableSet *set = modulatorTables[type < numModulatorTypes ? type : static_cast<size_t>(ModulatorOscillatorType::Sine)];
 
-    if (modulatorTmp == modulator)
+    if (set == modulator.getWavetable())
     {
         return;
     }
 
-    modulatorTmp->setFrequency(modulatorFrequency);
-    modulatorTmp->setAnalogDrift(oscDrift);
+    changeParam({applyModulator, this, const_cast<SharedWavetableSet *>(set), {0.0, 0.0}, 0});
+}
 
-    paramFader.change(
-        [=]()
-        {
-            modulator = modulatorTmp;
+void JPVoice::applyModulator(const ParamFader::ParamChange &change)
+{
+    JPVoice *self = static_cast<JPVoice *>(change.target);
 
-            carrier->connectFMToBus(modulatorAudioBus);
-            modulator->connectOutputToBus(modulatorAudioBus);
+    self->modulator.setWavetable(static_cast<const SharedWavetableSet *>(change.object));
 
-            filter.reset();
-        });
+    self->filter.reset();
 }
 
 // Changes the current noise type (white or pink)
@@ -425,6 +362,11 @@ void JPVoice::linkADSR(bool isEnabled)
 {
     adsrLinked = isEnabled;
 }
+
+void JPVoice::setStealMode(VoiceStealMode mode)
+{
+    stealMode = mode;
+}
 // Set adrss to one shot mode
 void JPVoice::setADSROneshot(bool isEnabled)
 {
@@ -441,26 +383,97 @@ void JPVoice::setAnalogDrift(host_float amount)
 {
     oscDrift = amount * 0.08;
 
-    carrier->setAnalogDrift(oscDrift);
-    modulator->setAnalogDrift(oscDrift);
+    carrier.setAnalogDrift(oscDrift);
+    modulator.setAnalogDrift(oscDrift);
 }
 
 void JPVoice::setFilterCutoffModulationBus(DSPModulationBus &bus)
 {
     filterCutoffModulationBus = bus;
+    declareBusAccess("filterCutoffModulation", bus, DSPBusAccess::Read);
+}
+
+void JPVoice::addToGraph(DSPGraph &graph)
+{
+    size_t node = graph.addNode(*this);
+
+    graph.addAccess(node, carrierAudioBus, DSPBusAccess::Write);
+    graph.addAccess(node, modulatorAudioBus, DSPBusAccess::Write);
+    graph.addAccess(node, noiseAudioBus, DSPBusAccess::Write);
+    graph.addAccess(node, filterCutoffBus, DSPBusAccess::Write);
+    graph.addAccess(node, outputAmplificationBus, DSPBusAccess::Write);
+    graph.addAccess(node, voiceAudioBus, DSPBusAccess::Write);
+}
+
+size_t JPVoice::addSourceToGraph(DSPGraph &graph)
+{
+    size_t sourceNode = graph.addTask("source" + getName(), &JPVoice::renderSourceTask, this);
+
+    graph.addAccess(sourceNode, carrierAudioBus, DSPBusAccess::Write);
+    graph.addAccess(sourceNode, modulatorAudioBus, DSPBusAccess::Write);
+    graph.addAccess(sourceNode, noiseAudioBus, DSPBusAccess::Write);
+    graph.addAccess(sourceNode, filterCutoffBus, DSPBusAccess::Write);
+    graph.addAccess(sourceNode, voiceAudioBus, DSPBusAccess::Write);
+    graph.addAccess(sourceNode, filterCutoffModulationBus, DSPBusAccess::Read);
+
+    return sourceNode;
+}
+
+size_t JPVoice::addOutputToGraph(DSPGraph &graph)
+{
+    size_t outputNode = graph.addTask("output" + getName(), &JPVoice::renderOutputTask, this);
+
+    graph.addAccess(outputNode, voiceAudioBus, DSPBusAccess::ReadWrite);
+    graph.addAccess(outputNode, outputAmplificationBus, DSPBusAccess::Write);
+    graph.addAccess(outputNode, outputBus, DSPBusAccess::Write);
+
+    return outputNode;
+}
+
+void JPVoice::addFilterAccess(DSPGraph &graph, size_t node)
+{
+    graph.addAccess(node, filterCutoffBus, DSPBusAccess::Read);
+    graph.addAccess(node, voiceAudioBus, DSPBusAccess::ReadWrite);
+}
+
+void JPVoice::processFilters(JPVoice *const *voices, size_t count)
+{
+    KorgonFilter *filters[maxBatch];
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        filters[i] = &voices[i]->filter;
+    }
+
+    KorgonFilter::processBatch(filters, count);
+}
+
+void JPVoice::setRenderOffset(size_t offset)
+{
+    renderOffset = offset;
 }
 
 // Next sample block generation
 void JPVoice::processBlock()
 {
-    modulator->process();
+    renderSource();
+
+    // process filter
+    filter.process();
+
+    renderOutput();
+}
+
+void JPVoice::renderSource()
+{
+    modulator.process();
 
-    carrier->process();
+    carrier.process();
 
-    if (syncEnabled && carrier->hasWrapped())
+    if (syncEnabled && carrier.hasWrapped())
     {
-        modulator->resetPhase();
-        carrier->unWrap();
+        modulator.resetPhase();
+        carrier.unWrap();
     }
 
     if (noisemix > 0)
@@ -503,24 +516,71 @@ void JPVoice::processBlock()
             mixR = amp_oscs * mixR + amp_noise * noiseAudioBus.r[i];
         }
 
-        outputBus.l[i] = mixL;
-        outputBus.r[i] = mixR;
+        voiceAudioBus.l[i] = mixL;
+        voiceAudioBus.r[i] = mixR;
     }
 
     // Filter cutoff calculation
     filterAdsr.process();
 
-    // Compute LFO modulation on cutoff
-    filterCutoffBus.multiplyWidth(filterCutoffModulationBus);
-
-    // process filter
-    filter.process();
-
-    // output amplification
-    ampAdsr.processMultiply(outputBus);
+    // Compute LFO modulation on cutoff, the modulation covers the whole block
+    for (size_t i = 0; i < DSP::blockSize; ++i)
+    {
+        filterCutoffBus.m[i] *= filterCutoffModulationBus.m[renderOffset + i];
+    }
+}
 
+void JPVoice::renderOutput()
+{
     // Assign changed params
     paramFader.process();
+
+    // output amplification, writes the rendered part of the block to its place in the output
+    ampAdsr.process();
+
+    for (size_t i = 0; i < DSP::blockSize; ++i)
+    {
+        outputBus.l[renderOffset + i] = voiceAudioBus.l[i] * outputAmplificationBus.m[i];
+        outputBus.r[renderOffset + i] = voiceAudioBus.r[i] * outputAmplificationBus.m[i];
+    }
+
+    if (tailPos < tailSamples)
+    {
+        renderTail();
+    }
+
+    // The history holds what was heard, a tail can be stolen again
+    for (size_t i = 0; i < DSP::blockSize; ++i)
+    {
+        historyL[historyPos] = outputBus.l[renderOffset + i];
+        historyR[historyPos] = outputBus.r[renderOffset + i];
+        historyPos = (historyPos + 1) & (historySize - 1);
+    }
+
+    // The amp envelope is applied after the filter, so the voice is silent as soon
+    // as the envelope is idle. The filter keeps being fed by the oscillators while
+    // the voice renders, so its state is cleared instead of waiting for it to decay.
+    if (active && ampAdsr.isIdle() && !paramFader.isPending())
+    {
+        active = false;
+        filter.reset();
+    }
+}
+
+void JPVoice::renderTail()
+{
+    size_t count = std::min(DSP::blockSize, tailSamples - tailPos);
+    host_float step = 1.0 / tailSamples;
+
+    // Played backwards the tail continues the last output sample without a step
+    for (size_t i = 0; i < count; ++i, ++tailPos)
+    {
+        size_t k = (tailStart - 1 - tailPos) & (historySize - 1);
+        host_float gain = 1.0 - tailPos * step;
+
+        outputBus.l[renderOffset + i] += historyL[k] * gain;
+        outputBus.r[renderOffset + i] += historyR[k] * gain;
+    }
 }
 
 // Next sample block generation
@@ -529,4 +589,14 @@ void JPVoice::processBlock(DSPObject *dsp)
     JPVoice *self = static_cast<JPVoice *>(dsp);
 
     self->processBlock();
+}
+
+void JPVoice::renderSourceTask(void *context)
+{
+    static_cast<JPVoice *>(context)->renderSource();
+}
+
+void JPVoice::renderOutputTask(void *context)
+{
+    static_cast<JPVoice *>(context)->renderOutput();
 }
\ No newline at end of file
@@ -2,12 +2,15 @@
 
 #include "m_pd.h"
 #include "DSP.h"
+#include "DSPEngine.h"
+#include "DSPProfiler.h"
 #include "JPVoice.h"
 #include "JPSynth.h"
 #include "clamp.h"
 #include "dsp_types.h"
 
-#define synth JPSynth::instance()
+// Every object renders its own synth in its own engine
+#define synth (*x->instance)
 
 static t_class *jpsynth_class;
 
@@ -25,11 +28,13 @@ typedef struct _jpsynth
     size_t blockSize;
     LFOParams lfo1;
     LFOParams lfo2;
+    DSPEngine *engine;
+    JPSynth *instance;
 } t_jpsynth;
 
-bool testDSP()
+bool testDSP(t_jpsynth *x)
 {
-    if (!DSP::isInitialized())
+    if (!x->engine->isInitialized())
     {
         post("%s", "DSP not active");
         return false;
@@ -41,7 +46,7 @@ bool testDSP()
 // Frequency of carrier set via list [f1 freq(
 void jpsynth_tilde_note(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -61,7 +66,7 @@ void jpsynth_tilde_note(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 // Frequency offset modulator in halftones
 void jpsynth_tilde_offset(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -79,7 +84,7 @@ void jpsynth_tilde_offset(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 // Frequency fine tuning for modulator -100 - 100 [fine f(
 void jpsynth_tilde_fine(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -97,7 +102,7 @@ void jpsynth_tilde_fine(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 // Frequency of modulator set via list [detune factor(
 void jpsynth_tilde_detune(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -115,7 +120,7 @@ void jpsynth_tilde_detune(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 // Oscillator type carrier [carrier n( 1 - 5
 void jpsynth_tilde_carrier(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -161,7 +166,7 @@ void jpsynth_tilde_carrier(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 // Oscillator type carrier [modulator n( 1 - 4
 void jpsynth_tilde_modulator(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -210,7 +215,7 @@ void jpsynth_tilde_modulator(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 // Sets the type of noise to white (0) or pink (1)
 void jpsynth_tilde_noisetype(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -238,7 +243,7 @@ void jpsynth_tilde_noisetype(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 // Oscillator mix [oscmix f(
 void jpsynth_tilde_oscmix(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -256,7 +261,7 @@ void jpsynth_tilde_oscmix(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 // Noise mix [noisemix f(
 void jpsynth_tilde_noisemix(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -274,7 +279,7 @@ void jpsynth_tilde_noisemix(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 // Sets the FM modulation index [fmmod f(
 void jpsynth_tilde_modidx(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -292,7 +297,7 @@ void jpsynth_tilde_modidx(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 // Sets the pitch bend [bend f(
 void jpsynth_tilde_bend(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -307,17 +312,17 @@ void jpsynth_tilde_bend(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
     synth.setPitchBend(bend);
 }
 
-// Sets the number of voices 1 - 9 [nov f(
+// Sets the number of unison voices 1 - 16 [nov f(
 void jpsynth_tilde_nov(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
 
     if (argc != 1 || argv[0].a_type != A_FLOAT)
     {
-        pd_error(x, "[jpsynth~]: expected int argument 1 - 9 for number of voices: [nov f(");
+        pd_error(x, "[jpsynth~]: expected int argument 1 - 16 for number of voices: [nov f(");
         return;
     }
 
@@ -325,10 +330,23 @@ void jpsynth_tilde_nov(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
     synth.setNumVoices(nov);
 }
 
+// Polyphony, the voices are preallocated
+void jpsynth_tilde_poly(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
+{
+    if (argc != 1 || argv[0].a_type != A_FLOAT)
+    {
+        pd_error(x, "[jpsynth~]: expected int argument 1 - %d for polyphony: [poly f(", static_cast<int>(JPSynth::maxPolyphony));
+        return;
+    }
+
+    int poly = atom_getint(argv);
+    synth.setPolyphony(static_cast<size_t>(clamp(poly, 1, static_cast<int>(JPSynth::maxPolyphony))));
+}
+
 // Oscillator sync
 void jpsynth_tilde_sync(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -344,9 +362,9 @@ void jpsynth_tilde_sync(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 }
 
 // [filtermode <0|1|2>] → 0 = LPF12, 1 = BPF12, 2 = HPF12
-void jpsynth_tilde_mode(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_mode(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -373,9 +391,9 @@ void jpsynth_tilde_mode(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
     }
 }
 
-void jpsynth_tilde_follow(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_follow(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -391,9 +409,9 @@ void jpsynth_tilde_follow(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
     synth.setFilterFollow(f != 0);
 }
 
-void jpsynth_tilde_drift(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_drift(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -411,9 +429,9 @@ void jpsynth_tilde_drift(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
 }
 
 // [carrierfb (0 - 1.2)]
-void jpsynth_tilde_carrierfb(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_carrierfb(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -429,9 +447,9 @@ void jpsynth_tilde_carrierfb(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *ar
 }
 
 // [carrierfb (0 - 1.2)]
-void jpsynth_tilde_modulatorfb(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_modulatorfb(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -446,9 +464,9 @@ void jpsynth_tilde_modulatorfb(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *
     synth.setFeedbackModulator(fb);
 }
 
-void jpsynth_tilde_cutoff(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_cutoff(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -463,9 +481,9 @@ void jpsynth_tilde_cutoff(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
     synth.setFilterCutoff(f);
 }
 
-void jpsynth_tilde_reso(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_reso(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -480,9 +498,9 @@ void jpsynth_tilde_reso(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
     synth.setFilterResonance(r);
 }
 
-void jpsynth_tilde_drive(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_drive(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -500,7 +518,7 @@ void jpsynth_tilde_drive(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
 // Filter ADSR [fltadsr att dec sus rel cutoff attshape relshape(
 void jpsynth_tilde_fltadsr(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -526,7 +544,7 @@ void jpsynth_tilde_fltadsr(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 // Filter ADSR [ampadsr att dec sus rel cutoff attshape relshape(
 void jpsynth_tilde_ampadsr(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -549,9 +567,9 @@ void jpsynth_tilde_ampadsr(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
     synth.setAmpADSR(adsr);
 }
 
-void jpsynth_tilde_adsrlink(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_adsrlink(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -565,9 +583,9 @@ void jpsynth_tilde_adsrlink(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *arg
     synth.linkADSR(atom_getfloat(argv) != 0.0);
 }
 
-void jpsynth_tilde_adsroneshot(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_adsroneshot(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -581,10 +599,27 @@ void jpsynth_tilde_adsroneshot(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *
     synth.setADSROneshot(atom_getfloat(argv) != 0.0);
 }
 
+// Voice stealing, 1 fades the stolen note out while the new one starts
+void jpsynth_tilde_steal(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
+{
+    if (!testDSP(x))
+    {
+        return;
+    }
+
+    if (argc < 1)
+    {
+        post("[jpsynth~] usage: steal [steal 0|1(");
+        return;
+    }
+
+    synth.setVoiceStealMode(atom_getfloat(argv) != 0.0 ? VoiceStealMode::Tail : VoiceStealMode::Retrigger);
+}
+
 // LFO1 [lfo1 type freq offset depth shape pw smooth target(
 void jpsynth_tilde_lfo1(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -661,7 +696,7 @@ void jpsynth_tilde_lfo1(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 // LFO2 [lfo2 type freq offset depth shape pw smooth target(
 void jpsynth_tilde_lfo2(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -675,9 +710,9 @@ void jpsynth_tilde_lfo2(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
     
 }
 
-void jpsynth_tilde_revroom(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_revroom(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -692,9 +727,9 @@ void jpsynth_tilde_revroom(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv
     synth.setReverbRoom(room);
 }
 
-void jpsynth_tilde_revspace(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_revspace(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -709,9 +744,9 @@ void jpsynth_tilde_revspace(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *arg
     synth.setReverbSpace(space);
 }
 
-void jpsynth_tilde_revdamp(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_revdamp(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -726,9 +761,9 @@ void jpsynth_tilde_revdamp(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv
     synth.setReverbDamping(damping);
 }
 
-void jpsynth_tilde_revdense(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_revdense(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -743,9 +778,9 @@ void jpsynth_tilde_revdense(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *arg
     synth.setReverbDensity(density);
 }
 
-void jpsynth_tilde_revdisp(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_revdisp(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -817,9 +852,9 @@ void jpsynth_tilde_revdisp(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv
     }
 }
 
-void jpsynth_tilde_revwet(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_revwet(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -834,9 +869,9 @@ void jpsynth_tilde_revwet(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
     synth.setReverbWet(v);
 }
 
-void jpsynth_tilde_deltime(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_deltime(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -853,9 +888,9 @@ void jpsynth_tilde_deltime(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv
     synth.setDelayTime(tL, tR);
 }
 
-void jpsynth_tilde_delfb(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_delfb(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -872,9 +907,9 @@ void jpsynth_tilde_delfb(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
     synth.setDelayFeedback(fbL, fbR);
 }
 
-void jpsynth_tilde_deldisp(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_deldisp(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -946,9 +981,9 @@ void jpsynth_tilde_deldisp(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv
     }
 }
 
-void jpsynth_tilde_delwet(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_delwet(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -963,9 +998,9 @@ void jpsynth_tilde_delwet(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
     synth.setDelayWet(v);
 }
 
-void jpsynth_tilde_distwet(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_distwet(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -979,9 +1014,9 @@ void jpsynth_tilde_distwet(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv
     synth.setDistWet(atom_getfloat(argv));
 }
 
-void jpsynth_tilde_distdrive(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_distdrive(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -995,9 +1030,9 @@ void jpsynth_tilde_distdrive(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *ar
     synth.setDistDrive(atom_getfloat(argv));
 }
 
-void jpsynth_tilde_distgain(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_distgain(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -1011,9 +1046,9 @@ void jpsynth_tilde_distgain(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *arg
     synth.setDistGain(atom_getfloat(argv));
 }
 
-void jpsynth_tilde_disttone(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_disttone(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -1027,9 +1062,9 @@ void jpsynth_tilde_disttone(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *arg
     synth.setDistTone(atom_getfloat(argv));
 }
 
-void jpsynth_tilde_disttype(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_disttype(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -1062,9 +1097,9 @@ void jpsynth_tilde_disttype(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *arg
     }
 }
 
-void jpsynth_tilde_wet(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
+void jpsynth_tilde_wet(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
 {
-    if (!testDSP())
+    if (!testDSP(x))
     {
         return;
     }
@@ -1079,10 +1114,33 @@ void jpsynth_tilde_wet(t_jpsynth * /*x*/, t_symbol *, int argc, t_atom *argv)
     synth.setWet(w);
 }
 
+// [profile 1( enables and resets, [profile 0( disables, [profile( prints the report
+void jpsynth_tilde_profile(t_jpsynth *x, t_symbol *, int argc, t_atom *argv)
+{
+    // Figures are kept per engine, the report shows the objects of this synth
+    DSPEngine::Scope scope(*x->engine);
+
+    if (argc < 1)
+    {
+        DSPProfiler::log();
+        return;
+    }
+
+    bool enable = atom_getfloat(argv) != 0.0;
+    DSPProfiler::enable(enable);
+
+    post("[jpsynth~] profiling %s", enable ? "enabled" : "disabled");
+}
+
 // DSP perform function
 t_int *jpsynth_tilde_perform(t_int *w)
 {
-    synth.process();
+    t_jpsynth *x = (t_jpsynth *)(w[1]);
+    t_sample *outL = (t_sample *)(w[2]);
+    t_sample *outR = (t_sample *)(w[3]);
+    size_t n = (size_t)(w[4]);
+
+    synth.process(outL, outR, n);
     //DSPBusManager::validate();
     return (w + 5);
 }
@@ -1090,17 +1148,23 @@ t_int *jpsynth_tilde_perform(t_int *w)
 // DSP add function
 void jpsynth_tilde_dsp(t_jpsynth *x, t_signal **sp)
 {
-    t_sample *outL = sp[0]->s_vec;
-    t_sample *outR = sp[1]->s_vec;
+    DSPEngine::Scope scope(*x->engine);
 
-    x->samplerate = sp[0]->s_sr;
-    x->blockSize = sp[0]->s_n;
+    // The synth renders fixed sub-blocks and copies them to any Pd block size,
+    // so it is only built again if the sample rate changed. Notes and settings
+    // survive switching DSP off and on.
+    if (!x->engine->isInitialized() || x->samplerate != sp[0]->s_sr)
+    {
+        x->samplerate = sp[0]->s_sr;
 
-    DSP::initializeAudio(x->samplerate, x->blockSize);
+        DSP::initializeAudio(x->samplerate, DSP::subBlockSize);
 
-    synth.initialize(outL, outR);
+        synth.initialize();
 
-    DSPBusManager::log();
+        DSPBusManager::log();
+    }
+
+    x->blockSize = sp[0]->s_n;
 
     dsp_add(jpsynth_tilde_perform, 4,
             x,
@@ -1124,6 +1188,9 @@ void *jpsynth_tilde_new()
 
     DSP::registerLogger(&log);
 
+    x->engine = new DSPEngine();
+    x->instance = new JPSynth(*x->engine);
+
     return (void *)x;
 }
 
@@ -1133,7 +1200,9 @@ void jpsynth_tilde_free(t_jpsynth *x)
     outlet_free(x->left_out);
     outlet_free(x->right_out);
 
-    // delete x->voice;
+    // The synth's objects live in the engine
+    delete x->instance;
+    delete x->engine;
 }
 
 // Setup function
@@ -1160,6 +1229,7 @@ extern "C" void jpsynth_tilde_setup(void)
     class_addmethod(jpsynth_class, (t_method)jpsynth_tilde_modidx, gensym("modidx"), A_GIMME, 0);
     class_addmethod(jpsynth_class, (t_method)jpsynth_tilde_bend, gensym("bend"), A_GIMME, 0);
     class_addmethod(jpsynth_class, (t_method)jpsynth_tilde_nov, gensym("nov"), A_GIMME, 0);
+    class_addmethod(jpsynth_class, (t_method)jpsynth_tilde_poly, gensym("poly"), A_GIMME, 0);
     class_addmethod(jpsynth_class, (t_method)jpsynth_tilde_sync, gensym("sync"), A_GIMME, 0);
     class_addmethod(jpsynth_class, (t_method)jpsynth_tilde_carrierfb, gensym("carrierfb"), A_GIMME, 0);
     class_addmethod(jpsynth_class, (t_method)jpsynth_tilde_modulatorfb, gensym("modulatorfb"), A_GIMME, 0);
@@ -1177,6 +1247,7 @@ extern "C" void jpsynth_tilde_setup(void)
     class_addmethod(jpsynth_class, (t_method)jpsynth_tilde_ampadsr, gensym("ampadsr"), A_GIMME, 0);
     class_addmethod(jpsynth_class, (t_method)jpsynth_tilde_adsrlink, gensym("adsrlink"), A_GIMME, 0);
     class_addmethod(jpsynth_class, (t_method)jpsynth_tilde_adsroneshot, gensym("adsroneshot"), A_GIMME, 0);
+    class_addmethod(jpsynth_class, (t_method)jpsynth_tilde_steal, gensym("steal"), A_GIMME, 0);
 
     class_addmethod(jpsynth_class, (t_method)jpsynth_tilde_lfo1, gensym("lfo1"), A_GIMME, 0);
     class_addmethod(jpsynth_class, (t_method)jpsynth_tilde_lfo2, gensym("lfo2"), A_GIMME, 0);
@@ -1200,4 +1271,6 @@ extern "C" void jpsynth_tilde_setup(void)
     class_addmethod(jpsynth_class, (t_method)jpsynth_tilde_disttone, gensym("disttone"), A_GIMME, 0);
 
     class_addmethod(jpsynth_class, (t_method)jpsynth_tilde_wet, gensym("wet"), A_GIMME, 0);
+
+    class_addmethod(jpsynth_class, (t_method)jpsynth_tilde_profile, gensym("profile"), A_GIMME, 0);
 }
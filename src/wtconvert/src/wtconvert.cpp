@@ -0,0 +1,152 @@
+// wtconvert.cpp - Converts legacy CSV wavetables to the binary .akwt format
+//
+// Every <name>_<rate>.wave file given on the command line is written as
+// <name>_<rate>.akwt next to it and verified by mapping it back. The sample
+// rate is taken from the file name unless -r is given. Converted files keep
+// the legacy table version, oscillators regenerate tables of an older
+// version than WavetableOscillator::tableVersion.
+//
+// Usage: wtconvert [-r rate] [-c] file...
+//
+//     wtconvert tables/*.wave      convert all legacy tables
+//     wtconvert -c tables/*.akwt   check binary tables and list their content
+
+#include "DSP.h"
+#include "WavetableFile.h"
+#include "WavetableOscillator.h"
+#include "dsp_types.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+static void convertLogger(const std::string &msg)
+{
+    std::fprintf(stderr, "%s\n", msg.c_str());
+}
+
+static void usage(const char *prog)
+{
+    std::fprintf(stderr,
+                 "usage: %s [-r rate] [-c] file...\n"
+                 "  -r  sample rate in Hz, taken from <name>_<rate>.wave if omitted\n"
+                 "  -c  check .akwt files instead of converting .wave files\n",
+                 prog);
+}
+
+// Extracts the rate from "<name>_<rate>.<ext>", 0 if there is none
+static uint32_t rateFromFileName(const std::string &path)
+{
+    size_t dot = path.rfind('.');
+    size_t underscore = path.rfind('_', dot);
+
+    if (dot == std::string::npos || underscore == std::string::npos || dot <= underscore + 1)
+        return 0;
+
+    return static_cast<uint32_t>(std::strtoul(path.substr(underscore + 1, dot - underscore - 1).c_str(), nullptr, 10));
+}
+
+static std::string binaryFileName(const std::string &path)
+{
+    size_t dot = path.rfind('.');
+    return (dot == std::string::npos ? path : path.substr(0, dot)) + ".akwt";
+}
+
+static bool check(const std::string &path, uint32_t rate)
+{
+    WavetableFile file;
+
+    if (!file.open(path, rate, WavetableOscillator::tableVersion))
+    {
+        std::fprintf(stderr, "%s: missing or stale\n", path.c_str());
+        return false;
+    }
+
+    std::printf("%s: %zu tables at %u Hz\n", path.c_str(), file.getNumTables(), rate);
+
+    for (size_t i = 0; i < file.getNumTables(); ++i)
+    {
+        std::printf("  %8.1f Hz %6zu samples\n", static_cast<double>(file.getBaseFrequency(i)), file.getTableSize(i));
+    }
+
+    return true;
+}
+
+static bool convert(const std::string &path, uint32_t rate)
+{
+    std::vector<host_float> frequencies;
+    std::vector<std::vector<host_float>> tables;
+
+    if (!WavetableFile::readLegacy(path, frequencies, tables))
+    {
+        std::fprintf(stderr, "%s: cannot read wavetable\n", path.c_str());
+        return false;
+    }
+
+    std::string outPath = binaryFileName(path);
+
+    // The content is that of the generator the .wave file was written by
+    if (!WavetableFile::write(outPath, rate, WavetableOscillator::legacyTableVersion, frequencies, tables))
+        return false;
+
+    std::printf("%s -> %s\n", path.c_str(), outPath.c_str());
+
+    // Map it back to verify header and checksum
+    WavetableFile file;
+    return file.open(outPath, rate, WavetableOscillator::legacyTableVersion);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t rate = 0;
+    bool checkOnly = false;
+    int c;
+
+    while ((c = getopt(argc, argv, "r:ch")) != -1)
+    {
+        switch (c)
+        {
+        case 'r':
+            rate = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 10));
+            break;
+        case 'c':
+            checkOnly = true;
+            break;
+        default:
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (optind >= argc)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    DSP::registerLogger(&convertLogger);
+
+    int failed = 0;
+
+    for (int i = optind; i < argc; ++i)
+    {
+        std::string path = argv[i];
+        uint32_t fileRate = rate != 0 ? rate : rateFromFileName(path);
+
+        if (fileRate == 0)
+        {
+            std::fprintf(stderr, "%s: no sample rate in file name, use -r\n", path.c_str());
+            ++failed;
+            continue;
+        }
+
+        if (!(checkOnly ? check(path, fileRate) : convert(path, fileRate)))
+        {
+            ++failed;
+        }
+    }
+
+    return failed == 0 ? 0 : 1;
+}